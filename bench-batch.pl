@@ -0,0 +1,68 @@
+#!/usr/bin/env perl
+#
+# Script to measure the throughput (series per second) of '-batch' against
+# that of running 'corrdim' once per series
+#
+
+use strict;
+use warnings;
+use File::Temp qw(tempdir);
+
+# number of series, their length range and how many to run one-per-process
+my $numSeries = 500;
+my $minLen = 500;
+my $maxLen = 2000;
+my $numSingle = 25;
+
+sub genSeries {
+    my ($dir) = @_;
+    srand(42);
+    my @files;
+    for(my $s=0;$s<$numSeries;$s++) {
+        my $len = $minLen + int(rand($maxLen - $minLen + 1));
+        my $lambda = 3.6 + rand(0.4);
+        my $x = 0.1 + rand(0.8);
+        my $file = sprintf("%s/series%05d.txt", $dir, $s);
+        open(my $fp, ">", $file) or die "Failed to open '$file' for writing!";
+        for(my $i=0;$i<$len;$i++) {
+            $x = $lambda * $x * (1 - $x);
+            printf $fp "%.12f\n", $x;
+        }
+        close($fp);
+        push(@files, [$file, $len]);
+    }
+    return @files;
+}
+
+sub wallTime {
+    my ($cmd) = @_;
+    my $start = time();
+    system("$cmd > /dev/null") == 0 or die "Failed to run '$cmd'!";
+    return time() - $start;
+}
+
+
+
+if((scalar(@ARGV) != 1) || ($ARGV[0] ne "running_from_Makefile")) {
+    die "You cannot run this script from outside 'Makefile'!";
+}
+eval "use Time::HiRes qw(time); 1" or die "Time::HiRes is needed!";
+my $dir = tempdir(CLEANUP => 1);
+printf("Generating $numSeries series of $minLen-$maxLen points... ");
+my @files = genSeries($dir);
+printf("done\n");
+
+printf("Running one 'corrdim' per series (first $numSingle)... ");
+my $single = 0;
+for(my $s=0;$s<$numSingle;$s++) {
+    my ($file, $len) = @{$files[$s]};
+    $single += wallTime("./corrdim -map CustomVectors -numele $len -dim 1 -file $file");
+}
+my $singleRate = $numSingle / $single;
+printf("%.2f series/s\n", $singleRate);
+
+printf("Running '-batch' on all the series... ");
+my $batch = wallTime("./corrdim -batch $dir -batch-out /dev/null");
+my $batchRate = $numSeries / $batch;
+printf("%.2f series/s\n", $batchRate);
+printf("Speedup of '-batch': %.2fx\n", $batchRate / $singleRate);
@@ -0,0 +1,54 @@
+#!/usr/bin/env perl
+#
+# Script to compare the speed of reading text files for 'CustomVectors':
+# the parallel parser (default) against the old, sequential 'scanf' one
+#
+
+use strict;
+use warnings;
+use File::Temp qw(tempdir);
+
+# size of the generated file
+my $numRows = 2000000;
+my $numCols = 3;
+
+sub genFile {
+    my ($file) = @_;
+    open(my $fp, ">", $file) or die "Failed to open '$file' for writing!";
+    my ($x, $y, $z) = (0.1, 0.2, 0.3);
+    for(my $i=0;$i<$numRows;$i++) {
+        $x = 3.9 * $x * (1 - $x);
+        $y = 3.8 * $y * (1 - $y);
+        $z = 3.7 * $z * (1 - $z);
+        printf $fp "%.15f %.15f %.15f\n", $x, $y, $z;
+    }
+    close($fp);
+    return -s $file;
+}
+
+sub readTime {
+    my ($cmd) = @_;
+    my $output = `$cmd`;
+    die "Failed to run '$cmd'!" if($? != 0);
+    foreach my $line (split(/\n/, $output)) {
+        return $1 if($line =~ /^Generating numbers.*Time taken: (\S+) s/);
+    }
+    die "No timing found in the output of '$cmd'!";
+}
+
+
+
+if((scalar(@ARGV) != 1) || ($ARGV[0] ne "running_from_Makefile")) {
+    die "You cannot run this script from outside 'Makefile'!";
+}
+my $dir = tempdir(CLEANUP => 1);
+my $file = "$dir/vectors.txt";
+printf("Generating $numRows x $numCols values... ");
+my $bytes = genFile($file);
+printf("%.1f MB\n", $bytes / 1048576);
+my $base = "./corrdim -map CustomVectors -numele $numRows -file $file -dim $numCols -ingest-only";
+my $old = readTime("$base -format scanf");
+printf("Old reader ('scanf'):  %f s (%.1f MB/s)\n", $old, $bytes / 1048576 / $old);
+my $new = readTime("$base -format text");
+printf("New reader ('text'):   %f s (%.1f MB/s)\n", $new, $bytes / 1048576 / $new);
+printf("Speedup: %.2fx\n", $old / $new);
@@ -0,0 +1,208 @@
+#!/usr/bin/env perl
+#
+# Script to measure how the engines scale with the number of vectors, their
+# dimension and the number of threads, and to compare the results against
+# the baseline stored in the repo
+#
+# Exit codes: 0 if all is well, 2 on a throughput or memory regression
+#
+
+use strict;
+use warnings;
+use Getopt::Long;
+use JSON::PP;
+use File::Temp qw(tempdir);
+
+# the sweeps: N (at dim 2 and 1 thread), dim (at $baseN and 1 thread) and
+# threads (at $baseN for strong scaling, at $baseN * sqrt(threads) for weak).
+# Only 'hybrid' uses threads, and thread counts above the cores of the host
+# are skipped, as they would only measure oversubscription.
+my @engines = ("full", "lowmem", "hybrid");
+my @threadedEngines = ("hybrid");
+my @numEles = (2000, 4000, 8000);
+my @dims = (1, 2, 3);
+my @threads = (1, 2, 4);
+my $baseN = 4000;
+# which map gives vectors of which dimension
+my %dimMaps = (1 => "LogisticMap", 2 => "HenonMap", 3 => "CustomVectors");
+# where every run writes its metrics
+my $metrics = ".results_metrics.json";
+my $results = "results_scaling.json";
+my $baseline = "bench-baseline.json";
+
+my $reps = 3;
+my $tolThroughput = 0.15;
+my $tolMem = 0.10;
+my $update = 0;
+
+sub genFile {
+    my ($file, $numRows) = @_;
+    srand(42);
+    open(my $fp, ">", $file) or die "Failed to open '$file' for writing!";
+    for(my $i=0;$i<$numRows;$i++) {
+        printf $fp "%.15f %.15f %.15f\n", rand(), rand(), rand();
+    }
+    close($fp);
+}
+
+sub median {
+    my @vals = sort { $a <=> $b } @_;
+    my $mid = int(scalar(@vals) / 2);
+    return (scalar(@vals) % 2)? $vals[$mid] : ($vals[$mid-1] + $vals[$mid]) / 2;
+}
+
+# one configuration, run '$reps' times: the best time spent in the engine (ie:
+# all the phases but the generation of the vectors, the best being the least
+# disturbed by the rest of the machine) and the median peak RSS
+sub runConfig {
+    my ($engine, $numele, $dim, $threads, $file) = @_;
+    my $map = $dimMaps{$dim};
+    my $cmd = "./corrdim -engine $engine -threads $threads -numele $numele -nopipeline " .
+        "-metrics $metrics -map $map";
+    $cmd .= " -file $file -dim $dim" if($map eq "CustomVectors");
+    my (@walls, @rss);
+    for(my $r=0;$r<$reps;$r++) {
+        system("$cmd > /dev/null") == 0 or die "Failed to run '$cmd'!";
+        open(my $fp, "<", $metrics) or die "Failed to open '$metrics'!";
+        my $run = decode_json(join("", <$fp>));
+        close($fp);
+        my $wall = 0;
+        foreach my $phase ("distances", "corrsum", "histogram", "fit") {
+            $wall += $run->{phases}{$phase}{wall};
+        }
+        push(@walls, $wall);
+        push(@rss, $run->{peakRss});
+    }
+    my $wall = (sort { $a <=> $b } @walls)[0];
+    my $pairs = $numele * ($numele - 1) / 2;
+    my $res = {engine => $engine, map => $map, dim => $dim, numEle => $numele,
+               threads => $threads, wall => $wall, pairsPerSec => $pairs / $wall,
+               peakRss => median(@rss)};
+    printf("%-7s N=%-6d dim=%d threads=%d  %9.3f s %12.0f pairs/s %8d kB\n", $engine, $numele,
+           $dim, $threads, $wall, $res->{pairsPerSec}, $res->{peakRss} >> 10);
+    return $res;
+}
+
+sub key {
+    my ($r) = @_;
+    return "$r->{engine}/N=$r->{numEle}/dim=$r->{dim}/threads=$r->{threads}";
+}
+
+sub cores {
+    my $cores = `nproc`;
+    chomp($cores);
+    return $cores;
+}
+
+sub host {
+    my $model = "unknown";
+    if(open(my $fp, "<", "/proc/cpuinfo")) {
+        while(my $line = <$fp>) {
+            if($line =~ /^model name\s*:\s*(.*\S)/) {
+                $model = $1;
+                last;
+            }
+        }
+        close($fp);
+    }
+    return "$model x " . cores();
+}
+
+# strong scaling: same N, more threads; weak scaling: same pairs per thread
+sub printEfficiency {
+    my ($byKey, @threads) = @_;
+    printf("\n%-7s %8s %10s %10s\n", "engine", "threads", "strong", "weak");
+    foreach my $engine (@threadedEngines) {
+        my $one = $byKey->{key({engine => $engine, numEle => $baseN, dim => 2, threads => 1})};
+        foreach my $t (@threads) {
+            my $strong = $byKey->{key({engine => $engine, numEle => $baseN, dim => 2, threads => $t})};
+            my $weak = $byKey->{key({engine => $engine, numEle => int($baseN * sqrt($t) + 0.5),
+                                     dim => 2, threads => $t})};
+            printf("%-7s %8d %9.1f%% %9.1f%%\n", $engine, $t, 100 * $one->{wall} / ($t * $strong->{wall}),
+                   100 * $one->{wall} / $weak->{wall});
+        }
+    }
+}
+
+# every run is compared with the same run of the baseline, if there's one
+sub compare {
+    my ($runs) = @_;
+    open(my $fp, "<", $baseline) or die "Failed to open '$baseline', create it with 'make bench-baseline'!";
+    my $base = decode_json(join("", <$fp>));
+    close($fp);
+    my %old = map { key($_) => $_ } @{$base->{runs}};
+    my $host = host();
+    if($base->{host} ne $host) {
+        printf("\nWARNING: The baseline is from '%s', this is '%s'!\n", $base->{host}, $host);
+    }
+    printf("\n%-36s %12s %12s\n", "run", "throughput", "peak RSS");
+    my $regressions = 0;
+    foreach my $r (@$runs) {
+        my $o = $old{key($r)};
+        if(!defined($o)) {
+            printf("%-36s %12s\n", key($r), "(not in the baseline)");
+            next;
+        }
+        my $dt = ($r->{pairsPerSec} / $o->{pairsPerSec}) - 1;
+        my $dm = ($r->{peakRss} / $o->{peakRss}) - 1;
+        my $bad = ($dt < -$tolThroughput) || ($dm > $tolMem);
+        printf("%-36s %+11.1f%% %+11.1f%%%s\n", key($r), 100 * $dt, 100 * $dm, $bad? "  REGRESSION" : "");
+        $regressions++ if($bad);
+    }
+    if($regressions > 0) {
+        printf("\n%d regression(s) beyond -%.0f%% throughput or +%.0f%% memory!\n", $regressions,
+               100 * $tolThroughput, 100 * $tolMem);
+        return 2;
+    }
+    printf("\nNo regressions against '%s'\n", $baseline);
+    return 0;
+}
+
+
+
+if((scalar(@ARGV) < 1) || ($ARGV[0] ne "running_from_Makefile")) {
+    die "You cannot run this script from outside 'Makefile'!";
+}
+shift(@ARGV);
+GetOptions("reps=i" => \$reps, "tol-throughput=f" => \$tolThroughput, "tol-mem=f" => \$tolMem,
+           "baseline" => \$update) or die "Usage: [-reps <n>] [-tol-throughput <f>] [-tol-mem <f>] [-baseline]";
+my $dir = tempdir(CLEANUP => 1);
+my $file = "$dir/vectors.txt";
+genFile($file, $baseN);
+
+my @useThreads = grep { $_ <= cores() } @threads;
+if(scalar(@useThreads) < scalar(@threads)) {
+    printf("WARNING: Only %d core(s), skipping the runs with more threads!\n", cores());
+}
+my (@configs, %seen);
+foreach my $engine (@engines) {
+    push(@configs, [$engine, $_, 2, 1]) foreach (@numEles);
+    push(@configs, [$engine, $baseN, $_, 1]) foreach (@dims);
+}
+foreach my $engine (@threadedEngines) {
+    foreach my $t (@useThreads) {
+        push(@configs, [$engine, $baseN, 2, $t]);
+        push(@configs, [$engine, int($baseN * sqrt($t) + 0.5), 2, $t]);
+    }
+}
+my @runs;
+foreach my $c (@configs) {
+    my $k = join("/", @$c);
+    next if($seen{$k}++);
+    push(@runs, runConfig(@$c, $file));
+}
+unlink($metrics);
+my %byKey = map { key($_) => $_ } @runs;
+printEfficiency(\%byKey, @useThreads);
+
+my $json = JSON::PP->new->canonical->pretty;
+my $out = {host => host(), reps => $reps, runs => \@runs};
+open(my $fp, ">", $update? $baseline : $results) or die "Failed to open the results file!";
+print $fp $json->encode($out);
+close($fp);
+if($update) {
+    printf("\nBaseline written to '%s'\n", $baseline);
+    exit(0);
+}
+printf("\nResults written to '%s'\n", $results);
+exit(compare(\@runs));
@@ -0,0 +1,105 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Bench.h"
+#include "Timer.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <random>
+#include <unistd.h>
+
+
+using namespace std;
+
+
+Bench::Bench(int reps, int warmup, const string& filter) {
+    m_reps = reps;
+    m_warmup = warmup;
+    m_filter = filter;
+}
+
+
+bool Bench::wanted(const string& name) const {
+    return name.find(m_filter) != string::npos;
+}
+
+
+void Bench::printHeader() {
+    fprintf(stdout, "%-36s %12s %12s %10s %8s\n", "benchmark", "median(ms)", "min(ms)", "ns/item",
+            "GB/s");
+}
+
+
+void Bench::run(const string& name, unsigned long int items, unsigned long int bytes,
+                const function<void()>& func, bool quiet/*=false*/) {
+    if(!wanted(name)) {
+        return;
+    }
+    int out = -1;
+    if(quiet) {
+        fflush(stdout);
+        out = dup(STDOUT_FILENO);
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        close(null);
+    }
+    for(int i=0;i<m_warmup;i++) {
+        func();
+    }
+    vector<REAL> secs;
+    for(int i=0;i<m_reps;i++) {
+        unsigned long long start = Timer::ticks();
+        func();
+        secs.push_back((Timer::ticks() - start) * Timer::tickSeconds());
+    }
+    if(quiet) {
+        fflush(stdout);
+        dup2(out, STDOUT_FILENO);
+        close(out);
+    }
+    sort(secs.begin(), secs.end());
+    size_t mid = secs.size() / 2;
+    REAL median = (secs.size() % 2)? secs[mid] : (secs[mid-1] + secs[mid]) / 2;
+    fprintf(stdout, "%-36s %12.3f %12.3f ", name.c_str(), median * 1e3, secs[0] * 1e3);
+    if(items > 0) {
+        fprintf(stdout, "%10.3f ", (median * 1e9) / items);
+    }
+    else {
+        fprintf(stdout, "%10s ", "-");
+    }
+    if(bytes > 0) {
+        fprintf(stdout, "%8.2f\n", (bytes / median) / 1e9);
+    }
+    else {
+        fprintf(stdout, "%8s\n", "-");
+    }
+    fflush(stdout);
+}
+
+
+vector<REAL> Bench::vectors(int numVec, int dim) {
+    mt19937_64 rng(BENCH_SEED);
+    uniform_real_distribution<REAL> uni(0, 1);
+    vector<REAL> vals((unsigned long int) numVec * dim);
+    for(size_t i=0;i<vals.size();i++) {
+        vals[i] = uni(rng);
+    }
+    return vals;
+}
@@ -0,0 +1,102 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_BENCH_H__
+#define __INCLUDED_BENCH_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <functional>
+
+
+/** default number of timed runs of every benchmark */
+#define BENCH_REPS     7
+/** default number of untimed runs before them */
+#define BENCH_WARMUP   1
+/** seed of the synthetic data */
+#define BENCH_SEED     12345
+
+
+/**
+ * Harness for the microbenchmarks. Every benchmark is run a few times
+ * untimed (to warm up the caches and the allocator), then timed over several
+ * runs. The median (and the min) of the runs is reported, along with the
+ * time per item (pair, point or vector) and the bandwidth.
+ *
+ * Usage:
+ *  Bench b(BENCH_REPS, BENCH_WARMUP, "");
+ *  b.printHeader();
+ *  b.run("corrsum/N=2000", TRI(2000), TRI(2000) * sizeof(REAL), [&] { ... });
+ */
+class Bench {
+public:
+    /**
+     * @brief Constructor of this class.
+     * @param reps number of timed runs.
+     * @param warmup number of untimed runs before them.
+     * @param filter only the benchmarks whose name contains this are run.
+     */
+    Bench(int reps, int warmup, const std::string& filter);
+
+    /**
+     * @brief Whether a benchmark is to be run
+     * @param name its name.
+     * @return true if it passes the filter
+     *
+     * Useful to skip preparing the data of the benchmarks filtered out.
+     */
+    bool wanted(const std::string& name) const;
+
+    /**
+     * @brief Runs one benchmark (unless filtered out) and prints its line
+     * @param name its name.
+     * @param items pairs (or points or vectors) handled by one run.
+     * @param bytes bytes streamed by one run (0 if it doesn't make sense).
+     * @param func one run.
+     * @param quiet whether to silence whatever 'func' prints on stdout.
+     */
+    void run(const std::string& name, unsigned long int items, unsigned long int bytes,
+             const std::function<void()>& func, bool quiet=false);
+
+    /**
+     * @brief Prints the header of the table
+     */
+    void printHeader();
+
+    /**
+     * @brief Deterministic synthetic vectors, uniform in [0, 1)
+     * @param numVec number of vectors.
+     * @param dim dimension of the vectors.
+     * @return the values
+     */
+    static std::vector<REAL> vectors(int numVec, int dim);
+
+private:
+    int m_reps;            ///< timed runs
+    int m_warmup;          ///< untimed runs
+    std::string m_filter;  ///< substring of the names to be run
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_BENCH_H__
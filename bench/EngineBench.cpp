@@ -0,0 +1,183 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "EngineBench.h"
+#include "CorrDim.h"
+#include "CorrDimLowMem.h"
+#include <cmath>
+#include <limits>
+
+
+using namespace std;
+
+
+/** number of vectors for the benchmarks not varying it */
+#define BENCH_NUMVEC   2000
+/** dimension of the vectors for the benchmarks not varying it */
+#define BENCH_DIM      2
+/** number of histogram bins */
+#define BENCH_BINS     25
+/** least squares fits per run */
+#define BENCH_FITS     100000
+
+
+/** values of N for the benchmarks varying it */
+static const int s_numVecs[] = {1000, 2000, 4000};
+/** values of k for the benchmarks varying it */
+static const int s_numPts[] = {5, 25};
+/** dimensions for the distance benchmark */
+static const int s_dims[] = {1, 2, 3, 4, 8};
+/** points per fit */
+static const int s_fitPts[] = {10, 25, 100};
+
+
+/**
+ * @brief Name of a benchmark
+ * @param fmt printf format of the name.
+ * @param a first parameter.
+ * @param b second parameter.
+ * @return the name
+ */
+static string benchName(const char* fmt, int a, int b=0) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), fmt, a, b);
+    return buf;
+}
+
+
+vector<REAL> EngineBench::radii(REAL logMin, REAL logMax, int k) {
+    vector<REAL> R(k);
+    REAL step = (logMax - logMin) / k;
+    REAL start = logMin + step;
+    for(int i=0;i<k;i++,start+=step) {
+        R[i] = (REAL) exp(start);
+    }
+    return R;
+}
+
+
+void EngineBench::distances(Bench& b) {
+    for(int dim : s_dims) {
+        string name = benchName("distances/dim=%d", dim);
+        if(!b.wanted(name)) {
+            continue;
+        }
+        vector<REAL> data = Bench::vectors(BENCH_NUMVEC, dim);
+        CorrDim cd(&(data[0]), BENCH_NUMVEC, dim);
+        unsigned long int pairs = TRI(BENCH_NUMVEC);
+        b.run(name, pairs, pairs * sizeof(REAL), [&] {
+            cd.m_log_min_dist = numeric_limits<REAL>::max();
+            cd.m_log_max_dist = -1;
+            cd.evaluateDistMatrix();
+        });
+    }
+}
+
+
+void EngineBench::corrSum(Bench& b) {
+    for(int numVec : s_numVecs) {
+        for(int k : s_numPts) {
+            string name = benchName("corrsum/N=%d/k=%d", numVec, k);
+            if(!b.wanted(name)) {
+                continue;
+            }
+            vector<REAL> data = Bench::vectors(numVec, BENCH_DIM);
+            CorrDim cd(&(data[0]), numVec, BENCH_DIM);
+            vector<REAL> R = radii(cd.m_log_min_dist, cd.m_log_max_dist, k);
+            unsigned long int pairs = TRI(numVec) * k;
+            b.run(name, pairs, pairs * sizeof(REAL), [&] {
+                for(int i=0;i<k;i++) {
+                    cd.corrSum(R[i]);
+                }
+            });
+        }
+    }
+}
+
+
+void EngineBench::batchCorrSum(Bench& b) {
+    for(int numVec : s_numVecs) {
+        for(int k : s_numPts) {
+            string name = benchName("batch-corrsum/N=%d/k=%d", numVec, k);
+            if(!b.wanted(name)) {
+                continue;
+            }
+            vector<REAL> data = Bench::vectors(numVec, BENCH_DIM);
+            CorrDimLowMem cd(&(data[0]), numVec, BENCH_DIM);
+            vector<REAL> R = radii(cd.m_log_min_dist, cd.m_log_max_dist, k);
+            vector<REAL> log_cr(k), log_r(k);
+            // the vectors are read over and over, there is no stream of bytes
+            b.run(name, TRI(numVec), 0, [&] {
+                for(int i=0;i<k;i++) {
+                    log_r[i] = R[i];
+                    log_cr[i] = 0;
+                }
+                cd.batchCorrSum(&(log_cr[0]), &(log_r[0]), k);
+            });
+        }
+    }
+}
+
+
+void EngineBench::histogram(Bench& b) {
+    vector<int> hist(BENCH_BINS);
+    vector<REAL> bins(BENCH_BINS);
+    for(int numVec : s_numVecs) {
+        string name = benchName("histogram/full/N=%d", numVec);
+        if(!b.wanted(name)) {
+            continue;
+        }
+        vector<REAL> data = Bench::vectors(numVec, BENCH_DIM);
+        CorrDim cd(&(data[0]), numVec, BENCH_DIM);
+        unsigned long int pairs = TRI(numVec);
+        b.run(name, pairs, pairs * sizeof(REAL), [&] {
+            cd.getDistMatrixHistogram(BENCH_BINS, &(hist[0]), &(bins[0]));
+        });
+    }
+    string name = benchName("histogram/lowmem/N=%d", BENCH_NUMVEC);
+    if(b.wanted(name)) {
+        vector<REAL> data = Bench::vectors(BENCH_NUMVEC, BENCH_DIM);
+        CorrDimLowMem cd(&(data[0]), BENCH_NUMVEC, BENCH_DIM);
+        b.run(name, TRI(BENCH_NUMVEC), 0, [&] {
+            cd.getDistMatrixHistogram(BENCH_BINS, &(hist[0]), &(bins[0]));
+        });
+    }
+}
+
+
+void EngineBench::leastSquares(Bench& b) {
+    for(int n : s_fitPts) {
+        string name = benchName("least-squares/n=%d", n);
+        // a noisy line, so that the fit is a real one
+        vector<REAL> x(n), y(n);
+        vector<REAL> noise = Bench::vectors(n, 1);
+        for(int i=0;i<n;i++) {
+            x[i] = -5 + (0.2 * i);
+            y[i] = (1.5 * x[i]) + 0.3 + (0.01 * noise[i]);
+        }
+        unsigned long int points = (unsigned long int) n * BENCH_FITS;
+        b.run(name, points, points * 2 * sizeof(REAL), [&] {
+            REAL c0, c1;
+            for(int f=0;f<BENCH_FITS;f++) {
+                linearLeastSquares(c0, c1, &(x[0]), &(y[0]), n);
+            }
+        });
+    }
+}
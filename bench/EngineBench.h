@@ -0,0 +1,83 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_ENGINEBENCH_H__
+#define __INCLUDED_ENGINEBENCH_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "Bench.h"
+
+
+/**
+ * Microbenchmarks of the kernels of the engines. This is a friend of the
+ * engines, so that their private kernels can be timed in isolation, on
+ * deterministic synthetic vectors.
+ */
+class EngineBench {
+public:
+    /**
+     * @brief The distance matrix of 'CorrDim', by dimension of the vectors
+     * @param b the harness.
+     */
+    static void distances(Bench& b);
+
+    /**
+     * @brief The corr-sums of 'CorrDim' (one pass per 'R'), by N and k
+     * @param b the harness.
+     */
+    static void corrSum(Bench& b);
+
+    /**
+     * @brief The batch corr-sum of 'CorrDimLowMem' (one pass for all 'R'),
+     *  by N and k
+     * @param b the harness.
+     */
+    static void batchCorrSum(Bench& b);
+
+    /**
+     * @brief The histogram of the distances, from the stored matrix
+     *  ('CorrDim') and recomputing it ('CorrDimLowMem')
+     * @param b the harness.
+     */
+    static void histogram(Bench& b);
+
+    /**
+     * @brief The least squares fit, by number of points
+     * @param b the harness.
+     */
+    static void leastSquares(Bench& b);
+
+private:
+    /**
+     * @brief The values of 'R' used by 'evalCorrDim'
+     * @param logMin log of the smallest distance.
+     * @param logMax log of the largest distance.
+     * @param k number of values.
+     * @return the values
+     */
+    static std::vector<REAL> radii(REAL logMin, REAL logMax, int k);
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_ENGINEBENCH_H__
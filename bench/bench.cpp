@@ -0,0 +1,174 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Bench.h"
+#include "EngineBench.h"
+#include "maps/ChaoticMap.h"
+#include <unistd.h>
+
+
+using namespace std;
+
+
+/** vectors generated by every run of the map benchmarks */
+#define BENCH_MAP_NUMELE  200000
+/** dimension of the synthetic file read by 'CustomVectors' */
+#define BENCH_FILE_DIM    3
+/** trajectories generated at once by the ensemble benchmarks */
+#define BENCH_ENSEMBLE    1000
+
+
+/**
+ * @brief Prints the help and exits
+ */
+static void showHelp() {
+    fprintf(stdout, "corrdim-bench: Microbenchmarks of the kernels of 'corrdim'.\n");
+    fprintf(stdout, "USAGE:\n");
+    fprintf(stdout, " corrdim-bench [-h] [-filter <str>, -reps <n>, -warmup <n>]\n");
+    fprintf(stdout, "  -h                 Print this help and exit.\n");
+    fprintf(stdout, "  -filter <str>      Only run the benchmarks whose name contains <str>\n");
+    fprintf(stdout, "                     (eg: 'corrsum/N=2000'). [\"\"]\n");
+    fprintf(stdout, "  -reps <n>          Timed runs of every benchmark. [%d]\n", BENCH_REPS);
+    fprintf(stdout, "  -warmup <n>        Untimed runs before them. [%d]\n", BENCH_WARMUP);
+    fprintf(stdout, "Every line has the median and the min time of a run, the time per item\n");
+    fprintf(stdout, "(pair of vectors, point of the fit or generated vector) of the median and\n");
+    fprintf(stdout, "the bandwidth of the bytes streamed (the distance matrix, the points of the\n");
+    fprintf(stdout, "fit or the vectors), where there is such a stream.\n");
+    exit(0);
+}
+
+
+/**
+ * @brief Writes the synthetic text file read by 'CustomVectors'
+ * @return the file (to be removed by the caller)
+ */
+static string writeVectors() {
+    char file[] = "/tmp/corrdim-bench-XXXXXX";
+    int fd = mkstemp(file);
+    FILE* fp = (fd < 0)? NULL : fdopen(fd, "w");
+    if(fp == NULL) {
+        fprintf(stderr, "Failed to create a temporary file for the vectors!\n");
+        exit(1);
+    }
+    vector<REAL> vals = Bench::vectors(BENCH_MAP_NUMELE, BENCH_FILE_DIM);
+    for(size_t i=0;i<vals.size();i+=BENCH_FILE_DIM) {
+        fprintf(fp, "%.15f %.15f %.15f\n", vals[i], vals[i+1], vals[i+2]);
+    }
+    fclose(fp);
+    return file;
+}
+
+
+/**
+ * @brief The generation of the vectors, for every map, one trajectory at a
+ *  time and (for the maps generating them) many trajectories at once
+ * @param b the harness.
+ */
+static void generateMaps(Bench& b) {
+    vector<string> maps = MapRegistry::names();
+    for(vector<string>::const_iterator itr=maps.begin();itr!=maps.end();itr++) {
+        string name = "generate/" + *itr;
+        string ensName = "ensemble/" + *itr + "/K=" + to_string(BENCH_ENSEMBLE);
+        if(!b.wanted(name) && !b.wanted(ensName)) {
+            continue;
+        }
+        vector<string> args(1, "corrdim-bench");
+        string file;
+        if(*itr == "CustomVectors") {
+            file = writeVectors();
+            args.push_back("-file");
+            args.push_back(file);
+            args.push_back("-dim");
+            args.push_back(to_string(BENCH_FILE_DIM));
+        }
+        vector<char*> argv;
+        for(size_t a=0;a<args.size();a++) {
+            argv.push_back((char*) args[a].c_str());
+        }
+        ChaoticMap* map = MapRegistry::create(*itr);
+        int dim = (file != "")? BENCH_FILE_DIM : map->getDimension();
+        bool ensemble = !map->sizedByInput();
+        delete map;
+        unsigned long int bytes = (unsigned long int) BENCH_MAP_NUMELE * dim * sizeof(REAL);
+        // the maps print their parameters and times
+        b.run(name, BENCH_MAP_NUMELE, bytes, [&] {
+            ChaoticMap* m = MapRegistry::create(*itr);
+            int numEle = BENCH_MAP_NUMELE;
+            REAL* arr = m->generateVectors(numEle, 1, (int) argv.size(), &(argv[0]));
+            m->releaseVectors(arr);
+            delete m;
+        }, true);
+        if(file != "") {
+            unlink(file.c_str());
+        }
+        // the same number of vectors, spread over many trajectories
+        if(!ensemble) {
+            continue;
+        }
+        int numEle = BENCH_MAP_NUMELE / BENCH_ENSEMBLE;
+        b.run(ensName, BENCH_MAP_NUMELE, bytes, [&] {
+            ChaoticMap* m = MapRegistry::create(*itr);
+            REAL* arr = m->generateEnsemble(numEle, BENCH_ENSEMBLE, 1, (int) argv.size(), &(argv[0]));
+            if(arr != NULL) {
+                m->releaseVectors(arr);
+            }
+            delete m;
+        }, true);
+    }
+}
+
+
+
+int main(int argc, char** argv) {
+    int reps = BENCH_REPS;
+    int warmup = BENCH_WARMUP;
+    string filter;
+    for(int i=1;i<argc;i++) {
+        if(!strcmp("-h", argv[i])) {
+            showHelp();
+        }
+        else if(!strcmp("-filter", argv[i])) {
+            OPTION_CHECK("-filter", i, argc);
+            filter = argv[i];
+        }
+        else if(!strcmp("-reps", argv[i])) {
+            OPTION_CHECK("-reps", i, argc);
+            GET_INTEGER(reps, "-reps", argv[i]);
+            CHECK_POSITIVE(reps, "-reps");
+        }
+        else if(!strcmp("-warmup", argv[i])) {
+            OPTION_CHECK("-warmup", i, argc);
+            GET_INTEGER(warmup, "-warmup", argv[i]);
+        }
+        else {
+            fprintf(stderr, "Unknown option passed '%s'!\n", argv[i]);
+            exit(1);
+        }
+    }
+    Bench b(reps, warmup, filter);
+    b.printHeader();
+    EngineBench::distances(b);
+    EngineBench::corrSum(b);
+    EngineBench::batchCorrSum(b);
+    EngineBench::histogram(b);
+    EngineBench::leastSquares(b);
+    generateMaps(b);
+    return 0;
+}
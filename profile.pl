@@ -5,26 +5,23 @@
 
 use strict;
 use warnings;
+use JSON::PP;
+
+# where every run writes its metrics
+my $metrics = ".results_metrics.json";
 
 sub runAtest {
     my ($numele, $lowmem) = @_;
-    my $cmd = "./corrdim -numele $numele";
+    my $cmd = "./corrdim -numele $numele -metrics $metrics";
     $cmd .= " -lowmem"   if($lowmem);
     printf("Working on '$cmd'... ");
-    my @output = split(/\n/, `$cmd`);
-    my $memory = -1;
-    my $time = -1;
-    foreach my $line (@output) {
-	if($line =~ /Maximum memory usage/) {
-	    $memory = (split(/\s+/, $line))[5];
-	    $memory =~ s/\~//;
-	    next;
-	}
-	if($line =~ /Total time taken/) {
-	    $time = (split(/\s+/, $line))[3];
-	    next;
-	}
-    }
+    system("$cmd > /dev/null") == 0 or die "Failed to run '$cmd'!";
+    open(my $fp, "<", $metrics) or die "Failed to open '$metrics'!";
+    my $run = decode_json(join("", <$fp>));
+    close($fp);
+    # measured, not the estimate of the cost model
+    my $memory = sprintf("%.1f", $run->{peakRss} / 1048576);
+    my $time = $run->{wall};
     printf(" (Mem=$memory Time=$time)\n");
     return ($memory, $time);
 }
@@ -44,7 +41,7 @@ open(FILE, ">$profile") or die("Failed to open '$profile'!");
 foreach my $numele (@elements) {
     my ($mem1, $time1) = runAtest($numele, 0);
     my ($mem2, $time2) = runAtest($numele, 1);
-    printf FILE "%6d %.6f %4d %.6f %4d\n", $numele, $time1, $mem1, $time2, $mem2;
+    printf FILE "%6d %.6f %8.1f %.6f %8.1f\n", $numele, $time1, $mem1, $time2, $mem2;
 }
 close(FILE);
 # plot
@@ -59,7 +56,7 @@ print PLT "     \"$profile\" using 1:4 title \"CorrDimLowMemTime\" with linespoi
 print PLT "\n";
 print PLT "set output \"$png_mem\"\n";
 print PLT "set xlabel \"Num Elements\"\n";
-print PLT "set ylabel \"Memory(MB)\"\n";
+print PLT "set ylabel \"Peak RSS(MB)\"\n";
 print PLT "plot \"$profile\" using 1:3 title \"CorrDimMem\" with linespoints,";
 print PLT "     \"$profile\" using 1:5 title \"CorrDimLowMemMem\" with linespoints\n";
 close(PLT);
@@ -67,4 +64,5 @@ system("gnuplot $plt");
 # clean
 print "Cleaning...\n";
 unlink($plt);
+unlink($metrics);
 print "Done...\n";
@@ -0,0 +1,39 @@
+#!/usr/bin/env perl
+#
+# Client for 'corrdim -serve <socket>'. Sends the jobs (one per line) read
+# from stdin, or the ones passed as arguments, and prints the answers.
+#
+# USAGE:
+#  ./serve-client.pl <socket> ['job1' 'job2' ...]
+#  eg: ./serve-client.pl /tmp/corrdim.sock 'id=1 numele=5000' 'id=2 map=HenonMap'
+#      echo quit | ./serve-client.pl /tmp/corrdim.sock
+#
+
+use strict;
+use warnings;
+use IO::Socket::UNIX;
+use Socket qw(SOCK_STREAM SHUT_WR);
+
+if(scalar(@ARGV) < 1) {
+    die "USAGE: $0 <socket> ['job1' 'job2' ...]\n";
+}
+my $path = shift(@ARGV);
+my $sock = IO::Socket::UNIX->new(Type => SOCK_STREAM, Peer => $path)
+    or die "Failed to connect to '$path'! ($!)\n";
+$sock->autoflush(1);
+my @jobs = (scalar(@ARGV) > 0)? @ARGV : <STDIN>;
+my $count = 0;
+foreach my $job (@jobs) {
+    chomp($job);
+    next if($job =~ /^\s*$/);
+    print $sock "$job\n";
+    last if($job =~ /^quit/);
+    $count++;
+}
+# no more jobs, server answers the pending ones and then we're done
+shutdown($sock, SHUT_WR);
+while(($count > 0) && defined(my $line = <$sock>)) {
+    print $line;
+    $count--;
+}
+close($sock);
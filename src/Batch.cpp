@@ -0,0 +1,245 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Batch.h"
+#include "TextParser.h"
+#include <algorithm>
+#include <cmath>
+#include <dirent.h>
+#include <sys/stat.h>
+
+
+using namespace std;
+
+
+void Batch::load(const string& path) {
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) {
+        fprintf(stderr, "Failed to open '%s' for reading the series!\n", path.c_str());
+        exit(1);
+    }
+    if(!S_ISDIR(st.st_mode)) {
+        loadFile(path);
+        return;
+    }
+    DIR* dir = opendir(path.c_str());
+    if(dir == NULL) {
+        fprintf(stderr, "Failed to open the directory '%s'!\n", path.c_str());
+        exit(1);
+    }
+    vector<string> files;
+    dirent* ent;
+    while((ent = readdir(dir)) != NULL) {
+        string file = path + "/" + ent->d_name;
+        if((ent->d_name[0] != '.') && (stat(file.c_str(), &st) == 0) && S_ISREG(st.st_mode)) {
+            files.push_back(file);
+        }
+    }
+    closedir(dir);
+    // readdir order is arbitrary, keep the output table reproducible
+    sort(files.begin(), files.end());
+    for(size_t i=0;i<files.size();i++) {
+        loadFile(files[i]);
+    }
+}
+
+
+void Batch::loadFile(const string& file) {
+    FILE* fp = fopen(file.c_str(), "r");
+    if(fp == NULL) {
+        fprintf(stderr, "Failed to open the file '%s' for reading the series!\n", file.c_str());
+        exit(1);
+    }
+    string buf;
+    char chunk[1 << 16];
+    size_t n;
+    while((n = fread(chunk, 1, sizeof(chunk), fp)) > 0) {
+        buf.append(chunk, n);
+    }
+    fclose(fp);
+    // the parser needs every line (the last one included) to end with '\n'
+    if((buf.size() > 0) && (buf[buf.size()-1] != '\n')) {
+        buf += '\n';
+    }
+    int line = 0;
+    size_t first = m_series.size();
+    string name = "";
+    const char* ptr = buf.c_str();
+    const char* end = ptr + buf.size();
+    while(ptr < end) {
+        const char* eol = (const char*) memchr(ptr, '\n', end - ptr);
+        line++;
+        const char* p = ptr;
+        while((p < eol) && isspace(*p)) {
+            p++;
+        }
+        // separator: '# <name>' names the series following it
+        if((p == eol) || (*p == '#')) {
+            if((p < eol) && (*p == '#')) {
+                istringstream iss(string(p + 1, eol));
+                iss >> name;
+            }
+            ptr = eol + 1;
+            continue;
+        }
+        // the series runs up to the next separator line
+        int begin = line;
+        const char* last = eol + 1;
+        while(last < end) {
+            const char* next = (const char*) memchr(last, '\n', end - last);
+            const char* q = last;
+            while((q < next) && isspace(*q)) {
+                q++;
+            }
+            if((q == next) || (*q == '#')) {
+                break;
+            }
+            last = next + 1;
+            line++;
+        }
+        // same formats as 'CustomVectors' (spaces, tabs or commas)
+        TextParser parser;
+        size_t len = last - ptr;
+        size_t offset = m_data.size();
+        if((parser.firstLine(ptr, len) != 1) || !parser.parseLines(ptr, len, m_data)) {
+            fprintf(stderr, "Bad series starting on line %d of the file '%s': %s!\n", begin,
+                    file.c_str(), parser.error().c_str());
+            exit(1);
+        }
+        addSeries(name, offset, parser.cols());
+        name = "";
+        ptr = last;
+    }
+    // unnamed ones are named after the file (and their index in it)
+    for(size_t i=first;i<m_series.size();i++) {
+        if(m_series[i].name == "") {
+            m_series[i].name = file;
+            if(m_series.size() - first > 1) {
+                m_series[i].name += ":" + to_string(i - first + 1);
+            }
+        }
+    }
+}
+
+
+void Batch::add(const string& name, const REAL* data, int numVec, int dim) {
+    size_t offset = m_data.size();
+    m_data.insert(m_data.end(), data, data + ((size_t) numVec * dim));
+    addSeries(name, offset, dim);
+}
+
+
+void Batch::addSeries(const string& name, size_t offset, int dim) {
+    Series s;
+    s.name = name;
+    s.offset = offset;
+    s.dim = dim;
+    s.numVec = (int) ((m_data.size() - offset) / dim);
+    m_series.push_back(s);
+}
+
+
+int Batch::maxVectors() const {
+    int res = 0;
+    for(size_t i=0;i<m_series.size();i++) {
+        res = max(res, m_series[i].numVec);
+    }
+    return res;
+}
+
+
+int Batch::maxDimension() const {
+    int res = 0;
+    for(size_t i=0;i<m_series.size();i++) {
+        res = max(res, m_series[i].dim);
+    }
+    return res;
+}
+
+
+REAL Batch::run(const CorrDimParams& params, ThreadPool& pool) {
+    int numSeries = size();
+    m_results.resize(numSeries);
+    // longest ones first, so that the last few workers don't finish late
+    vector<int> order(numSeries);
+    for(int i=0;i<numSeries;i++) {
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return m_series[a].numVec > m_series[b].numVec;
+    });
+    // per-worker buffers, kept across the series
+    vector<CorrDimResult> results(pool.size());
+    vector<CorrDimArena> arenas(pool.size());
+    REAL start = wallTime();
+    pool.parallelFor(numSeries, [&](int task, int worker) {
+        const Series& s = m_series[order[task]];
+        Outcome& out = m_results[order[task]];
+        CorrDimView view = { &(m_data[s.offset]), s.numVec, s.dim };
+        REAL t0 = wallTime();
+        out.status = corrDimEvaluate(view, params, results[worker], NULL, &(arenas[worker]));
+        out.time = wallTime() - t0;
+        out.dimension = results[worker].dimension;
+        out.residual = results[worker].residual;
+        out.engine = results[worker].engine;
+    });
+    return wallTime() - start;
+}
+
+
+int Batch::summary(REAL& mean, REAL& stddev) const {
+    int num = 0;
+    REAL sum = 0, sum2 = 0;
+    for(size_t i=0;i<m_results.size();i++) {
+        if(m_results[i].status == CORRDIM_OK) {
+            num++;
+            sum += m_results[i].dimension;
+            sum2 += m_results[i].dimension * m_results[i].dimension;
+        }
+    }
+    mean = (num > 0)? sum / num : 0;
+    stddev = (num > 1)? (REAL) sqrt(max((sum2 - (num * mean * mean)) / (num - 1), (REAL) 0)) : 0;
+    return num;
+}
+
+
+void Batch::writeTable(const string& file) const {
+    FILE* fp = (file == "")? stdout : fopen(file.c_str(), "w");
+    if(fp == NULL) {
+        fprintf(stderr, "Failed to open the file '%s' for writing!\n", file.c_str());
+        exit(1);
+    }
+    fprintf(fp, "# name  numvec  dim  dimension  engine  time  status\n");
+    for(size_t i=0;i<m_series.size();i++) {
+        const Series& s = m_series[i];
+        const Outcome& out = m_results[i];
+        if(out.status == CORRDIM_OK) {
+            fprintf(fp, "%s  %d  %d  %f  %s  %f  ok\n", s.name.c_str(), s.numVec, s.dim,
+                    out.dimension, engineName(out.engine), out.time);
+        }
+        else {
+            fprintf(fp, "%s  %d  %d  nan  -  %f  %s\n", s.name.c_str(), s.numVec, s.dim,
+                    out.time, corrDimError(out.status));
+        }
+    }
+    if(fp != stdout) {
+        fclose(fp);
+    }
+}
@@ -0,0 +1,171 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_BATCH_H__
+#define __INCLUDED_BATCH_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include "libcorrdim.h"
+
+
+/**
+ * Many independent (and usually short) series, evaluated in one go (see
+ * '-batch'). All the series are loaded into one contiguous buffer and then
+ * scheduled across the workers, one series per worker at a time. Every
+ * worker keeps its result buffers and its engine scratch memory across the
+ * series it evaluates, so there are no allocations per series once these
+ * have grown to the size of the longest one.
+ *
+ * Input format: same as that of 'CustomVectors', ie, one vector per line.
+ * A blank line or a line starting with '#' ends the current series. The
+ * first word after a '#' names the next series, else it is named after the
+ * file (and its index inside the file). The dimension of each series is the
+ * number of values on its first line.
+ *
+ * Usage:
+ *  Batch b;
+ *  b.load("series.txt");   // or a directory, every file in it is loaded
+ *  b.run(params, pool);
+ *  b.writeTable("results.txt");
+ */
+class Batch {
+public:
+    /**
+     * @brief Loads the series from a file or from all the files in a directory
+     * @param path the file or the directory.
+     */
+    void load(const std::string& path);
+
+    /**
+     * @brief Adds a series which is already in memory
+     * @param name name of the series.
+     * @param data its numVec x dim values (copied).
+     * @param numVec number of vectors.
+     * @param dim dimension of the vectors.
+     */
+    void add(const std::string& name, const REAL* data, int numVec, int dim);
+
+    /**
+     * @brief Number of series loaded so far
+     * @return the count
+     */
+    int size() const { return (int) m_series.size(); }
+
+    /**
+     * @brief Number of vectors in the longest series loaded so far
+     * @return the count
+     */
+    int maxVectors() const;
+
+    /**
+     * @brief Largest dimension among the series loaded so far
+     * @return the dimension
+     */
+    int maxDimension() const;
+
+    /**
+     * @brief Evaluates all the series
+     * @param params parameters common to all the series.
+     * @param pool the workers. Every series runs on one worker only.
+     * @return wall-clock time taken (in s)
+     */
+    REAL run(const CorrDimParams& params, ThreadPool& pool);
+
+    /**
+     * @brief Writes one line of results per series, in the order of loading
+     * @param file the output file. Empty string means stdout.
+     */
+    void writeTable(const std::string& file) const;
+
+    /**
+     * @brief Mean and standard deviation of the dimensions found by 'run'
+     * @param mean the mean (output).
+     * @param stddev the standard deviation (output).
+     * @return number of series evaluated successfully, which are the only
+     *  ones taken into account
+     */
+    int summary(REAL& mean, REAL& stddev) const;
+
+    /**
+     * @brief Status of the given series, once 'run'
+     * @param i the series (in the order of loading).
+     * @return the status from the library
+     */
+    CorrDimStatus status(int i) const { return m_results[i].status; }
+
+    /**
+     * @brief Correlation dimension of the given series (if its status is CORRDIM_OK)
+     * @param i the series (in the order of loading).
+     * @return the dimension
+     */
+    REAL dimension(int i) const { return m_results[i].dimension; }
+
+    /**
+     * @brief Residual of the best-fit of the given series (see 'CorrDimResult')
+     * @param i the series (in the order of loading).
+     * @return the residual
+     */
+    REAL residual(int i) const { return m_results[i].residual; }
+
+private:
+    /** one series inside 'm_data' */
+    struct Series {
+        std::string name;   ///< name of the series
+        size_t offset;      ///< first value of this series in 'm_data'
+        int numVec;         ///< number of vectors
+        int dim;            ///< dimension of the vectors
+    };
+
+    /** results of one series */
+    struct Outcome {
+        CorrDimStatus status; ///< status from the library
+        REAL dimension;       ///< the correlation dimension
+        REAL residual;        ///< residual of the best-fit
+        EngineType engine;    ///< engine used
+        REAL time;            ///< wall-clock time taken (in s)
+    };
+
+    /**
+     * @brief Loads all the series in one file
+     * @param file the file.
+     */
+    void loadFile(const std::string& file);
+
+    /**
+     * @brief Closes the series being read (if any) from the end of 'm_data'
+     * @param name name of the series.
+     * @param offset its first value in 'm_data'.
+     * @param dim its dimension.
+     */
+    void addSeries(const std::string& name, size_t offset, int dim);
+
+private:
+    std::vector<REAL> m_data;        ///< values of all the series, back to back
+    std::vector<Series> m_series;    ///< the series
+    std::vector<Outcome> m_results;  ///< results, one per series
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_BATCH_H__
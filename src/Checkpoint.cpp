@@ -0,0 +1,230 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Checkpoint.h"
+#include "Timer.h"
+#include "Trace.h"
+#include <csignal>
+#include <cstdint>
+#include <unistd.h>
+#include <fcntl.h>
+
+
+using namespace std;
+
+
+/** identifies (and versions) the checkpoint files */
+#define CKPT_MAGIC "CDCKPT01"
+
+
+/** set by the SIGTERM handler */
+static volatile sig_atomic_t s_stop = 0;
+/** whether 'onTerm' is installed */
+static bool s_caught = false;
+/** SIGTERM action before 'catchSignals' */
+static struct sigaction s_oldTerm;
+
+/**
+ * @brief SIGTERM handler. The checkpoint itself is written by the next poll.
+ * @param sig the signal
+ */
+static void onTerm(int sig) {
+    s_stop = 1;
+}
+
+
+Checkpoint::Checkpoint(const string& file, REAL interval) {
+    m_file = file;
+    m_interval = interval;
+    m_next = wallTime() + interval;
+    m_numVec = m_dim = m_numPts = m_numBins = 0;
+    m_hash = 0;
+    m_loaded = false;
+    m_phase = CKPT_MINMAX;
+    m_row = 0;
+    m_minDist = m_maxDist = 0;
+}
+
+void Checkpoint::catchSignals() {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = onTerm;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, &s_oldTerm);
+    s_caught = true;
+}
+
+
+bool Checkpoint::attach(const REAL* data, int numVec, int dim, int numPts, int numBins) {
+    // FNV-1a over the raw bytes of the vectors
+    const unsigned char* bytes = (const unsigned char*) data;
+    unsigned long int len = (unsigned long int) numVec * dim * sizeof(REAL);
+    uint64_t hash = 14695981039346656037UL;
+    for(unsigned long int i=0;i<len;i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211UL;
+    }
+    if(m_loaded) {
+        if((numVec != m_numVec) || (dim != m_dim) || (hash != m_hash)) {
+            m_error = "it was taken for different vectors";
+            return false;
+        }
+        if((numPts != m_numPts) || (numBins != m_numBins)) {
+            m_error = "it was taken with '-numpts " + to_string(m_numPts) + " -numbins " +
+                to_string(m_numBins) + "'";
+            return false;
+        }
+        return true;
+    }
+    m_numVec = numVec;
+    m_dim = dim;
+    m_numPts = numPts;
+    m_numBins = numBins;
+    m_hash = hash;
+    return true;
+}
+
+
+bool Checkpoint::due() const {
+    return s_stop || (wallTime() >= m_next);
+}
+
+void Checkpoint::save(int phase, int row, REAL minDist, REAL maxDist, const REAL* counts, int num) {
+    m_phase = phase;
+    m_row = row;
+    m_minDist = minDist;
+    m_maxDist = maxDist;
+    if(phase == CKPT_CORRSUM) {
+        m_sums.assign(counts, counts + num);
+    }
+    else if(phase == CKPT_HIST) {
+        m_hist.assign(counts, counts + num);
+    }
+    unsigned long long begin = Timer::ticks();
+    bool ok = write();
+    Trace::event("checkpoint", "io", begin, Timer::ticks());
+    // a failed checkpoint shouldn't kill the run itself
+    if(!ok) {
+        fprintf(stderr, "WARNING: Failed to write the checkpoint '%s'!\n", m_file.c_str());
+    }
+    m_next = wallTime() + m_interval;
+    if(s_stop) {
+        fprintf(stderr, "Caught SIGTERM. Saved the checkpoint '%s', resume the run with "
+                "'-resume %s'.\n", m_file.c_str(), m_file.c_str());
+        exit(128 + SIGTERM);
+    }
+}
+
+void Checkpoint::save(int phase, int row, REAL minDist, REAL maxDist, const int* counts, int num) {
+    vector<REAL> vals(counts, counts + num);
+    save(phase, row, minDist, maxDist, vals.data(), num);
+}
+
+void Checkpoint::remove() {
+    unlink(m_file.c_str());
+    // nothing left to save, so SIGTERM must kill the process again
+    if(s_caught) {
+        sigaction(SIGTERM, &s_oldTerm, NULL);
+        s_caught = false;
+        if(s_stop) {
+            s_stop = 0;
+            raise(SIGTERM);
+        }
+    }
+}
+
+
+bool Checkpoint::write() {
+    string tmp = m_file + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "wb");
+    if(fp == NULL) {
+        return false;
+    }
+    int32_t head[6] = {m_numVec, m_dim, m_numPts, m_numBins, m_phase, m_row};
+    uint64_t hash = m_hash;
+    uint64_t numSums = m_sums.size(), numHist = m_hist.size();
+    bool ok = (fwrite(CKPT_MAGIC, 1, 8, fp) == 8) &&
+        (fwrite(head, sizeof(head), 1, fp) == 1) &&
+        (fwrite(&hash, sizeof(hash), 1, fp) == 1) &&
+        (fwrite(&m_minDist, sizeof(m_minDist), 1, fp) == 1) &&
+        (fwrite(&m_maxDist, sizeof(m_maxDist), 1, fp) == 1) &&
+        (fwrite(&numSums, sizeof(numSums), 1, fp) == 1) &&
+        (fwrite(m_sums.data(), sizeof(REAL), numSums, fp) == numSums) &&
+        (fwrite(&numHist, sizeof(numHist), 1, fp) == 1) &&
+        (fwrite(m_hist.data(), sizeof(REAL), numHist, fp) == numHist) &&
+        (fflush(fp) == 0) && (fsync(fileno(fp)) == 0);
+    ok = (fclose(fp) == 0) && ok;
+    // the rename is atomic, so the old checkpoint stays valid until now
+    ok = ok && (rename(tmp.c_str(), m_file.c_str()) == 0);
+    if(!ok) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    // the rename itself is only durable once its directory is synced
+    size_t slash = m_file.rfind('/');
+    string dir = (slash == string::npos)? "." : m_file.substr(0, (slash == 0)? 1 : slash);
+    int fd = open(dir.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    ok = (fsync(fd) == 0);
+    close(fd);
+    return ok;
+}
+
+bool Checkpoint::load(const string& file) {
+    FILE* fp = fopen(file.c_str(), "rb");
+    if(fp == NULL) {
+        m_error = "failed to open the file";
+        return false;
+    }
+    char magic[8];
+    int32_t head[6];
+    uint64_t hash, numSums = 0, numHist = 0;
+    bool ok = (fread(magic, 1, 8, fp) == 8) && !memcmp(magic, CKPT_MAGIC, 8) &&
+        (fread(head, sizeof(head), 1, fp) == 1) &&
+        (fread(&hash, sizeof(hash), 1, fp) == 1) &&
+        (fread(&m_minDist, sizeof(m_minDist), 1, fp) == 1) &&
+        (fread(&m_maxDist, sizeof(m_maxDist), 1, fp) == 1) &&
+        (fread(&numSums, sizeof(numSums), 1, fp) == 1) &&
+        ((numSums == 0) || (numSums == (uint64_t) head[2]));
+    if(ok) {
+        m_sums.resize(numSums);
+        ok = (fread(m_sums.data(), sizeof(REAL), numSums, fp) == numSums) &&
+            (fread(&numHist, sizeof(numHist), 1, fp) == 1) && (numHist <= (uint64_t) head[3]);
+    }
+    if(ok) {
+        m_hist.resize(numHist);
+        ok = (fread(m_hist.data(), sizeof(REAL), numHist, fp) == numHist);
+    }
+    fclose(fp);
+    if(!ok || (head[4] < CKPT_MINMAX) || (head[4] > CKPT_HIST)) {
+        m_error = "not a checkpoint file (or a truncated one)";
+        return false;
+    }
+    m_numVec = head[0];
+    m_dim = head[1];
+    m_numPts = head[2];
+    m_numBins = head[3];
+    m_phase = head[4];
+    m_row = head[5];
+    m_hash = hash;
+    m_loaded = true;
+    return true;
+}
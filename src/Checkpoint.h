@@ -0,0 +1,195 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_CHECKPOINT_H__
+#define __INCLUDED_CHECKPOINT_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+
+
+/** phase evaluating the min/max distance */
+#define CKPT_MINMAX   0
+/** phase evaluating the correlation sums */
+#define CKPT_CORRSUM  1
+/** phase evaluating the histogram of the distance matrix */
+#define CKPT_HIST     2
+/** default seconds between two checkpoints */
+#define CKPT_INTERVAL 600
+
+
+/**
+ * Periodic checkpoints of the passes over the distance matrix done by
+ * 'CorrDimLowMem', so that a long run which gets killed can be resumed from
+ * its last completed row instead of from scratch.
+ *
+ * The engine polls 'due' after every row and, when it's time, hands over its
+ * state: the pass it's in, the rows completed, the min/max distance and the
+ * partial counts. These are written into a temporary file, which is then
+ * renamed over the checkpoint, so that a crash can never leave a half
+ * written checkpoint behind. After 'catchSignals', a SIGTERM makes the next
+ * poll save a final checkpoint and exit.
+ *
+ * Usage:
+ *  Checkpoint ckpt("run.ckpt", CKPT_INTERVAL);
+ *  if(resuming && !ckpt.load("run.ckpt")) printf("%s\n", ckpt.error().c_str());
+ *  if(!ckpt.attach(data, numVec, dim, numPts, numBins)) ...
+ *  CorrDimLowMem cd(data, numVec, dim, NULL, &ckpt);
+ */
+class Checkpoint {
+public:
+    /**
+     * @brief Constructor of this class.
+     * @param file where to write the checkpoints.
+     * @param interval seconds between two checkpoints.
+     */
+    Checkpoint(const std::string& file, REAL interval);
+
+    /**
+     * @brief Reads the state to be resumed from
+     * @param file the checkpoint.
+     * @return true on success, else see 'error'
+     */
+    bool load(const std::string& file);
+
+    /**
+     * @brief Ties the checkpoint to the data and the parameters of the run
+     * @param data the vectors.
+     * @param numVec number of vectors.
+     * @param dim dimension of the vectors.
+     * @param numPts number of points on the log(CR) vs log(R) plot.
+     * @param numBins number of bins in the distance-matrix histogram.
+     * @return false if a loaded checkpoint was taken for a different run
+     *  (see 'error')
+     */
+    bool attach(const REAL* data, int numVec, int dim, int numPts, int numBins);
+
+    /**
+     * @brief Installs the SIGTERM handler
+     */
+    static void catchSignals();
+
+    /**
+     * @brief Whether the engine should hand over its state now
+     * @return true when the interval is over or SIGTERM has arrived
+     */
+    bool due() const;
+
+    /**
+     * @brief Writes a checkpoint. Exits, if SIGTERM has arrived.
+     * @param phase the pass (CKPT_MINMAX, CKPT_CORRSUM or CKPT_HIST).
+     * @param row rows of the pass completed so far.
+     * @param minDist min distance, as held by the engine.
+     * @param maxDist max distance, as held by the engine.
+     * @param counts partial counts of the pass (NULL for CKPT_MINMAX).
+     * @param num number of counts.
+     *
+     * The counts of CKPT_CORRSUM are kept across the checkpoints of the
+     * later passes.
+     */
+    void save(int phase, int row, REAL minDist, REAL maxDist, const REAL* counts, int num);
+
+    /**
+     * @brief Same as above, for integer counts
+     */
+    void save(int phase, int row, REAL minDist, REAL maxDist, const int* counts, int num);
+
+    /**
+     * @brief Deletes the checkpoint, once the run is over
+     *
+     * Also restores the SIGTERM action replaced by 'catchSignals' and, if
+     * SIGTERM arrived after the last poll, raises it again.
+     */
+    void remove();
+
+    /**
+     * @brief Pass to be resumed
+     * @return the pass
+     */
+    int phase() const { return m_phase; }
+
+    /**
+     * @brief Rows of that pass already completed
+     * @return the count
+     */
+    int row() const { return m_row; }
+
+    /**
+     * @brief Min distance, as held by the engine
+     * @return the distance
+     */
+    REAL minDist() const { return m_minDist; }
+
+    /**
+     * @brief Max distance, as held by the engine
+     * @return the distance
+     */
+    REAL maxDist() const { return m_maxDist; }
+
+    /**
+     * @brief Partial (or complete) counts of CKPT_CORRSUM
+     * @return the counts
+     */
+    const std::vector<REAL>& sums() const { return m_sums; }
+
+    /**
+     * @brief Partial counts of CKPT_HIST
+     * @return the counts
+     */
+    const std::vector<REAL>& hist() const { return m_hist; }
+
+    /**
+     * @brief Error message of the last failed call
+     * @return the message
+     */
+    const std::string& error() const { return m_error; }
+
+private:
+    /**
+     * @brief Writes the checkpoint into a temporary file and renames it
+     * @return true on success
+     */
+    bool write();
+
+private:
+    std::string m_file;         ///< where to write the checkpoints
+    REAL m_interval;            ///< seconds between two checkpoints
+    REAL m_next;                ///< wall time of the next checkpoint
+    int m_numVec;               ///< number of vectors of the run
+    int m_dim;                  ///< dimension of the vectors
+    int m_numPts;               ///< points on the log(CR) vs log(R) plot
+    int m_numBins;              ///< bins in the histogram
+    unsigned long int m_hash;   ///< fingerprint of the vectors
+    bool m_loaded;              ///< whether the state was read from a file
+    int m_phase;                ///< current pass
+    int m_row;                  ///< rows of that pass completed
+    REAL m_minDist;             ///< min distance
+    REAL m_maxDist;             ///< max distance
+    std::vector<REAL> m_sums;   ///< counts of CKPT_CORRSUM
+    std::vector<REAL> m_hist;   ///< counts of CKPT_HIST
+    std::string m_error;        ///< error message
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_CHECKPOINT_H__
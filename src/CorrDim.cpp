@@ -19,19 +19,25 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "CorrDim.h"
+#include "Metrics.h"
+#include "MemTrack.h"
+#include "Progress.h"
 
 
 
 
-CorrDim::CorrDim(REAL* _data, int _numVec, int _dim/*=1*/) {
+CorrDim::CorrDim(const REAL* _data, int _numVec, int _dim/*=1*/, REAL* _dist/*=NULL*/,
+                 VectorStream* _stream/*=NULL*/) {
     m_data = _data;
+    m_stream = _stream;
     m_numVec = _numVec;
     m_dim = _dim;
     m_num_ele = m_numVec * m_dim;
     // number of elements in lower triangular distance-matrix
-    m_numDist = ((m_numVec - 1) * m_numVec) >> 1;
-    m_dist = new REAL[m_numDist];
-    m_div = (REAL) (m_numVec * m_numVec);
+    m_numDist = TRI(m_numVec);
+    m_ownDist = (_dist == NULL);
+    m_dist = m_ownDist? MemTrack::allocate<REAL>(m_numDist, MEM_DISTANCES) : _dist;
+    m_div = (REAL) m_numVec * (REAL) m_numVec;
     m_log_min_dist = std::numeric_limits<REAL>::max();
     m_log_max_dist = -1;
     evaluateDistMatrix();
@@ -39,11 +45,8 @@ CorrDim::CorrDim(REAL* _data, int _numVec, int _dim/*=1*/) {
 
 
 CorrDim::~CorrDim() {
-    if(m_data != NULL) {
-        delete m_data;
-    }
-    if(m_dist != NULL) {
-        delete m_dist;
+    if(m_ownDist && (m_dist != NULL)) {
+        MemTrack::release(m_dist);
     }
 }
 
@@ -61,7 +64,9 @@ REAL CorrDim::evalCorrDim(int k, int discardl, int discardr,
     // least squares
     REAL c0, c1;
     int n = k - (discardl + discardr);
+    Metrics::enter(PHASE_FIT);
     linearLeastSquares(c0, c1, log_r+discardl, log_cr+discardl, n);
+    Metrics::leave();
     // interpolated values
     for(int i=0;i<k;i++) {
         inter[i] = (c0 * log_r[i]) + c1;
@@ -71,29 +76,35 @@ REAL CorrDim::evalCorrDim(int k, int discardl, int discardr,
 
 
 REAL CorrDim::corrSum(REAL R) {
-    int sum = 0;
-    int i, j, posi;
+    unsigned long int sum = 0;
+    unsigned long int posi;
+    int i, j;
     // in case m_dim > 1, we would need to compare squares
     if(m_dim > 1) {
         R = R * R;
     }
     for(i=0;i<m_numVec;i++) {
-        posi = ((i - 1) * i) >> 1;
+        posi = TRI(i);
         for(j=0;j<i;j++) {
             if(m_dist[posi+j] < R) {
                 sum += 2;
             }
         }
+        Progress::add(i);
     }
     return sum / m_div;
 }
 
 
 void CorrDim::evaluateDistMatrix() {
-    int i, j, k, d;
+    int i, j, k;
+    unsigned long int d;
     // don't use 'square' for 1-d vectors. They are costly!
     if(m_dim == 1) {
         for(i=0,d=0;i<m_numVec;i++) {
+            if(m_stream != NULL) {
+                m_stream->require(i + 1);
+            }
             for(j=0;j<i;j++,d++) {
                 m_dist[d] = (REAL) std::abs(m_data[i] - m_data[j]);
                 // min and max
@@ -106,13 +117,17 @@ void CorrDim::evaluateDistMatrix() {
                     }
                 }
             }
+            Progress::add(i);
         }
     } // m_dim == 1
     else {
         for(i=0,d=0;i<m_numVec;i++) {
-            REAL* x = m_data + (i * m_dim);
+            if(m_stream != NULL) {
+                m_stream->require(i + 1);
+            }
+            const REAL* x = m_data + (i * m_dim);
             for(j=0;j<i;j++,d++) {
-                REAL* y = m_data + (j * m_dim);
+                const REAL* y = m_data + (j * m_dim);
                 m_dist[d] = 0;
                 for(k=0;k<m_dim;k++) {
                     REAL temp = x[k] - y[k];
@@ -128,6 +143,7 @@ void CorrDim::evaluateDistMatrix() {
                     }
                 }
             }
+            Progress::add(i);
         }
         m_log_min_dist = (REAL) sqrt(m_log_min_dist);
         m_log_max_dist = (REAL) sqrt(m_log_max_dist);
@@ -136,24 +152,6 @@ void CorrDim::evaluateDistMatrix() {
     m_log_max_dist = (REAL) log(m_log_max_dist);
 }
 
-void CorrDim::linearLeastSquares(REAL& c0, REAL& c1, REAL* x,
-                                 REAL* y, int n) {
-    // Xc = Y   OR   X'Xc = X'Y
-    // c0 * xi + c1 = yi
-    REAL x_sum2 = 0;
-    REAL x_sum = 0;
-    REAL y_sum = 0;
-    REAL xy_sum = 0;
-    for(int i=0;i<n;i++) {
-        xy_sum += (x[i] * y[i]);
-        y_sum += y[i];
-        x_sum += x[i];
-        x_sum2 += (x[i] * x[i]);
-    }
-    c1 = ((x_sum * xy_sum) - (x_sum2 * y_sum)) / ((x_sum * x_sum) - (n * x_sum2));
-    c0 = (xy_sum - (x_sum * c1)) / x_sum2;
-}
-
 void CorrDim::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
     REAL min, max, step;
     min = (REAL) exp(m_log_min_dist);
@@ -164,7 +162,7 @@ void CorrDim::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
         hist[i] = 0;
     }
     if(m_dim == 1) {
-        for(int i=0;i<m_numDist;i++) {
+        for(unsigned long int i=0;i<m_numDist;i++) {
             int loc = (int) ((m_dist[i] - min) / step);
             if(loc >= numBins) {
                 loc = numBins - 1;
@@ -173,10 +171,14 @@ void CorrDim::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
         }
     }
     else {
-        for(int i=0;i<m_numDist;i++) {
+        for(unsigned long int i=0;i<m_numDist;i++) {
             REAL d = (REAL) sqrt(m_dist[i]);
             int loc = (int) ((d - min) / step);
+            if(loc >= numBins) {
+                loc = numBins - 1;
+            }
             hist[loc]++;
         }
     }
+    Progress::add(m_numDist);
 }
@@ -26,6 +26,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "basics.h"
+#include "VectorStream.h"
 #include <cmath>
 #include <limits>
 
@@ -51,16 +52,23 @@ public:
      * . This means that data should be of length (_numVec * _dim). It's a
      *   matrix of dimension _numVec x _dim, flattened out in row-major order.
      *
-     * . 'data' must have been 'allocated' using 'new' function!
+     * . 'data' is NOT copied. It must stay alive (and unchanged) for the
+     *   lifetime of this object. Freeing it is the caller's responsibility.
      *
-     * . This class will take the responsibility of memory pointed to by 'data'.
+     * . '_dist' lets the caller reuse one buffer across many objects. It must
+     *   hold at least TRI(_numVec) values and is NOT freed by this class.
+     *   NULL means the distance matrix is allocated (and freed) here.
+     *
+     * . '_stream', if given, means the vectors are still arriving into
+     *   '_data'. Row 'i' is then used as soon as it has arrived, ie, the
+     *   distances are computed while the rest of the data is being read.
      */
-    CorrDim(REAL* _data, int _numVec, int _dim=1);
+    CorrDim(const REAL* _data, int _numVec, int _dim=1, REAL* _dist=NULL, VectorStream* _stream=NULL);
 
     /**
      * @brief Destructor of this class.
      *
-     * This is responsible for cleaning of the allocated memory.
+     * This is responsible for cleaning of the memory allocated by this class.
      */
     ~CorrDim();
 
@@ -96,6 +104,9 @@ public:
      */
     void getDistMatrixHistogram(int numBins, int* hist, REAL* bins);
 
+    /** the microbenchmarks (see 'bench/') time the private kernels too */
+    friend class EngineBench;
+
 private:
     /**
      * @brief Evaluates the correlation sum for the given value of 'R'.
@@ -127,23 +138,15 @@ private:
      */
     void evaluateDistMatrix();
 
-    /**
-     * @brief Evaluates linear least square solution
-     * @param c0 slope of the line
-     * @param c1 displacement of the line
-     * @param x points along x-axis
-     * @param y points along y-axis
-     * @param n number of points
-     */
-    void linearLeastSquares(REAL& c0, REAL& c1, REAL* x, REAL* y, int n);
-
 private:
-    REAL* m_data;         ///< data points array
+    const REAL* m_data;   ///< data points array (not owned)
     int m_numVec;         ///< number of data points
     int m_dim;            ///< dimension of one such data point
     int m_num_ele;        ///< Total number of elements in the data
+    VectorStream* m_stream; ///< data still arriving (NULL if it's all there)
     REAL* m_dist;         ///< distance matrix for the data points
-    int m_numDist;        ///< num-elements in lower triangular distance-matrix
+    bool m_ownDist;       ///< whether 'm_dist' was allocated by this class
+    unsigned long int m_numDist;  ///< num-elements in lower triangular distance-matrix
     REAL m_div;           ///< factor used for evaluating the correlation sum
     REAL m_log_min_dist;  ///< minimum distance in the distance matrix (in log)
     REAL m_log_max_dist;  ///< maximum distance in the distance matrix (in log)
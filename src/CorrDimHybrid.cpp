@@ -0,0 +1,286 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "CorrDimHybrid.h"
+#include "Metrics.h"
+#include "MemTrack.h"
+#include "Progress.h"
+
+
+
+
+CorrDimHybrid::CorrDimHybrid(const REAL* _data, int _numVec, int _dim/*=1*/,
+                             unsigned long int _maxBytes/*=0*/,
+                             ThreadPool* _pool/*=NULL*/,
+                             VectorStream* _stream/*=NULL*/,
+                             REAL* _buf/*=NULL*/) {
+    m_data = _data;
+    m_stream = _stream;
+    m_numVec = _numVec;
+    m_dim = _dim;
+    m_num_ele = m_numVec * m_dim;
+    m_pool = _pool;
+    m_buf = _buf;
+    tileBytes(m_numVec, _maxBytes, &m_storedRows);
+    int workers = (m_pool == NULL)? 1 : m_pool->size();
+    for(int i=0;i<workers;i++) {
+        // the scratch rows come after the tiles in the caller's buffer
+        m_scratch.push_back((m_buf == NULL)? MemTrack::allocate<REAL>(m_numVec, MEM_DISTANCES) :
+                            m_buf + TRI(m_storedRows) + ((unsigned long int) i * m_numVec));
+    }
+    m_blocks = splitRows(m_numVec, (workers == 1)? 1 : workers * BLOCKS_PER_THREAD);
+    m_div = (REAL) m_numVec * (REAL) m_numVec;
+    m_log_min_dist = std::numeric_limits<REAL>::max();
+    m_log_max_dist = -1;
+    evaluateDistTiles();
+}
+
+
+CorrDimHybrid::~CorrDimHybrid() {
+    if(m_buf != NULL) {
+        return;
+    }
+    for(size_t t=0;t<m_tiles.size();t++) {
+        MemTrack::release(m_tiles[t]);
+    }
+    for(size_t i=0;i<m_scratch.size();i++) {
+        MemTrack::release(m_scratch[i]);
+    }
+}
+
+
+void CorrDimHybrid::forEachBlock(const ThreadPool::TaskFunc& func) {
+    int numBlocks = (int) m_blocks.size() - 1;
+    if(m_pool == NULL) {
+        for(int b=0;b<numBlocks;b++) {
+            func(b, 0);
+        }
+        return;
+    }
+    m_pool->parallelFor(numBlocks, func);
+}
+
+
+unsigned long int CorrDimHybrid::tileBytes(int numVec, unsigned long int maxBytes, int* rows/*=NULL*/) {
+    unsigned long int maxEle = maxBytes / sizeof(REAL);
+    int r = 0;
+    while((r < numVec) && (TRI(r+1) <= maxEle)) {
+        r++;
+    }
+    if(rows != NULL) {
+        *rows = r;
+    }
+    return TRI(r) * sizeof(REAL);
+}
+
+
+unsigned long int CorrDimHybrid::bufferSize(int numVec, unsigned long int maxBytes, int workers) {
+    return (tileBytes(numVec, maxBytes) / sizeof(REAL)) + ((unsigned long int) workers * numVec);
+}
+
+
+unsigned long int CorrDimHybrid::storedBytes() const {
+    return TRI(m_storedRows) * sizeof(REAL);
+}
+
+
+void CorrDimHybrid::computeRow(int i, REAL* out) const {
+    // don't use 'square' for 1-d vectors. They are costly!
+    if(m_dim == 1) {
+        REAL x = m_data[i];
+        for(int j=0;j<i;j++) {
+            out[j] = (REAL) std::abs(x - m_data[j]);
+        }
+        return;
+    }
+    const REAL* x = m_data + (i * m_dim);
+    for(int j=0;j<i;j++) {
+        const REAL* y = m_data + (j * m_dim);
+        REAL d = 0;
+        for(int k=0;k<m_dim;k++) {
+            REAL temp = x[k] - y[k];
+            d += (temp * temp);
+        }
+        out[j] = d;
+    }
+}
+
+
+const REAL* CorrDimHybrid::rowDistances(int i, REAL* scratch) const {
+    if(i >= m_storedRows) {
+        computeRow(i, scratch);
+        return scratch;
+    }
+    return m_rows[i];
+}
+
+
+void CorrDimHybrid::evaluateDistTiles() {
+    unsigned long int tileEle = TILE_BYTES / sizeof(REAL);
+    int i = 0;
+    // split the materialized rows into tiles of roughly 'TILE_BYTES' each
+    while(i < m_storedRows) {
+        int end = i + 1;
+        while((end < m_storedRows) && ((TRI(end+1) - TRI(i)) <= tileEle)) {
+            end++;
+        }
+        REAL* tile = (m_buf == NULL)? MemTrack::allocate<REAL>(TRI(end) - TRI(i), MEM_DISTANCES) :
+            m_buf + TRI(i);
+        unsigned long int first = TRI(i);
+        m_tiles.push_back(tile);
+        for(;i<end;i++) {
+            m_rows.push_back(tile + (TRI(i) - first));
+        }
+    }
+    // fill the tiles and find min and max across ALL the rows
+    int numBlocks = (int) m_blocks.size() - 1;
+    std::vector<REAL> mins(numBlocks, m_log_min_dist);
+    std::vector<REAL> maxs(numBlocks, m_log_max_dist);
+    forEachBlock([&](int b, int w) {
+        REAL lmin = mins[b];
+        REAL lmax = maxs[b];
+        for(int r=m_blocks[b];r<m_blocks[b+1];r++) {
+            if(m_stream != NULL) {
+                m_stream->require(r + 1);
+            }
+            // stored rows are filled in place, the others only go through the scratch
+            REAL* row = (r < m_storedRows)? m_rows[r] : m_scratch[w];
+            computeRow(r, row);
+            for(int j=0;j<r;j++) {
+                if(row[j] > 0) {
+                    if(row[j] > lmax) {
+                        lmax = row[j];
+                    }
+                    if(row[j] < lmin) {
+                        lmin = row[j];
+                    }
+                }
+            }
+            Progress::add(r);
+        }
+        mins[b] = lmin;
+        maxs[b] = lmax;
+    });
+    for(int b=0;b<numBlocks;b++) {
+        if(maxs[b] > m_log_max_dist) {
+            m_log_max_dist = maxs[b];
+        }
+        if(mins[b] < m_log_min_dist) {
+            m_log_min_dist = mins[b];
+        }
+    }
+    if(m_dim > 1) {
+        m_log_min_dist = (REAL) sqrt(m_log_min_dist);
+        m_log_max_dist = (REAL) sqrt(m_log_max_dist);
+    }
+    m_log_min_dist = (REAL) log(m_log_min_dist);
+    m_log_max_dist = (REAL) log(m_log_max_dist);
+}
+
+
+REAL CorrDimHybrid::evalCorrDim(int k, int discardl, int discardr, REAL* log_cr, REAL* log_r, REAL* inter) {
+    // 'R' for every point (squared for non-1d vectors)
+    REAL step = (m_log_max_dist - m_log_min_dist) / k;
+    REAL start = m_log_min_dist + step;
+    REAL* R = new REAL[k];
+    for(int i=0;i<k;i++,start+=step) {
+        log_r[i] = start;
+        R[i] = (REAL) exp(start);
+        if(m_dim > 1) {
+            R[i] *= R[i];
+        }
+    }
+    // count each pair only against the smallest 'R' it is below of
+    int numBlocks = (int) m_blocks.size() - 1;
+    std::vector<unsigned long int> count(numBlocks * k, 0);
+    forEachBlock([&](int b, int w) {
+        unsigned long int* cnt = &(count[b * k]);
+        for(int i=m_blocks[b];i<m_blocks[b+1];i++) {
+            const REAL* row = rowDistances(i, m_scratch[w]);
+            for(int j=0;j<i;j++) {
+                for(int r=0;r<k;r++) {
+                    if(row[j] < R[r]) {
+                        cnt[r]++;
+                        break;
+                    }
+                }
+            }
+            Progress::add(i);
+        }
+    });
+    delete [] R;
+    // cumulative counts are the correlation sums
+    unsigned long int sum = 0;
+    for(int i=0;i<k;i++) {
+        for(int b=0;b<numBlocks;b++) {
+            sum += count[b * k + i];
+        }
+        log_cr[i] = (REAL) log((2 * sum) / m_div);
+    }
+    // least squares
+    REAL c0, c1;
+    int n = k - (discardl + discardr);
+    Metrics::enter(PHASE_FIT);
+    linearLeastSquares(c0, c1, log_r+discardl, log_cr+discardl, n);
+    Metrics::leave();
+    // interpolated values
+    for(int i=0;i<k;i++) {
+        inter[i] = (c0 * log_r[i]) + c1;
+    }
+    return c0;
+}
+
+
+
+void CorrDimHybrid::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
+    REAL min, max, step;
+    min = (REAL) exp(m_log_min_dist);
+    max = (REAL) exp(m_log_max_dist);
+    step = (max - min) / numBins;
+    for(int i=0;i<numBins;i++) {
+        bins[i] = min + (i * step);
+        hist[i] = 0;
+    }
+    int numBlocks = (int) m_blocks.size() - 1;
+    std::vector<int> local(numBlocks * numBins, 0);
+    forEachBlock([&](int b, int w) {
+        int* lh = &(local[b * numBins]);
+        for(int i=m_blocks[b];i<m_blocks[b+1];i++) {
+            const REAL* row = rowDistances(i, m_scratch[w]);
+            for(int j=0;j<i;j++) {
+                REAL d = (m_dim == 1)? row[j] : (REAL) sqrt(row[j]);
+                int loc = (int) ((d - min) / step);
+                if(loc >= numBins) {
+                    loc = numBins - 1;
+                }
+                else if(loc < 0) {
+                    loc = 0;
+                }
+                lh[loc]++;
+            }
+            Progress::add(i);
+        }
+    });
+    for(int b=0;b<numBlocks;b++) {
+        for(int i=0;i<numBins;i++) {
+            hist[i] += local[b * numBins + i];
+        }
+    }
+}
@@ -0,0 +1,205 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_CORRDIMHYBRID_H__
+#define __INCLUDED_CORRDIMHYBRID_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include "ThreadPool.h"
+#include "VectorStream.h"
+#include <cmath>
+#include <limits>
+
+
+/** target size (in bytes) of one row-block tile of the distance matrix */
+#define TILE_BYTES   (4UL << 20)
+/** number of row-blocks handed out to every worker thread */
+#define BLOCKS_PER_THREAD   8
+
+
+/**
+ * Class responsible for evaluation of the correlation dimension under a
+ * memory budget. It sits in between 'CorrDim' and 'CorrDimLowMem': the
+ * lower triangular distance matrix is materialized in row-block tiles,
+ * starting from the first row, for as long as the tiles fit inside the
+ * given budget. Distances of the remaining rows are recomputed whenever
+ * they are needed. All the passes over the distance matrix work on blocks
+ * of rows, which are spread across the workers of a ThreadPool (if one is
+ * given). Go through the API documentation for more details.
+ *
+ * Usage:
+ *  CorrDimHybrid d = CorrDimHybrid(my_data, num_data, data_dim, budget);
+ *  printf("Correlation Dimension = %d\n", d.evalCorrDim(10));
+ *  printf("Correlation Dimension = %d\n", d.evalCorrDim(20));
+ */
+class CorrDimHybrid {
+public:
+    /**
+     * @brief Constructor of the correlation dimension evaluator.
+     * @param _data the data points for which corr-dim needs to be evaluated.
+     * @param _numVec number of data points.
+     * @param _dim dimension of one such data point. [Defaults to 1]
+     * @param _maxBytes number of bytes the distance tiles may occupy.
+     * @param _pool workers to spread the row-blocks on. [Defaults to NULL,
+     *  which means run on the calling thread alone]
+     *
+     * . This means that data should be of length (_numVec * _dim). It's a
+     *   matrix of dimension _numVec x _dim, flattened out in row-major order.
+     *
+     * . 'data' is NOT copied. It must stay alive (and unchanged) for the
+     *   lifetime of this object. Freeing it is the caller's responsibility.
+     *
+     * . If '_maxBytes' covers the whole distance matrix, this behaves just
+     *   like 'CorrDim'. If it is 0, this behaves just like 'CorrDimLowMem'.
+     *
+     * . '_stream', if given, means the vectors are still arriving into
+     *   '_data'. Row 'i' is then used as soon as it has arrived, ie, the
+     *   distances are computed while the rest of the data is being read.
+     *
+     * . '_buf' lets the caller reuse one buffer for the tiles and the
+     *   scratch rows across many objects. It must hold at least
+     *   'bufferSize' values and is NOT freed by this class. NULL means they
+     *   are allocated (and freed) here.
+     */
+    CorrDimHybrid(const REAL* _data, int _numVec, int _dim=1, unsigned long int _maxBytes=0,
+                  ThreadPool* _pool=NULL, VectorStream* _stream=NULL, REAL* _buf=NULL);
+
+    /**
+     * @brief Destructor of this class.
+     *
+     * This is responsible for cleaning of the memory allocated by this class.
+     */
+    ~CorrDimHybrid();
+
+    /**
+     * @brief Evaluate the correlation dimension.
+     * @param k number of points in the log(R) axis for evaluating corr-dim.
+     * @param discardl number of points on left side to be discarded for best-fit.
+     * @param discardr number of points on right side to be discarded for best-fit.
+     * @param log_cr array which will contain the log(cr) values.
+     * @param log_r  array which will contain the log(r) values.
+     * @param inter array which will contain the best-fit log(cr) values.
+     * @return the correlation dimension of the data points.
+     *
+     * It is the responsibility of the calling function to allocate and free
+     * the memory occupied by 'log_cr', 'log_r' and 'inter'!
+     */
+    REAL evalCorrDim(int k, int discardl, int discardr, REAL* log_cr, REAL* log_r, REAL* inter);
+
+    /**
+     * @brief Generate the histogram of the distance matrix
+     * @param numBins number of bins in the histogram.
+     * @param hist histogram bins
+     * @param bins value of each bin
+     *
+     * It is the responsibility of the calling function to allocate and free
+     * the memory occupied by 'hist' and 'bins'!
+     */
+    void getDistMatrixHistogram(int numBins, int* hist, REAL* bins);
+
+    /**
+     * @brief Number of rows of the distance matrix which are materialized
+     * @return number of rows (starting from row 0) held in the tiles
+     */
+    int storedRows() const { return m_storedRows; }
+
+    /**
+     * @brief Number of bytes occupied by the distance tiles
+     * @return bytes
+     */
+    unsigned long int storedBytes() const;
+
+    /**
+     * @brief Number of bytes the tiles would occupy under the given budget
+     * @param numVec number of data points.
+     * @param maxBytes number of bytes the distance tiles may occupy.
+     * @param rows if not NULL, will contain the number of materialized rows.
+     * @return bytes
+     *
+     * This does not allocate anything. It is used for the memory estimates.
+     */
+    static unsigned long int tileBytes(int numVec, unsigned long int maxBytes, int* rows=NULL);
+
+    /**
+     * @brief Number of values a caller-given buffer must hold
+     * @param numVec number of data points.
+     * @param maxBytes number of bytes the distance tiles may occupy.
+     * @param workers number of workers of the pool (1 if none).
+     * @return the tiles plus one scratch row per worker
+     */
+    static unsigned long int bufferSize(int numVec, unsigned long int maxBytes, int workers);
+
+private:
+    /**
+     * @brief Evaluates the distances of one row of the distance matrix
+     * @param i the row of interest.
+     * @param scratch buffer of atleast 'i' elements for recomputed rows.
+     * @return pointer to the 'i' distances of this row.
+     *
+     * For materialized rows, the returned pointer points inside the tiles
+     * and 'scratch' is left untouched. For the others, the distances are
+     * recomputed into 'scratch'. Distances are squared for non-1d vectors,
+     * as explained in 'CorrDim::evaluateDistMatrix'.
+     */
+    const REAL* rowDistances(int i, REAL* scratch) const;
+
+    /**
+     * @brief Computes the distances of one row of the distance matrix
+     * @param i the row of interest.
+     * @param out the output array of 'i' elements.
+     */
+    void computeRow(int i, REAL* out) const;
+
+    /**
+     * @brief Allocates the tiles, fills them and evaluates min and max
+     */
+    void evaluateDistTiles();
+
+    /**
+     * @brief Runs 'func' for every row-block, on the pool if there's one
+     * @param func function taking the block index and the worker index.
+     */
+    void forEachBlock(const ThreadPool::TaskFunc& func);
+
+private:
+    const REAL* m_data;   ///< data points array (not owned)
+    int m_numVec;         ///< number of data points
+    int m_dim;            ///< dimension of one such data point
+    int m_num_ele;        ///< Total number of elements in the data
+    int m_storedRows;     ///< number of rows held in the tiles
+    std::vector<REAL*> m_tiles;    ///< row-block tiles of the distance matrix
+    std::vector<REAL*> m_rows;     ///< start of each materialized row inside the tiles
+    std::vector<REAL*> m_scratch;  ///< distances of a recomputed row (per worker)
+    REAL* m_buf;          ///< caller's buffer for the tiles and scratch (NULL if none)
+    std::vector<int> m_blocks;     ///< row-block boundaries (see 'splitRows')
+    ThreadPool* m_pool;   ///< workers (NULL means the calling thread alone)
+    VectorStream* m_stream; ///< data still arriving (NULL if it's all there)
+    REAL m_div;           ///< factor used for evaluating the correlation sum
+    REAL m_log_min_dist;  ///< minimum distance in the distance matrix (in log)
+    REAL m_log_max_dist;  ///< maximum distance in the distance matrix (in log)
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_CORRDIMHYBRID_H__
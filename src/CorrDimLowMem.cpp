@@ -19,34 +19,62 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "CorrDimLowMem.h"
+#include "Metrics.h"
+#include "Progress.h"
+#include <algorithm>
+#include <random>
 
 
 
 
-CorrDimLowMem::CorrDimLowMem(REAL* _data, int _numVec, int _dim/*=1*/) {
+CorrDimLowMem::CorrDimLowMem(const REAL* _data, int _numVec, int _dim/*=1*/,
+                             VectorStream* _stream/*=NULL*/, Checkpoint* _ckpt/*=NULL*/,
+                             bool _minMax/*=true*/) {
     m_data = _data;
+    m_stream = _stream;
+    m_ckpt = _ckpt;
     m_numVec = _numVec;
     m_dim = _dim;
     m_num_ele = m_numVec * m_dim;
-    m_div = (REAL) (m_numVec * m_numVec);
+    m_div = (REAL) m_numVec * (REAL) m_numVec;
     m_log_min_dist = std::numeric_limits<REAL>::max();
     m_log_max_dist = -1;
-    evaluateMinMaxDistMatrix();
+    m_minMaxDone = false;
+    if(_minMax) {
+        evaluateMinMaxDistMatrix();
+    }
 }
 
 
 CorrDimLowMem::~CorrDimLowMem() {
-    if(m_data != NULL) {
-        delete m_data;
-    }
 }
 
 
 void CorrDimLowMem::evaluateMinMaxDistMatrix() {
     int i, j, k;
+    int first = 0;
+    m_minMaxDone = true;
+    if(m_ckpt != NULL) {
+        // later passes hold the final (log) values
+        if(m_ckpt->phase() > CKPT_MINMAX) {
+            m_log_min_dist = m_ckpt->minDist();
+            m_log_max_dist = m_ckpt->maxDist();
+            return;
+        }
+        first = m_ckpt->row();
+        if(first > 0) {
+            m_log_min_dist = m_ckpt->minDist();
+            m_log_max_dist = m_ckpt->maxDist();
+        }
+    }
+    // rows done before the checkpoint
+    Progress::add(TRI(first));
     // don't use 'square' for 1-d vectors. They are costly!
     if(m_dim == 1) {
-        for(i=0;i<m_numVec;i++) {
+        for(i=first;i<m_numVec;i++) {
+            if(m_stream != NULL) {
+                m_stream->require(i + 1);
+            }
             for(j=0;j<i;j++) {
                 REAL d = (REAL) std::abs(m_data[i] - m_data[j]);
                 // min and max
@@ -59,13 +87,20 @@ void CorrDimLowMem::evaluateMinMaxDistMatrix() {
                     }
                 }
             }
+            Progress::add(i);
+            if((m_ckpt != NULL) && m_ckpt->due()) {
+                m_ckpt->save(CKPT_MINMAX, i + 1, m_log_min_dist, m_log_max_dist, (REAL*) NULL, 0);
+            }
         }
     } // m_dim == 1
     else {
-        for(i=0;i<m_numVec;i++) {
-            REAL* x = m_data + (i * m_dim);
+        for(i=first;i<m_numVec;i++) {
+            if(m_stream != NULL) {
+                m_stream->require(i + 1);
+            }
+            const REAL* x = m_data + (i * m_dim);
             for(j=0;j<i;j++) {
-                REAL* y = m_data + (j * m_dim);
+                const REAL* y = m_data + (j * m_dim);
                 REAL d = 0;
                 for(k=0;k<m_dim;k++) {
                     REAL temp = x[k] - y[k];
@@ -81,6 +116,10 @@ void CorrDimLowMem::evaluateMinMaxDistMatrix() {
                     }
                 }
             }
+            Progress::add(i);
+            if((m_ckpt != NULL) && m_ckpt->due()) {
+                m_ckpt->save(CKPT_MINMAX, i + 1, m_log_min_dist, m_log_max_dist, (REAL*) NULL, 0);
+            }
         }
         m_log_min_dist = (REAL) sqrt(m_log_min_dist);
         m_log_max_dist = (REAL) sqrt(m_log_max_dist);
@@ -91,6 +130,9 @@ void CorrDimLowMem::evaluateMinMaxDistMatrix() {
 
 
 REAL CorrDimLowMem::evalCorrDim(int k, int discardl, int discardr, REAL* log_cr, REAL* log_r, REAL* inter) {
+    if(!m_minMaxDone) {
+        evaluateMinMaxDistMatrix();
+    }
     // evaluate corr-sum for every value of 'R'
     REAL step = (m_log_max_dist - m_log_min_dist) / k;
     REAL start = m_log_min_dist + step;
@@ -102,7 +144,9 @@ REAL CorrDimLowMem::evalCorrDim(int k, int discardl, int discardr, REAL* log_cr,
     // least squares
     REAL c0, c1;
     int n = k - (discardl + discardr);
+    Metrics::enter(PHASE_FIT);
     linearLeastSquares(c0, c1, log_r+discardl, log_cr+discardl, n);
+    Metrics::leave();
     // interpolated values
     for(int i=0;i<k;i++) {
         inter[i] = (c0 * log_r[i]) + c1;
@@ -113,9 +157,18 @@ REAL CorrDimLowMem::evalCorrDim(int k, int discardl, int discardr, REAL* log_cr,
 
 void CorrDimLowMem::batchCorrSum(REAL* log_cr, REAL* log_r, int num) {
     int i, j, k;
+    int first = 0;
+    if((m_ckpt != NULL) && (m_ckpt->phase() >= CKPT_CORRSUM)) {
+        first = (m_ckpt->phase() == CKPT_CORRSUM)? m_ckpt->row() : m_numVec;
+        for(k=0;k<num;k++) {
+            log_cr[k] = m_ckpt->sums()[k];
+        }
+    }
+    // rows done before the checkpoint
+    Progress::add(TRI(first));
     // don't use 'square' for 1-d vectors. They are costly!
     if(m_dim == 1) {
-        for(i=0;i<m_numVec;i++) {
+        for(i=first;i<m_numVec;i++) {
             for(j=0;j<i;j++) {
                 REAL d = (REAL) std::abs(m_data[i] - m_data[j]);
                 for(k=0;k<num;k++) {
@@ -127,16 +180,20 @@ void CorrDimLowMem::batchCorrSum(REAL* log_cr, REAL* log_r, int num) {
                     }
                 }
             }
+            Progress::add(i);
+            if((m_ckpt != NULL) && m_ckpt->due()) {
+                m_ckpt->save(CKPT_CORRSUM, i + 1, m_log_min_dist, m_log_max_dist, log_cr, num);
+            }
         }
     } // m_dim == 1
     else {
         for(k=0;k<num;k++) {
             log_r[k] *= log_r[k];
         }
-        for(i=0;i<m_numVec;i++) {
-            REAL* x = m_data + (i * m_dim);
+        for(i=first;i<m_numVec;i++) {
+            const REAL* x = m_data + (i * m_dim);
             for(j=0;j<i;j++) {
-                REAL* y = m_data + (j * m_dim);
+                const REAL* y = m_data + (j * m_dim);
                 REAL d = 0;
                 for(k=0;k<m_dim;k++) {
                     REAL temp = x[k] - y[k];
@@ -151,11 +208,19 @@ void CorrDimLowMem::batchCorrSum(REAL* log_cr, REAL* log_r, int num) {
                     }
                 }
             }
+            Progress::add(i);
+            if((m_ckpt != NULL) && m_ckpt->due()) {
+                m_ckpt->save(CKPT_CORRSUM, i + 1, m_log_min_dist, m_log_max_dist, log_cr, num);
+            }
         }
         for(k=0;k<num;k++) {
             log_r[k] = (REAL) sqrt(log_r[k]);
         }
     } // m_dim == 1
+    // the sums must outlive the checkpoints of the histogram pass
+    if((m_ckpt != NULL) && (first < m_numVec)) {
+        m_ckpt->save(CKPT_CORRSUM, m_numVec, m_log_min_dist, m_log_max_dist, log_cr, num);
+    }
     for(k=0;k<num;k++) {
         log_cr[k] = (REAL) log(log_cr[k] / m_div);
         log_r[k] = (REAL) log(log_r[k]);
@@ -164,24 +229,217 @@ void CorrDimLowMem::batchCorrSum(REAL* log_cr, REAL* log_r, int num) {
 }
 
 
-void CorrDimLowMem::linearLeastSquares(REAL& c0, REAL& c1, REAL* x, REAL* y, int n) {
-    // Xc = Y   OR   X'Xc = X'Y
-    // c0 * xi + c1 = yi
-    REAL x_sum2 = 0;
-    REAL x_sum = 0;
-    REAL y_sum = 0;
-    REAL xy_sum = 0;
-    for(int i=0;i<n;i++) {
-        xy_sum += (x[i] * y[i]);
-        y_sum += y[i];
-        x_sum += x[i];
-        x_sum2 += (x[i] * x[i]);
-    }
-    c1 = ((x_sum * xy_sum) - (x_sum2 * y_sum)) / ((x_sum * x_sum) - (n * x_sum2));
-    c0 = (xy_sum - (x_sum * c1)) / x_sum2;
+REAL CorrDimLowMem::evalCorrDimProgressive(int k, int discardl, int discardr, REAL* log_cr,
+                                           REAL* log_r, REAL* inter, REAL tol, REAL deadline,
+                                           REAL& fraction, bool& converged) {
+    REAL begin = wallTime();
+    if(m_stream != NULL) {
+        m_stream->require(m_numVec);
+    }
+    // tiles of the lower triangle (diagonal ones included), shuffled
+    int side = (m_numVec + PROG_SIDE - 1) / PROG_SIDE;
+    int numSide = (m_numVec + side - 1) / side;
+    std::vector<int> rows, cols;
+    for(int r=0;r<numSide;r++) {
+        for(int c=0;c<=r;c++) {
+            rows.push_back(r * side);
+            cols.push_back(c * side);
+        }
+    }
+    int numTiles = (int) rows.size();
+    std::vector<int> order(numTiles);
+    for(int t=0;t<numTiles;t++) {
+        order[t] = t;
+    }
+    std::mt19937 rng(PROG_SEED);
+    std::shuffle(order.begin(), order.end(), rng);
+    REAL min_dist = m_log_min_dist;
+    REAL max_dist = m_log_max_dist;
+    if(!m_minMaxDone) {
+        if(m_dim == 1) {
+            sortedMinMax(min_dist, max_dist);
+        }
+        else {
+            for(int t=0;(t<PROG_PILOT)&&(t<numTiles);t++) {
+                int o = order[t];
+                tileMinMax(rows[o], std::min(rows[o] + side, m_numVec), cols[o],
+                           std::min(cols[o] + side, m_numVec), min_dist, max_dist);
+            }
+            min_dist = (REAL) sqrt(min_dist);
+            max_dist = (REAL) sqrt(max_dist);
+        }
+        min_dist = (REAL) log(min_dist);
+        max_dist = (REAL) log(max_dist);
+    }
+    // 'R' (squared, in case m_dim > 1) for every point
+    std::vector<REAL> R(k), counts(k, 0);
+    REAL step = (max_dist - min_dist) / k;
+    REAL start = min_dist + step;
+    for(int i=0;i<k;i++,start+=step) {
+        log_r[i] = start;
+        R[i] = (REAL) exp(start);
+        if(m_dim > 1) {
+            R[i] *= R[i];
+        }
+    }
+    unsigned long int pairs = 0;
+    unsigned long int total = TRI(m_numVec);
+    std::vector<REAL> slopes;
+    REAL c0 = 0, c1 = 0;
+    int n = k - (discardl + discardr);
+    converged = false;
+    for(int t=0;t<numTiles;t++) {
+        // there's no estimate before the first fit, so the deadline waits for it
+        if((deadline > 0) && !slopes.empty() && ((wallTime() - begin) >= deadline)) {
+            break;
+        }
+        int o = order[t];
+        unsigned long int tile = tileCorrSum(rows[o], std::min(rows[o] + side, m_numVec), cols[o],
+                                             std::min(cols[o] + side, m_numVec), &(R[0]),
+                                             &(counts[0]), k);
+        pairs += tile;
+        Progress::add(tile);
+        // refit, once every point used in the fit has got some pairs
+        if((pairs == 0) || (counts[discardl] == 0)) {
+            continue;
+        }
+        REAL scale = (REAL) total / (REAL) pairs;
+        for(int i=0;i<k;i++) {
+            log_cr[i] = (REAL) log((counts[i] * scale) / m_div);
+        }
+        Metrics::enter(PHASE_FIT);
+        linearLeastSquares(c0, c1, log_r+discardl, log_cr+discardl, n);
+        Metrics::leave();
+        slopes.push_back(c0);
+        if((tol > 0) && ((int) slopes.size() > PROG_WINDOW)) {
+            REAL change = 0;
+            for(size_t s=slopes.size()-PROG_WINDOW;s<slopes.size();s++) {
+                change = std::max(change, (REAL) std::abs(slopes[s] - slopes[s-1]));
+            }
+            if(change < tol) {
+                converged = true;
+                break;
+            }
+        }
+    }
+    fraction = (REAL) pairs / (REAL) total;
+    if(slopes.empty()) {
+        // all the pairs are in, but 'discardl' still got none: fit as 'evalCorrDim' does
+        for(int i=0;i<k;i++) {
+            log_cr[i] = (REAL) log(counts[i] / m_div);
+        }
+        Metrics::enter(PHASE_FIT);
+        linearLeastSquares(c0, c1, log_r+discardl, log_cr+discardl, n);
+        Metrics::leave();
+    }
+    // points left of the fit without a pair yet hold less than one (scaled up) pair
+    REAL scale = (REAL) total / (REAL) pairs;
+    for(int i=0;i<discardl;i++) {
+        if(counts[i] == 0) {
+            log_cr[i] = (REAL) log(scale / m_div);
+        }
+    }
+    // interpolated values
+    for(int i=0;i<k;i++) {
+        inter[i] = (c0 * log_r[i]) + c1;
+    }
+    return c0;
+}
+
+
+void CorrDimLowMem::sortedMinMax(REAL& min_dist, REAL& max_dist) {
+    // the closest pair of 1-d values are neighbours once sorted
+    std::vector<REAL> vals(m_data, m_data + m_numVec);
+    std::sort(vals.begin(), vals.end());
+    min_dist = std::numeric_limits<REAL>::max();
+    max_dist = vals[m_numVec-1] - vals[0];
+    for(int i=1;i<m_numVec;i++) {
+        REAL d = vals[i] - vals[i-1];
+        if((d > 0) && (d < min_dist)) {
+            min_dist = d;
+        }
+    }
 }
 
+
+void CorrDimLowMem::tileMinMax(int rBegin, int rEnd, int cBegin, int cEnd,
+                               REAL& min_dist, REAL& max_dist) {
+    int i, j, k;
+    for(i=rBegin;i<rEnd;i++) {
+        const REAL* x = m_data + (i * m_dim);
+        for(j=cBegin;(j<cEnd)&&(j<i);j++) {
+            const REAL* y = m_data + (j * m_dim);
+            REAL d = 0;
+            for(k=0;k<m_dim;k++) {
+                REAL temp = x[k] - y[k];
+                d += (temp * temp);
+            }
+            if(d > 0) {
+                if(d > max_dist) {
+                    max_dist = d;
+                }
+                if(d < min_dist) {
+                    min_dist = d;
+                }
+            }
+        }
+    }
+}
+
+
+unsigned long int CorrDimLowMem::tileCorrSum(int rBegin, int rEnd, int cBegin, int cEnd,
+                                             const REAL* R, REAL* counts, int num) {
+    int i, j, k;
+    unsigned long int pairs = 0;
+    // don't use 'square' for 1-d vectors. They are costly!
+    if(m_dim == 1) {
+        for(i=rBegin;i<rEnd;i++) {
+            int jEnd = (i < cEnd)? i : cEnd;
+            for(j=cBegin;j<jEnd;j++) {
+                REAL d = (REAL) std::abs(m_data[i] - m_data[j]);
+                for(k=0;k<num;k++) {
+                    if(d < R[k]) {
+                        for(;k<num;k++) {
+                            counts[k]++;
+                        }
+                        break;
+                    }
+                }
+            }
+            pairs += (jEnd > cBegin)? jEnd - cBegin : 0;
+        }
+    } // m_dim == 1
+    else {
+        for(i=rBegin;i<rEnd;i++) {
+            const REAL* x = m_data + (i * m_dim);
+            int jEnd = (i < cEnd)? i : cEnd;
+            for(j=cBegin;j<jEnd;j++) {
+                const REAL* y = m_data + (j * m_dim);
+                REAL d = 0;
+                for(k=0;k<m_dim;k++) {
+                    REAL temp = x[k] - y[k];
+                    d += (temp * temp);
+                }
+                for(k=0;k<num;k++) {
+                    if(d < R[k]) {
+                        for(;k<num;k++) {
+                            counts[k]++;
+                        }
+                        break;
+                    }
+                }
+            }
+            pairs += (jEnd > cBegin)? jEnd - cBegin : 0;
+        }
+    } // m_dim == 1
+    return pairs;
+}
+
+
 void CorrDimLowMem::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
+    if(!m_minMaxDone) {
+        evaluateMinMaxDistMatrix();
+    }
     REAL min, max, step;
     min = (REAL) exp(m_log_min_dist);
     max = (REAL) exp(m_log_max_dist);
@@ -191,9 +449,18 @@ void CorrDimLowMem::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
         hist[i] = 0;
     }
     int i, j, k;
+    int first = 0;
+    if((m_ckpt != NULL) && (m_ckpt->phase() == CKPT_HIST)) {
+        first = m_ckpt->row();
+        for(i=0;i<numBins;i++) {
+            hist[i] = (int) m_ckpt->hist()[i];
+        }
+    }
+    // rows done before the checkpoint
+    Progress::add(TRI(first));
     // don't use 'square' for 1-d vectors. They are costly!
     if(m_dim == 1) {
-        for(i=0;i<m_numVec;i++) {
+        for(i=first;i<m_numVec;i++) {
             for(j=0;j<i;j++) {
                 REAL d = (REAL) std::abs(m_data[i] - m_data[j]);
                 int loc = (int) ((d - min) / step);
@@ -202,13 +469,17 @@ void CorrDimLowMem::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
                 }
                 hist[loc]++;
             }
+            Progress::add(i);
+            if((m_ckpt != NULL) && m_ckpt->due()) {
+                m_ckpt->save(CKPT_HIST, i + 1, m_log_min_dist, m_log_max_dist, hist, numBins);
+            }
         }
     } // m_dim == 1
     else {
-        for(i=0;i<m_numVec;i++) {
-            REAL* x = m_data + (i * m_dim);
+        for(i=first;i<m_numVec;i++) {
+            const REAL* x = m_data + (i * m_dim);
             for(j=0;j<i;j++) {
-                REAL* y = m_data + (j * m_dim);
+                const REAL* y = m_data + (j * m_dim);
                 REAL d = 0;
                 for(k=0;k<m_dim;k++) {
                     REAL temp = x[k] - y[k];
@@ -216,8 +487,15 @@ void CorrDimLowMem::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
                 }
                 d = (REAL) sqrt(d);
                 int loc = (int) ((d - min) / step);
+                if(loc >= numBins) {
+                    loc = numBins - 1;
+                }
                 hist[loc]++;
             }
+            Progress::add(i);
+            if((m_ckpt != NULL) && m_ckpt->due()) {
+                m_ckpt->save(CKPT_HIST, i + 1, m_log_min_dist, m_log_max_dist, hist, numBins);
+            }
         }
     } // m_dim == 1
 }
@@ -26,10 +26,22 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "basics.h"
+#include "VectorStream.h"
+#include "Checkpoint.h"
 #include <cmath>
 #include <limits>
 
 
+/** tiles per side of the distance matrix, for 'evalCorrDimProgressive' */
+#define PROG_SIDE    64
+/** tiles (in the shuffled order) used to guess the range of distances */
+#define PROG_PILOT   8
+/** refits over which the slope must stay within the tolerance */
+#define PROG_WINDOW  5
+/** seed of the shuffled tile order, so that runs are repeatable */
+#define PROG_SEED    12345
+
+
 /**
  * Class responsible for evaluation of the correlation dimension without
  * storing the distance matrix. That way, this class is the low memory
@@ -51,16 +63,28 @@ public:
      * . This means that data should be of length (_numVec * _dim). It's a
      *   matrix of dimension _numVec x _dim, flattened out in row-major order.
      *
-     * . 'data' must have been 'allocated' using 'new' function!
+     * . 'data' is NOT copied. It must stay alive (and unchanged) for the
+     *   lifetime of this object. Freeing it is the caller's responsibility.
+     *
+     * . '_stream', if given, means the vectors are still arriving into
+     *   '_data'. Row 'i' is then used as soon as it has arrived, ie, the
+     *   distances are computed while the rest of the data is being read.
      *
-     * . This class will take the responsibility of memory pointed to by 'data'.
+     * . '_ckpt', if given, is polled after every row of every pass over the
+     *   distance matrix (this one, 'evalCorrDim' and 'getDistMatrixHistogram')
+     *   and, if it was loaded from a file, these passes resume from where it
+     *   was taken. It must have been attached to the same data.
+     *
+     * . '_minMax' false postpones the pass evaluating the min/max distance
+     *   to the first call needing it. 'evalCorrDimProgressive' doesn't.
      */
-    CorrDimLowMem(REAL* _data, int _numVec, int _dim=1);
+    CorrDimLowMem(const REAL* _data, int _numVec, int _dim=1, VectorStream* _stream=NULL,
+                  Checkpoint* _ckpt=NULL, bool _minMax=true);
 
     /**
      * @brief Destructor of this class.
      *
-     * This is responsible for cleaning of the allocated memory.
+     * This is responsible for cleaning of the memory allocated by this class.
      */
     ~CorrDimLowMem();
 
@@ -85,6 +109,34 @@ public:
      */
     REAL evalCorrDim(int k, int discardl, int discardr, REAL* log_cr, REAL* log_r, REAL* inter);
 
+    /**
+     * @brief Evaluate the correlation dimension from as few pairs as needed
+     * @param k number of points in the log(R) axis for evaluating corr-dim.
+     * @param discardl number of points on left side to be discarded for best-fit.
+     * @param discardr number of points on right side to be discarded for best-fit.
+     * @param log_cr array which will contain the log(cr) values.
+     * @param log_r  array which will contain the log(r) values.
+     * @param inter array which will contain the best-fit log(cr) values.
+     * @param tol stop once the slope has changed by less than this over the
+     *  last PROG_WINDOW refits. 0 means never.
+     * @param deadline stop after these many seconds, but not before the
+     *  first fit. 0 means never.
+     * @param fraction fraction of the pairs processed (output).
+     * @param converged whether it stopped because of 'tol' (output).
+     * @return the (estimated) correlation dimension of the data points.
+     *
+     * The lower triangle of the distance matrix is cut into tiles, which are
+     * processed in a random (but fixed) order. The slope is refitted after
+     * every tile, from the counts scaled up to all the pairs. Unless the
+     * min/max distance is already known, it's found by sorting for 1-d
+     * vectors. Else, the range of 'R' is guessed from the first PROG_PILOT
+     * tiles, which makes the estimate converge to a slightly different
+     * value than that of 'evalCorrDim'.
+     */
+    REAL evalCorrDimProgressive(int k, int discardl, int discardr, REAL* log_cr, REAL* log_r,
+                                REAL* inter, REAL tol, REAL deadline, REAL& fraction,
+                                bool& converged);
+
     /**
      * @brief Generate the histogram of the distance matrix
      * @param numBins number of bins in the histogram.
@@ -96,6 +148,9 @@ public:
      */
     void getDistMatrixHistogram(int numBins, int* hist, REAL* bins);
 
+    /** the microbenchmarks (see 'bench/') time the private kernels too */
+    friend class EngineBench;
+
 private:
     /**
      * @brief Evaluates the correlation sum for all the values of 'log_r'.
@@ -115,20 +170,45 @@ private:
     void evaluateMinMaxDistMatrix();
 
     /**
-     * @brief Evaluates linear least square solution
-     * @param c0 slope of the line
-     * @param c1 displacement of the line
-     * @param x points along x-axis
-     * @param y points along y-axis
-     * @param n number of points
+     * @brief Min and max distance of 1-d vectors, by sorting them
+     * @param min_dist the min distance (output).
+     * @param max_dist the max distance (output).
+     */
+    void sortedMinMax(REAL& min_dist, REAL& max_dist);
+
+    /**
+     * @brief Updates the min and max (squared) distance with one tile
+     * @param rBegin first row of the tile.
+     * @param rEnd one past the last row.
+     * @param cBegin first column of the tile.
+     * @param cEnd one past the last column.
+     * @param min_dist the min distance (updated).
+     * @param max_dist the max distance (updated).
+     */
+    void tileMinMax(int rBegin, int rEnd, int cBegin, int cEnd, REAL& min_dist, REAL& max_dist);
+
+    /**
+     * @brief Adds the correlation sums of one tile
+     * @param rBegin first row of the tile.
+     * @param rEnd one past the last row.
+     * @param cBegin first column of the tile.
+     * @param cEnd one past the last column.
+     * @param R the values of 'R' (squared, in case of multi-dimensional vectors).
+     * @param counts pairs below every 'R' (updated).
+     * @param num number of values of 'R'.
+     * @return number of pairs in the tile
      */
-    void linearLeastSquares(REAL& c0, REAL& c1, REAL* x, REAL* y, int n);
+    unsigned long int tileCorrSum(int rBegin, int rEnd, int cBegin, int cEnd, const REAL* R,
+                                  REAL* counts, int num);
 
 private:
-    REAL* m_data;         ///< data points array
+    const REAL* m_data;   ///< data points array (not owned)
     int m_numVec;         ///< number of data points
     int m_dim;            ///< dimension of one such data point
     int m_num_ele;        ///< Total number of elements in the data
+    VectorStream* m_stream; ///< data still arriving (NULL if it's all there)
+    Checkpoint* m_ckpt;   ///< checkpoints of the passes (NULL for none)
+    bool m_minMaxDone;    ///< whether the min/max distance has been evaluated
     REAL m_div;           ///< factor used for evaluating the correlation sum
     REAL m_log_min_dist;  ///< minimum distance in the distance matrix (in log)
     REAL m_log_max_dist;  ///< maximum distance in the distance matrix (in log)
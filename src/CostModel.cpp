@@ -0,0 +1,287 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "CostModel.h"
+#include "CorrDim.h"
+#include "CorrDimLowMem.h"
+#include "CorrDimHybrid.h"
+#include "SysInfo.h"
+#include "Timer.h"
+
+
+using namespace std;
+
+
+/** version of the cache file format. Bump this when the engines change! */
+#define CALIB_VERSION   2
+
+#ifdef __OPTIMIZE__
+/** whether the engines were compiled with optimizations */
+#define CALIB_OPTIMIZE  "optimized"
+#else
+#define CALIB_OPTIMIZE  "unoptimized"
+#endif
+
+/** indices of the calibrated configurations in 'CostModel::m_cost' */
+enum { COST_FULL = 0, COST_LOWMEM, COST_STORED, COST_RECOMPUTED };
+
+
+static const char* s_engineNames[ENGINE_COUNT] = { "auto", "full", "lowmem", "hybrid" };
+
+const char* engineName(EngineType e) {
+    return s_engineNames[e];
+}
+
+bool parseEngine(const string& name, EngineType& e) {
+    for(int i=0;i<ENGINE_COUNT;i++) {
+        if(name == s_engineNames[i]) {
+            e = (EngineType) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+unsigned long int baseMemory(int numEle, int dim, int numPts, int numBins) {
+    return (((unsigned long int) numEle * dim * sizeof(REAL)) +  // signal
+            (numBins * sizeof(int)) +                           // histogram-bins
+            (numBins * sizeof(REAL)) +                          // histogram-bin-values
+            (3 * numPts * sizeof(REAL)));                       // log_r, log_cr, inter arrays
+}
+
+unsigned long int distMatrixMemory(int numEle) {
+    return TRI(numEle) * sizeof(REAL);
+}
+
+unsigned long int hybridOverhead(int numEle, int threads) {
+    return ((threads * numEle * sizeof(REAL)) +                 // recomputed rows
+            (numEle * sizeof(REAL*)));                          // row pointers into the tiles
+}
+
+
+/**
+ * @brief Generates deterministic synthetic data for the calibration
+ * @param numEle number of vectors.
+ * @param dim dimension of the vectors.
+ * @return delay-embedded trajectory of the LogisticMap
+ */
+static REAL* calibData(int numEle, int dim) {
+    REAL* arr = new REAL[numEle * dim];
+    REAL x = 0.44;
+    for(int i=0;i<numEle*dim;i++) {
+        x = 3.97 * x * (1 - x);
+        arr[i] = x;
+    }
+    return arr;
+}
+
+/**
+ * @brief Runs one engine on the synthetic data
+ * @param c the configuration (see 'COST_FULL' and others).
+ * @param dim dimension of the vectors.
+ * @param k number of points on the log(CR) vs log(R) plot.
+ * @return time per pair (in s)
+ */
+static REAL calibRun(int c, int dim, int k) {
+    REAL* log_cr = new REAL[k];
+    REAL* log_r = new REAL[k];
+    REAL* inter = new REAL[k];
+    int hist[CALIB_K1];
+    REAL bins[CALIB_K1];
+    REAL* data = calibData(CALIB_NUM_ELE, dim);
+    Timer tim;
+    tim.start();
+    if(c == COST_FULL) {
+        CorrDim cd(data, CALIB_NUM_ELE, dim);
+        cd.evalCorrDim(k, 1, 1, log_cr, log_r, inter);
+        cd.getDistMatrixHistogram(CALIB_K1, hist, bins);
+    }
+    else if(c == COST_LOWMEM) {
+        CorrDimLowMem cd(data, CALIB_NUM_ELE, dim);
+        cd.evalCorrDim(k, 1, 1, log_cr, log_r, inter);
+        cd.getDistMatrixHistogram(CALIB_K1, hist, bins);
+    }
+    else {
+        unsigned long int budget = (c == COST_STORED)? distMatrixMemory(CALIB_NUM_ELE) : 0;
+        CorrDimHybrid cd(data, CALIB_NUM_ELE, dim, budget);
+        cd.evalCorrDim(k, 1, 1, log_cr, log_r, inter);
+        cd.getDistMatrixHistogram(CALIB_K1, hist, bins);
+    }
+    tim.stop();
+    delete [] data;
+    delete [] log_cr;
+    delete [] log_r;
+    delete [] inter;
+    return tim.report() / TRI(CALIB_NUM_ELE);
+}
+
+
+CostModel::CostModel(bool recalibrate/*=false*/) {
+    string file = cacheFile();
+    if(recalibrate || !load(file)) {
+        Timer tim;
+        fprintf(stdout, "Calibrating the cost model (one-off)... ");
+        fflush(stdout);
+        tim.start();
+        calibrate();
+        tim.stopAndPrintTime("Time taken: %f s\n");
+        save(file);
+    }
+}
+
+string CostModel::cacheFile() {
+    const char* home = getenv("HOME");
+    if(home == NULL) {
+        return CALIB_FILE;
+    }
+    return string(home) + "/" + CALIB_FILE;
+}
+
+/**
+ * @brief Build and machine the costs are measured on
+ * @return the compiler, optimizations, CPU model and number of cores
+ *
+ * Costs cached by another build (or on another machine) are stale.
+ */
+static string calibTag() {
+    return string(__VERSION__) + " " + CALIB_OPTIMIZE + " | " + cpuModel() + " x " +
+        to_string(numCores());
+}
+
+bool CostModel::load(const string& file) {
+    FILE* fp = fopen(file.c_str(), "r");
+    if(fp == NULL) {
+        return false;
+    }
+    int version = -1;
+    char tag[512] = "";
+    bool ok = (fscanf(fp, "corrdim-calibration %d\n", &version) == 1) &&
+              (version == CALIB_VERSION) && (fgets(tag, sizeof(tag), fp) != NULL) &&
+              (string(tag) == calibTag() + "\n");
+    for(int c=0;ok&&(c<4);c++) {
+        for(int i=0;ok&&(i<4);i++) {
+            ok = (fscanf(fp, "%lf", &(m_cost[c][i])) == 1) && (m_cost[c][i] > 0);
+        }
+    }
+    fclose(fp);
+    return ok;
+}
+
+void CostModel::save(const string& file) const {
+    FILE* fp = fopen(file.c_str(), "w");
+    if(fp == NULL) {
+        fprintf(stderr, "Failed to open the file '%s' for writing! Calibration will be redone next time.\n",
+                file.c_str());
+        return;
+    }
+    fprintf(fp, "corrdim-calibration %d\n", CALIB_VERSION);
+    fprintf(fp, "%s\n", calibTag().c_str());
+    for(int c=0;c<4;c++) {
+        fprintf(fp, "%e %e %e %e\n", m_cost[c][0], m_cost[c][1], m_cost[c][2], m_cost[c][3]);
+    }
+    fclose(fp);
+}
+
+void CostModel::calibrate() {
+    for(int c=0;c<4;c++) {
+        m_cost[c][0] = calibRun(c, 1, CALIB_K1);
+        m_cost[c][1] = calibRun(c, 2, CALIB_K1);
+        m_cost[c][2] = calibRun(c, 6, CALIB_K1);
+        m_cost[c][3] = calibRun(c, 1, CALIB_K2);
+    }
+}
+
+REAL CostModel::pairCost(int c, int dim, int k) const {
+    const REAL* m = m_cost[c];
+    // 1-d vectors have their own code-path. Others are linear in 'dim'
+    REAL cost = (dim == 1)? m[0] : m[1] + ((dim - 2) * (m[2] - m[1]) / 4);
+    // cost of the extra (or fewer) 'R' values
+    REAL perR = (m[3] - m[0]) / (CALIB_K2 - CALIB_K1);
+    if(perR < 0) {
+        perR = 0;
+    }
+    cost += (k - CALIB_K1) * perR;
+    return (cost < 0)? m[0] : cost;
+}
+
+REAL CostModel::predict(EngineType e, int numEle, int dim, int k, REAL stored, int threads) const {
+    REAL pairs = (REAL) TRI(numEle);
+    switch(e) {
+    case ENGINE_FULL:
+        return pairs * pairCost(COST_FULL, dim, k);
+    case ENGINE_LOWMEM:
+        return pairs * pairCost(COST_LOWMEM, dim, k);
+    case ENGINE_HYBRID:
+        return pairs * ((stored * pairCost(COST_STORED, dim, k)) +
+                        ((1 - stored) * pairCost(COST_RECOMPUTED, dim, k))) / threads;
+    default:
+        return -1;
+    }
+}
+
+EnginePlan CostModel::plan(EngineType e, int numEle, int dim, int numPts, int numBins,
+                           unsigned long int maxMem, int threads) const {
+    unsigned long int budget = (unsigned long int) (availableMemory() * MEM_SAFETY);
+    if((maxMem > 0) && ((budget == 0) || (maxMem < budget))) {
+        budget = maxMem;
+    }
+    if(threads <= 0) {
+        threads = numCores();
+    }
+    unsigned long int base = baseMemory(numEle, dim, numPts, numBins);
+    unsigned long int full = base + distMatrixMemory(numEle);
+    unsigned long int over = hybridOverhead(numEle, threads);
+    EnginePlan cand[ENGINE_COUNT];
+    // CorrDim
+    cand[ENGINE_FULL].engine = ENGINE_FULL;
+    cand[ENGINE_FULL].threads = 1;
+    cand[ENGINE_FULL].tileBytes = 0;
+    cand[ENGINE_FULL].predMem = full;
+    cand[ENGINE_FULL].predTime = predict(ENGINE_FULL, numEle, dim, numPts, 0, 1);
+    // CorrDimLowMem
+    cand[ENGINE_LOWMEM].engine = ENGINE_LOWMEM;
+    cand[ENGINE_LOWMEM].threads = 1;
+    cand[ENGINE_LOWMEM].tileBytes = 0;
+    cand[ENGINE_LOWMEM].predMem = base;
+    cand[ENGINE_LOWMEM].predTime = predict(ENGINE_LOWMEM, numEle, dim, numPts, 0, 1);
+    // CorrDimHybrid
+    unsigned long int tiles = (budget > (base + over))? budget - base - over : 0;
+    tiles = CorrDimHybrid::tileBytes(numEle, tiles);
+    REAL stored = (numEle > 1)? (REAL) tiles / distMatrixMemory(numEle) : 1;
+    cand[ENGINE_HYBRID].engine = ENGINE_HYBRID;
+    cand[ENGINE_HYBRID].threads = threads;
+    cand[ENGINE_HYBRID].tileBytes = tiles;
+    cand[ENGINE_HYBRID].predMem = base + over + tiles;
+    cand[ENGINE_HYBRID].predTime = predict(ENGINE_HYBRID, numEle, dim, numPts, stored, threads);
+    if(e != ENGINE_AUTO) {
+        cand[e].automatic = false;
+        return cand[e];
+    }
+    // fastest among the ones fitting inside the budget, else the smallest
+    EnginePlan best = cand[ENGINE_LOWMEM];
+    for(int i=ENGINE_FULL;i<ENGINE_COUNT;i++) {
+        if((cand[i].predMem <= budget) && (cand[i].predTime < best.predTime)) {
+            best = cand[i];
+        }
+    }
+    best.automatic = true;
+    return best;
+}
@@ -0,0 +1,200 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_COSTMODEL_H__
+#define __INCLUDED_COSTMODEL_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+
+
+/** number of data points used while calibrating the cost model */
+#define CALIB_NUM_ELE   1500
+/** number of 'R' values used while calibrating the cost model */
+#define CALIB_K1        10
+/** another number of 'R' values, to find out the cost per 'R' */
+#define CALIB_K2        40
+/** fraction of the available memory the engines are allowed to use */
+#define MEM_SAFETY      0.8
+/** name of the file (inside $HOME) caching the calibrated costs */
+#define CALIB_FILE      ".corrdim.calib"
+
+
+/**
+ * Engines which can evaluate the correlation dimension.
+ */
+enum EngineType {
+    ENGINE_AUTO = 0,    ///< choose one of the others using the cost model
+    ENGINE_FULL,        ///< 'CorrDim': full distance matrix
+    ENGINE_LOWMEM,      ///< 'CorrDimLowMem': no distance matrix at all
+    ENGINE_HYBRID,      ///< 'CorrDimHybrid': tiled, partly recomputed
+    ENGINE_COUNT
+};
+
+/**
+ * @brief Name of the given engine (as used on the commandline)
+ * @param e the engine
+ * @return name
+ */
+const char* engineName(EngineType e);
+
+/**
+ * @brief Converts the commandline name to an engine
+ * @param name one of 'auto', 'full', 'lowmem' or 'hybrid'
+ * @param e will contain the engine
+ * @return false if the name is not recognized
+ */
+bool parseEngine(const std::string& name, EngineType& e);
+
+
+/**
+ * The engine chosen for a run, along with its predicted cost.
+ */
+struct EnginePlan {
+    EngineType engine;         ///< engine to be used
+    bool automatic;            ///< whether it was chosen by the cost model
+    int threads;               ///< number of worker threads for the engine
+    unsigned long int tileBytes;  ///< budget for the distance tiles (hybrid only)
+    REAL predTime;             ///< predicted run-time (in s) of the engine
+    unsigned long int predMem; ///< predicted memory usage (in B)
+};
+
+
+/**
+ * @brief Memory needed by every engine
+ * @param numEle number of vectors.
+ * @param dim dimension of the vectors.
+ * @param numPts number of points on the log(CR) vs log(R) plot.
+ * @param numBins number of bins in the distance matrix histogram.
+ * @return bytes for the signal, the histogram and the log_r/log_cr/inter arrays
+ */
+unsigned long int baseMemory(int numEle, int dim, int numPts, int numBins);
+
+/**
+ * @brief Memory needed by the lower triangular distance matrix
+ * @param numEle number of vectors.
+ * @return bytes
+ */
+unsigned long int distMatrixMemory(int numEle);
+
+/**
+ * @brief Memory needed by 'CorrDimHybrid', apart from the tiles
+ * @param numEle number of vectors.
+ * @param threads number of worker threads.
+ * @return bytes
+ */
+unsigned long int hybridOverhead(int numEle, int threads);
+
+
+/**
+ * Class which predicts the run-time of the engines. The cost of one pair
+ * of vectors, for every engine, is measured once on a small synthetic data
+ * set and cached in the file '$HOME/.corrdim.calib', which is ignored if it
+ * comes from another build or machine. The prediction then
+ * scales this to the number of pairs, the dimension, the number of 'R'
+ * values and the number of threads of the actual run.
+ */
+class CostModel {
+public:
+    /**
+     * @brief Constructor. Loads the cached costs or calibrates them.
+     * @param recalibrate calibrate even if the cached costs are available.
+     */
+    CostModel(bool recalibrate=false);
+
+    /**
+     * @brief Predicts the run-time of an engine
+     * @param e the engine.
+     * @param numEle number of vectors.
+     * @param dim dimension of the vectors.
+     * @param k number of points on the log(CR) vs log(R) plot.
+     * @param stored fraction of the distance matrix materialized (hybrid only).
+     * @param threads number of worker threads (hybrid only).
+     * @return predicted time in seconds
+     */
+    REAL predict(EngineType e, int numEle, int dim, int k, REAL stored, int threads) const;
+
+    /**
+     * @brief Chooses the engine (if needed) and predicts its cost
+     * @param e the engine asked for on the commandline (could be 'auto').
+     * @param numEle number of vectors.
+     * @param dim dimension of the vectors.
+     * @param numPts number of points on the log(CR) vs log(R) plot.
+     * @param numBins number of bins in the distance matrix histogram.
+     * @param maxMem memory budget (in B) asked for. 0 means no budget.
+     * @param threads number of worker threads. 0 means all cores.
+     * @return the plan
+     *
+     * The budget is further limited by the memory actually available.
+     * Among the engines fitting inside the budget, the fastest is chosen.
+     */
+    EnginePlan plan(EngineType e, int numEle, int dim, int numPts, int numBins,
+                    unsigned long int maxMem, int threads) const;
+
+private:
+    /**
+     * @brief Measures the per-pair costs of all the engines
+     */
+    void calibrate();
+
+    /**
+     * @brief Reads the cached per-pair costs
+     * @param file the cache file.
+     * @return false if the file is missing or is of a different version.
+     */
+    bool load(const std::string& file);
+
+    /**
+     * @brief Writes the per-pair costs into the cache
+     * @param file the cache file.
+     */
+    void save(const std::string& file) const;
+
+    /**
+     * @brief Full path of the cache file
+     * @return path
+     */
+    static std::string cacheFile();
+
+    /**
+     * @brief Per-pair cost of one of the calibrated configurations
+     * @param c the configuration (see 'm_cost').
+     * @param dim dimension of the vectors.
+     * @param k number of points on the log(CR) vs log(R) plot.
+     * @return cost in seconds
+     */
+    REAL pairCost(int c, int dim, int k) const;
+
+private:
+    /**
+     * Per-pair cost (in s) of 4 configurations: 'CorrDim', 'CorrDimLowMem',
+     * 'CorrDimHybrid' with all rows stored and with no rows stored. Each is
+     * measured at dim=1, dim=2 and dim=6 with CALIB_K1 'R' values, and at
+     * dim=1 with CALIB_K2 'R' values.
+     */
+    REAL m_cost[4][4];
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_COSTMODEL_H__
@@ -0,0 +1,62 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "MemTrack.h"
+
+
+using namespace std;
+
+
+atomic<unsigned long int> MemTrack::s_current[NUM_MEM_POOLS+1];
+atomic<unsigned long int> MemTrack::s_peak[NUM_MEM_POOLS+1];
+
+/** names of the pools */
+static const char* s_names[NUM_MEM_POOLS] = {"vectors", "distances", "sketch", "io"};
+
+
+void MemTrack::grow(int idx, unsigned long int bytes) {
+    unsigned long int now = s_current[idx].fetch_add(bytes, memory_order_relaxed) + bytes;
+    unsigned long int old = s_peak[idx].load(memory_order_relaxed);
+    while((now > old) && !s_peak[idx].compare_exchange_weak(old, now, memory_order_relaxed)) {
+    }
+}
+
+void MemTrack::add(MemPool pool, unsigned long int bytes) {
+    grow(pool, bytes);
+    grow(NUM_MEM_POOLS, bytes);
+}
+
+void MemTrack::remove(MemPool pool, unsigned long int bytes) {
+    s_current[pool].fetch_sub(bytes, memory_order_relaxed);
+    s_current[NUM_MEM_POOLS].fetch_sub(bytes, memory_order_relaxed);
+}
+
+
+unsigned long int MemTrack::current(MemPool pool) {
+    return s_current[pool].load(memory_order_relaxed);
+}
+
+unsigned long int MemTrack::peak(MemPool pool) {
+    return s_peak[pool].load(memory_order_relaxed);
+}
+
+const char* MemTrack::name(MemPool pool) {
+    return s_names[pool];
+}
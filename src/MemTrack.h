@@ -0,0 +1,185 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_MEMTRACK_H__
+#define __INCLUDED_MEMTRACK_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+
+/** subsystems whose memory is accounted for separately */
+enum MemPool {
+    MEM_VECTORS = 0,   ///< the vectors of the map (or of the file)
+    MEM_DISTANCES,     ///< the stored distance matrix (or tiles of it)
+    MEM_SKETCH,        ///< pair-count sketches
+    MEM_IO,            ///< blocks read but not yet converted
+    NUM_MEM_POOLS
+};
+
+
+/**
+ * Accounting of the big buffers of the program, per subsystem. Every pool
+ * knows the bytes it currently holds and the most it ever held, so that the
+ * measured peak resident memory (see 'peakResidentMemory') can be broken down.
+ *
+ * Arrays come from 'allocate' and go back to 'release', which keeps their
+ * size in a small header. Containers use 'TrackingAllocator' instead, and
+ * memory obtained otherwise (eg: with 'mmap') is reported via 'add'/'remove'.
+ *
+ * Usage:
+ *  REAL* arr = MemTrack::allocate<REAL>(num, MEM_VECTORS);
+ *  ...
+ *  MemTrack::release(arr);
+ *  printf("%lu\n", MemTrack::peak(MEM_VECTORS));
+ */
+class MemTrack {
+public:
+    /**
+     * @brief Allocates an (uninitialized) array
+     * @param num number of elements.
+     * @param pool pool charged for it.
+     * @return the array (to be freed with 'release')
+     */
+    template <typename T>
+    static T* allocate(unsigned long int num, MemPool pool) {
+        static_assert(std::is_trivial<T>::value, "only plain old data can be tracked");
+        unsigned long int bytes = num * sizeof(T);
+        Header* hdr = (Header*) ::operator new(sizeof(Header) + bytes);
+        hdr->bytes = bytes;
+        hdr->pool = pool;
+        add(pool, bytes);
+        return (T*) (hdr + 1);
+    }
+
+    /**
+     * @brief Frees an array from 'allocate'
+     * @param arr the array (NULL is ignored).
+     */
+    template <typename T>
+    static void release(T* arr) {
+        if(arr == NULL) {
+            return;
+        }
+        Header* hdr = ((Header*) arr) - 1;
+        remove(hdr->pool, hdr->bytes);
+        ::operator delete(hdr);
+    }
+
+    /**
+     * @brief Charges a pool with memory not obtained from 'allocate'
+     * @param pool the pool.
+     * @param bytes the amount.
+     */
+    static void add(MemPool pool, unsigned long int bytes);
+
+    /**
+     * @brief Gives back the memory charged with 'add'
+     * @param pool the pool.
+     * @param bytes the amount.
+     */
+    static void remove(MemPool pool, unsigned long int bytes);
+
+    /**
+     * @brief Bytes currently held by a pool
+     * @param pool the pool (NUM_MEM_POOLS means all of them).
+     * @return the amount
+     */
+    static unsigned long int current(MemPool pool);
+
+    /**
+     * @brief Most bytes ever held by a pool
+     * @param pool the pool (NUM_MEM_POOLS means all of them, at the same time).
+     * @return the amount
+     */
+    static unsigned long int peak(MemPool pool);
+
+    /**
+     * @brief Name of a pool
+     * @param pool the pool.
+     * @return the name
+     */
+    static const char* name(MemPool pool);
+
+private:
+    /** what 'allocate' keeps in front of every array */
+    struct alignas(16) Header {
+        unsigned long int bytes;  ///< size of the array
+        MemPool pool;             ///< pool charged for it
+    };
+
+    /**
+     * @brief Adds to the bytes held by a pool, updating its peak
+     * @param idx index of the pool (NUM_MEM_POOLS for the total).
+     * @param bytes the amount.
+     */
+    static void grow(int idx, unsigned long int bytes);
+
+private:
+    static std::atomic<unsigned long int> s_current[NUM_MEM_POOLS+1];  ///< bytes held (the last is the total)
+    static std::atomic<unsigned long int> s_peak[NUM_MEM_POOLS+1];     ///< most bytes held
+};
+
+
+/**
+ * Allocator for the standard containers, charging the given pool.
+ */
+template <typename T, MemPool P>
+class TrackingAllocator {
+public:
+    typedef T value_type;
+
+    template <typename U>
+    struct rebind {
+        typedef TrackingAllocator<U, P> other;
+    };
+
+    TrackingAllocator() {}
+
+    template <typename U>
+    TrackingAllocator(const TrackingAllocator<U, P>& other) {}
+
+    T* allocate(size_t num) {
+        MemTrack::add(P, num * sizeof(T));
+        return std::allocator<T>().allocate(num);
+    }
+
+    void deallocate(T* ptr, size_t num) {
+        MemTrack::remove(P, num * sizeof(T));
+        std::allocator<T>().deallocate(ptr, num);
+    }
+
+    template <typename U>
+    bool operator==(const TrackingAllocator<U, P>& other) const { return true; }
+
+    template <typename U>
+    bool operator!=(const TrackingAllocator<U, P>& other) const { return false; }
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_MEMTRACK_H__
@@ -0,0 +1,272 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Metrics.h"
+#include "Timer.h"
+#include "Trace.h"
+#include "MemTrack.h"
+#include "SysInfo.h"
+#include <time.h>
+
+
+using namespace std;
+
+
+/** metrics collected on this thread */
+static thread_local Metrics* s_current = NULL;
+
+
+const char* phaseName(Phase p) {
+    static const char* names[NUM_PHASES] = {"generate", "distances", "corrsum", "histogram",
+                                            "fit", "dump"};
+    return names[p];
+}
+
+
+/**
+ * @brief Reads one of the clocks
+ * @param id the clock
+ * @return seconds
+ */
+static REAL readClock(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
+/**
+ * @brief Escapes a string for JSON
+ * @param str the string
+ * @return the quoted string
+ */
+static string jsonString(const string& str) {
+    string out = "\"";
+    for(size_t i=0;i<str.size();i++) {
+        char c = str[i];
+        if((c == '"') || (c == '\\')) {
+            out += '\\';
+            out += c;
+        }
+        else if((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+
+Metrics::Metrics() {
+    memset(m_phases, 0, sizeof(m_phases));
+    m_counting = false;
+    m_startWall = wallTime();
+    m_startCpu = cpuTime();
+}
+
+Metrics::~Metrics() {
+    if(s_current == this) {
+        s_current = NULL;
+    }
+}
+
+void Metrics::attach() {
+    s_current = this;
+}
+
+Metrics* Metrics::current() {
+    return s_current;
+}
+
+REAL Metrics::cpuTime() {
+    return readClock(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+REAL Metrics::threadCpuTime() {
+    return readClock(CLOCK_THREAD_CPUTIME_ID);
+}
+
+
+bool Metrics::openCounters() {
+    m_counting = m_perf.open();
+    return m_counting;
+}
+
+void Metrics::readEvents(unsigned long long* events) {
+    if(m_counting) {
+        m_perf.read(events);
+    }
+    else {
+        memset(events, 0, sizeof(unsigned long long) * PERF_NUM_EVENTS);
+    }
+}
+
+void Metrics::charge(REAL wall, REAL cpu, const unsigned long long* events) {
+    Open& top = m_open.back();
+    Counters& c = m_phases[top.phase];
+    c.wall += wall - top.wall;
+    c.cpu += cpu - top.cpu;
+    top.wall = wall;
+    top.cpu = cpu;
+    for(int e=0;e<PERF_NUM_EVENTS;e++) {
+        c.events[e] += events[e] - top.events[e];
+        top.events[e] = events[e];
+    }
+}
+
+void Metrics::enter(Phase p) {
+    Metrics* m = s_current;
+    if(m == NULL) {
+        return;
+    }
+    Open o;
+    m->readEvents(o.events);
+    o.begin = Timer::ticks();
+    o.phase = p;
+    o.wall = wallTime();
+    o.cpu = cpuTime();
+    // the outer phase is paused meanwhile
+    if(!m->m_open.empty()) {
+        m->charge(o.wall, o.cpu, o.events);
+    }
+    m->m_open.push_back(o);
+}
+
+void Metrics::leave() {
+    Metrics* m = s_current;
+    if((m == NULL) || m->m_open.empty()) {
+        return;
+    }
+    REAL wall = wallTime();
+    REAL cpu = cpuTime();
+    unsigned long long events[PERF_NUM_EVENTS];
+    m->readEvents(events);
+    m->charge(wall, cpu, events);
+    Trace::event(phaseName(m->m_open.back().phase), "phase", m->m_open.back().begin, Timer::ticks());
+    m->m_open.pop_back();
+    if(!m->m_open.empty()) {
+        Open& top = m->m_open.back();
+        top.wall = wall;
+        top.cpu = cpu;
+        memcpy(top.events, events, sizeof(events));
+    }
+}
+
+
+void Metrics::addTime(Phase p, REAL wall, REAL cpu) {
+    m_phases[p].wall += wall;
+    m_phases[p].cpu += cpu;
+}
+
+void Metrics::count(Phase p, unsigned long int pairs, unsigned long int pruned/*=0*/,
+                    unsigned long int bytes/*=0*/) {
+    m_phases[p].pairs += pairs;
+    m_phases[p].pruned += pruned;
+    m_phases[p].bytes += bytes;
+}
+
+void Metrics::info(const string& key, const string& value) {
+    m_info.push_back(make_pair(key, jsonString(value)));
+}
+
+void Metrics::info(const string& key, REAL value) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", value);
+    m_info.push_back(make_pair(key, string(buf)));
+}
+
+
+string Metrics::ratio(const unsigned long long* events, int e, unsigned long long den,
+                      const char* fmt) {
+    if(!m_perf.available(e) || (den == 0) || ((e == PERF_INSTRUCTIONS) &&
+                                              !m_perf.available(PERF_CYCLES))) {
+        return "null";
+    }
+    char buf[64];
+    snprintf(buf, sizeof(buf), fmt, (double) events[e] / den);
+    return buf;
+}
+
+void Metrics::printCounters(FILE* fp) {
+    fprintf(fp, "COUNTERS (per phase, all threads, user space):\n");
+    fprintf(fp, "  %-10s %14s %16s %16s %8s %14s %14s\n", "phase", "cycles", "instructions",
+            "pairs", "IPC", "LLC-miss/pair", "br-miss/pair");
+    for(int p=0;p<NUM_PHASES;p++) {
+        const Counters& c = m_phases[p];
+        fprintf(fp, "  %-10s %14llu %16llu %16lu %8s %14s %14s\n", phaseName((Phase) p),
+                c.events[PERF_CYCLES], c.events[PERF_INSTRUCTIONS], c.pairs,
+                ratio(c.events, PERF_INSTRUCTIONS, c.events[PERF_CYCLES], "%.3f").c_str(),
+                ratio(c.events, PERF_LLC_MISSES, c.pairs, "%.6f").c_str(),
+                ratio(c.events, PERF_BRANCH_MISSES, c.pairs, "%.6f").c_str());
+    }
+}
+
+
+bool Metrics::write(const string& file) {
+    FILE* fp = fopen(file.c_str(), "w");
+    if(fp == NULL) {
+        return false;
+    }
+    fprintf(fp, "{\n");
+    for(size_t i=0;i<m_info.size();i++) {
+        fprintf(fp, "  %s: %s,\n", jsonString(m_info[i].first).c_str(), m_info[i].second.c_str());
+    }
+    fprintf(fp, "  \"wall\": %.9f,\n", wallTime() - m_startWall);
+    fprintf(fp, "  \"cpu\": %.9f,\n", cpuTime() - m_startCpu);
+    // measured, unlike the 'memEstimate' of the cost model
+    fprintf(fp, "  \"peakRss\": %lu,\n", peakResidentMemory());
+    fprintf(fp, "  \"memory\": {\n");
+    for(int p=0;p<=NUM_MEM_POOLS;p++) {
+        MemPool pool = (MemPool) p;
+        fprintf(fp, "    \"%s\": {\"peak\": %lu, \"current\": %lu}%s\n",
+                (p < NUM_MEM_POOLS)? MemTrack::name(pool) : "all", MemTrack::peak(pool),
+                MemTrack::current(pool), (p < NUM_MEM_POOLS)? "," : "");
+    }
+    fprintf(fp, "  },\n");
+    fprintf(fp, "  \"phases\": {\n");
+    for(int p=0;p<NUM_PHASES;p++) {
+        const Counters& c = m_phases[p];
+        fprintf(fp, "    \"%s\": {\"wall\": %.9f, \"cpu\": %.9f, \"pairs\": %lu, \"pruned\": %lu, "
+                "\"bytes\": %lu, \"pairsPerSec\": %.1f", phaseName((Phase) p), c.wall, c.cpu,
+                c.pairs, c.pruned, c.bytes, (c.wall > 0)? c.pairs / c.wall : 0);
+        if(m_counting) {
+            // the events not counted are null, rather than a misleading 0
+            for(int e=0;e<PERF_NUM_EVENTS;e++) {
+                if(m_perf.available(e)) {
+                    fprintf(fp, ", \"%s\": %llu", PerfCounters::eventName(e), c.events[e]);
+                }
+                else {
+                    fprintf(fp, ", \"%s\": null", PerfCounters::eventName(e));
+                }
+            }
+            fprintf(fp, ", \"ipc\": %s, \"llcMissesPerPair\": %s, \"branchMissesPerPair\": %s",
+                    ratio(c.events, PERF_INSTRUCTIONS, c.events[PERF_CYCLES], "%.3f").c_str(),
+                    ratio(c.events, PERF_LLC_MISSES, c.pairs, "%.6f").c_str(),
+                    ratio(c.events, PERF_BRANCH_MISSES, c.pairs, "%.6f").c_str());
+        }
+        fprintf(fp, "}%s\n", (p + 1 < NUM_PHASES)? "," : "");
+    }
+    fprintf(fp, "  }\n");
+    fprintf(fp, "}\n");
+    return fclose(fp) == 0;
+}
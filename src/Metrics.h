@@ -0,0 +1,260 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_METRICS_H__
+#define __INCLUDED_METRICS_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include "PerfCounters.h"
+
+
+/** phases of a run, as reported by 'Metrics' */
+enum Phase {
+    PHASE_GENERATE = 0,   ///< generating (or reading) the vectors
+    PHASE_DISTANCES,      ///< first pass over the pairs (distances or min/max)
+    PHASE_CORRSUM,        ///< correlation sums
+    PHASE_HISTOGRAM,      ///< histogram of the distance matrix
+    PHASE_FIT,            ///< least-squares fit
+    PHASE_DUMP,           ///< writing the outputs
+    NUM_PHASES
+};
+
+
+/**
+ * @brief Name of a phase, as it appears in the JSON
+ * @param p the phase
+ * @return the name
+ */
+const char* phaseName(Phase p);
+
+
+/**
+ * Per-phase performance metrics of a run: wall and CPU time, pairs evaluated
+ * and pruned, bytes read and the resulting throughput. Written as JSON via
+ * '-metrics', so that dashboards (and 'profile.pl') need not scrape stdout.
+ *
+ * Phases nest. The inner one pauses the outer one, so the times of the
+ * phases are exclusive and add up to the time spent inside all of them.
+ * The metrics are collected only on the thread which has called 'attach',
+ * so that the engines can mark their phases with 'MetricsScope' for free
+ * when nobody is collecting (eg: in the server or batch modes). Optionally
+ * (see 'openCounters'), the hardware performance counters are charged to the
+ * phases the same way.
+ *
+ * Usage:
+ *  Metrics m;
+ *  m.attach();
+ *  { MetricsScope s(PHASE_CORRSUM); ... }
+ *  m.count(PHASE_CORRSUM, numPairs);
+ *  m.write("run.json");
+ */
+class Metrics {
+public:
+    /**
+     * @brief Constructor of this class.
+     */
+    Metrics();
+
+    /**
+     * @brief Destructor of this class. Detaches, if attached.
+     */
+    ~Metrics();
+
+    /**
+     * @brief Collects the phases entered on the calling thread from now on
+     */
+    void attach();
+
+    /**
+     * @brief Metrics collected on the calling thread
+     * @return the metrics, NULL if none are being collected
+     */
+    static Metrics* current();
+
+    /**
+     * @brief Enters a phase (on the calling thread, if collecting)
+     * @param p the phase
+     */
+    static void enter(Phase p);
+
+    /**
+     * @brief Leaves the phase entered last (on the calling thread, if collecting)
+     */
+    static void leave();
+
+    /**
+     * @brief Adds the time spent in a phase outside 'enter'/'leave' (eg: on
+     *  another thread)
+     * @param p the phase.
+     * @param wall wall time (in s).
+     * @param cpu CPU time (in s).
+     */
+    void addTime(Phase p, REAL wall, REAL cpu);
+
+    /**
+     * @brief Adds to the counters of a phase
+     * @param p the phase.
+     * @param pairs pairs evaluated.
+     * @param pruned pairs skipped.
+     * @param bytes bytes read.
+     */
+    void count(Phase p, unsigned long int pairs, unsigned long int pruned=0,
+               unsigned long int bytes=0);
+
+    /**
+     * @brief Adds a property of the run (eg: the map) to the JSON
+     * @param key name of the property.
+     * @param value its value.
+     */
+    void info(const std::string& key, const std::string& value);
+
+    /**
+     * @brief Same as above, for numbers
+     */
+    void info(const std::string& key, REAL value);
+
+    /**
+     * @brief Also charges the hardware performance counters to the phases
+     * @return false if they are unavailable (see 'countersError')
+     *
+     * This must be called before any worker thread is started, for their
+     * events to be counted.
+     */
+    bool openCounters();
+
+    /**
+     * @brief Why 'openCounters' failed
+     * @return the message
+     */
+    const std::string& countersError() const { return m_perf.error(); }
+
+    /**
+     * @brief Whether the hardware performance counters are being charged
+     * @return true if 'openCounters' succeeded
+     */
+    bool counting() const { return m_counting; }
+
+    /**
+     * @brief Prints the performance counters of every phase, along with
+     *  the IPC and the misses per pair
+     * @param fp where to print.
+     */
+    void printCounters(FILE* fp);
+
+    /**
+     * @brief Writes the metrics as JSON
+     * @param file the file.
+     * @return false if the file couldn't be written
+     */
+    bool write(const std::string& file);
+
+    /**
+     * @brief CPU time used by the process so far (all threads)
+     * @return seconds
+     */
+    static REAL cpuTime();
+
+    /**
+     * @brief CPU time used by the calling thread so far
+     * @return seconds
+     */
+    static REAL threadCpuTime();
+
+private:
+    /** counters of one phase */
+    struct Counters {
+        REAL wall;                 ///< wall time (in s)
+        REAL cpu;                  ///< CPU time (in s)
+        unsigned long int pairs;   ///< pairs evaluated
+        unsigned long int pruned;  ///< pairs skipped
+        unsigned long int bytes;   ///< bytes read
+        unsigned long long events[PERF_NUM_EVENTS];  ///< hardware events
+    };
+
+    /** one open phase */
+    struct Open {
+        Phase phase;               ///< the phase
+        REAL wall;                 ///< wall time when it (re)started
+        REAL cpu;                  ///< CPU time when it (re)started
+        unsigned long long events[PERF_NUM_EVENTS];  ///< hardware events when it (re)started
+        unsigned long long begin;  ///< ticks when it was entered (for 'Trace')
+    };
+
+    /**
+     * @brief Charges the time (and events) since the innermost phase
+     *  (re)started to it
+     * @param wall current wall time.
+     * @param cpu current CPU time.
+     * @param events current hardware events.
+     */
+    void charge(REAL wall, REAL cpu, const unsigned long long* events);
+
+    /**
+     * @brief Ratio of an event to something else, for the reports
+     * @param events the events of a phase.
+     * @param e the event.
+     * @param den the other thing (eg: the pairs).
+     * @param fmt how to print the ratio.
+     * @return the ratio, "null" if the event isn't counted or 'den' is 0
+     */
+    std::string ratio(const unsigned long long* events, int e, unsigned long long den,
+                      const char* fmt);
+
+    /**
+     * @brief Reads the hardware events, if counting them
+     * @param events the events (output, all 0 if not counting).
+     */
+    void readEvents(unsigned long long* events);
+
+private:
+    Counters m_phases[NUM_PHASES];   ///< counters of every phase
+    std::vector<Open> m_open;        ///< phases entered, innermost last
+    std::vector<std::pair<std::string, std::string> > m_info;  ///< properties (as JSON values)
+    REAL m_startWall;                ///< wall time at construction
+    REAL m_startCpu;                 ///< CPU time at construction
+    PerfCounters m_perf;             ///< hardware performance counters
+    bool m_counting;                 ///< whether 'm_perf' is open
+};
+
+
+/**
+ * Marks the lifetime of this object as a phase, see 'Metrics'.
+ */
+class MetricsScope {
+public:
+    /**
+     * @brief Enters the phase
+     * @param p the phase
+     */
+    MetricsScope(Phase p) { Metrics::enter(p); }
+
+    /**
+     * @brief Leaves the phase
+     */
+    ~MetricsScope() { Metrics::leave(); }
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_METRICS_H__
@@ -0,0 +1,453 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "PairSketch.h"
+#include "Metrics.h"
+#include "Progress.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+
+using namespace std;
+
+
+/** identifies (and versions) the sketch files */
+#define SKETCH_MAGIC  "CDSKTCH2"
+/** files written before the row ranges were stored */
+#define SKETCH_MAGIC1 "CDSKTCH1"
+/** extra bins stored on either side when the bin range grows */
+#define SKETCH_MARGIN (1L << SKETCH_SUB_BITS)
+/** blocks of rows per worker, so that no worker is left idle */
+#define BLOCKS_PER_THREAD 4
+
+
+/**
+ * @brief Bin holding a (positive) distance
+ * @param d the distance.
+ * @return the bin
+ */
+static inline long int binOf(REAL d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return (long int) (bits >> (52 - SKETCH_SUB_BITS));
+}
+
+/**
+ * @brief Left edge of a bin
+ * @param bin the bin.
+ * @return the smallest distance inside it
+ */
+static inline REAL binEdge(long int bin) {
+    uint64_t bits = ((uint64_t) bin) << (52 - SKETCH_SUB_BITS);
+    REAL d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+
+PairSketch::PairSketch() {
+    reset(0, false);
+}
+
+void PairSketch::reset(int numVec, bool squared, int numSets/*=1*/) {
+    m_numVec = numVec;
+    m_squared = squared;
+    m_sets = numSets;
+    m_pairs = 0;
+    m_zeros = 0;
+    m_min = numeric_limits<REAL>::max();
+    m_max = 0;
+    m_first = 0;
+    m_counts.clear();
+    m_rows.clear();
+    m_error = "";
+}
+
+
+void PairSketch::addPairs(const REAL* data, int numVec, int dim, int rowBegin, int rowEnd,
+                          ThreadPool* pool) {
+    if((pool == NULL) || (pool->size() == 1)) {
+        addRows(data, dim, rowBegin, rowEnd);
+        return;
+    }
+    // every worker fills its own sketch, which are merged at the end
+    vector<PairSketch> local(pool->size());
+    for(size_t w=0;w<local.size();w++) {
+        local[w].reset(m_numVec, m_squared, m_sets);
+    }
+    vector<int> bounds = splitRows(rowEnd, pool->size() * BLOCKS_PER_THREAD, rowBegin);
+    pool->parallelFor((int) bounds.size() - 1, [&](int task, int worker) {
+        local[worker].addRows(data, dim, bounds[task], bounds[task+1]);
+    });
+    for(size_t w=0;w<local.size();w++) {
+        merge(local[w]);
+    }
+}
+
+void PairSketch::addRows(const REAL* data, int dim, int rowBegin, int rowEnd) {
+    for(int i=rowBegin;i<rowEnd;i++) {
+        const REAL* x = data + ((unsigned long int) i * dim);
+        for(int j=0;j<i;j++) {
+            REAL d;
+            // same arithmetic as 'CorrDim', so that the distances match
+            if(dim == 1) {
+                d = (REAL) std::abs(x[0] - data[j]);
+            }
+            else {
+                const REAL* y = data + ((unsigned long int) j * dim);
+                d = 0;
+                for(int k=0;k<dim;k++) {
+                    REAL temp = x[k] - y[k];
+                    d += (temp * temp);
+                }
+            }
+            if(d > 0) {
+                m_min = (d < m_min)? d : m_min;
+                m_max = (d > m_max)? d : m_max;
+                long int bin = binOf(d);
+                if((bin < m_first) || (bin >= m_first + (long int) m_counts.size())) {
+                    cover(bin, bin);
+                }
+                m_counts[bin - m_first]++;
+            }
+            else {
+                m_zeros++;
+            }
+        }
+        m_pairs += i;
+        Progress::add(i);
+    }
+    if((m_sets == 1) && (rowBegin < rowEnd)) {
+        addRange(rowBegin, rowEnd);
+    }
+}
+
+void PairSketch::cover(long int lo, long int hi) {
+    long int end = m_first + (long int) m_counts.size();
+    if(m_counts.empty()) {
+        m_first = lo - SKETCH_MARGIN;
+        m_counts.assign(hi - lo + 1 + (2 * SKETCH_MARGIN), 0);
+        return;
+    }
+    if((lo >= m_first) && (hi < end)) {
+        return;
+    }
+    long int first = (lo < m_first)? lo - SKETCH_MARGIN : m_first;
+    long int last = (hi >= end)? hi + SKETCH_MARGIN : end - 1;
+    SketchCounts counts(last - first + 1, 0);
+    for(size_t b=0;b<m_counts.size();b++) {
+        counts[b + (m_first - first)] = m_counts[b];
+    }
+    m_counts.swap(counts);
+    m_first = first;
+}
+
+bool PairSketch::addRange(int rowBegin, int rowEnd) {
+    // first range ending at or after 'rowBegin'
+    size_t r = 0;
+    while((r < m_rows.size()) && (m_rows[r].second < rowBegin)) {
+        r++;
+    }
+    if((r < m_rows.size()) && (m_rows[r].first < rowEnd) && (m_rows[r].second > rowBegin)) {
+        return false;
+    }
+    // adjacent ranges are joined
+    if((r < m_rows.size()) && (m_rows[r].second == rowBegin)) {
+        m_rows[r].second = rowEnd;
+        if((r + 1 < m_rows.size()) && (m_rows[r+1].first == rowEnd)) {
+            m_rows[r].second = m_rows[r+1].second;
+            m_rows.erase(m_rows.begin() + r + 1);
+        }
+    }
+    else if((r < m_rows.size()) && (m_rows[r].first == rowEnd)) {
+        m_rows[r].first = rowBegin;
+    }
+    else {
+        m_rows.insert(m_rows.begin() + r, make_pair(rowBegin, rowEnd));
+    }
+    return true;
+}
+
+string PairSketch::missingRows() const {
+    string missing;
+    if(m_sets != 1) {
+        return missing;
+    }
+    int next = 0;
+    for(size_t r=0;r<=m_rows.size();r++) {
+        int begin = (r < m_rows.size())? m_rows[r].first : m_numVec;
+        if(begin > next) {
+            missing += ((missing == "")? "" : " ") + to_string(next) + "-" + to_string(begin);
+        }
+        next = (r < m_rows.size())? m_rows[r].second : next;
+    }
+    return missing;
+}
+
+
+bool PairSketch::merge(const PairSketch& other) {
+    if((other.m_numVec != m_numVec) || (other.m_squared != m_squared) || (other.m_sets != m_sets)) {
+        m_error = "the sketches are of different data (" + to_string(m_numVec) + " vs " +
+            to_string(other.m_numVec) + " vectors)";
+        return false;
+    }
+    if(m_pairs + other.m_pairs > m_sets * TRI(m_numVec)) {
+        m_error = "the sketches hold more pairs than the data has (do they overlap?)";
+        return false;
+    }
+    if(m_sets == 1) {
+        for(size_t r=0;r<other.m_rows.size();r++) {
+            for(size_t q=0;q<m_rows.size();q++) {
+                if((m_rows[q].first < other.m_rows[r].second) && (m_rows[q].second > other.m_rows[r].first)) {
+                    m_error = "the sketches overlap (both hold rows " +
+                        to_string(max(m_rows[q].first, other.m_rows[r].first)) + "-" +
+                        to_string(min(m_rows[q].second, other.m_rows[r].second)) + ")";
+                    return false;
+                }
+            }
+        }
+        for(size_t r=0;r<other.m_rows.size();r++) {
+            addRange(other.m_rows[r].first, other.m_rows[r].second);
+        }
+    }
+    long int num = (long int) other.m_counts.size();
+    if(num > 0) {
+        cover(other.m_first, other.m_first + num - 1);
+        for(long int b=0;b<num;b++) {
+            m_counts[b + (other.m_first - m_first)] += other.m_counts[b];
+        }
+    }
+    m_pairs += other.m_pairs;
+    m_zeros += other.m_zeros;
+    m_min = (other.m_min < m_min)? other.m_min : m_min;
+    m_max = (other.m_max > m_max)? other.m_max : m_max;
+    return true;
+}
+
+
+bool PairSketch::save(const string& file) {
+    if(m_sets != 1) {
+        m_error = "sketches pooling many sets can't be saved";
+        return false;
+    }
+    FILE* fp = fopen(file.c_str(), "wb");
+    if(fp == NULL) {
+        m_error = "failed to open the file for writing";
+        return false;
+    }
+    // empty bins at either end aren't worth storing
+    size_t lo = 0, hi = m_counts.size();
+    while((lo < hi) && (m_counts[lo] == 0)) {
+        lo++;
+    }
+    while((hi > lo) && (m_counts[hi-1] == 0)) {
+        hi--;
+    }
+    int32_t head[2] = {SKETCH_SUB_BITS, m_squared? 1 : 0};
+    int64_t numVec = m_numVec;
+    uint64_t numRanges = m_rows.size();
+    vector<int64_t> ranges;
+    for(size_t r=0;r<m_rows.size();r++) {
+        ranges.push_back(m_rows[r].first);
+        ranges.push_back(m_rows[r].second);
+    }
+    uint64_t pairs = m_pairs, zeros = m_zeros;
+    int64_t first = m_first + (long int) lo;
+    uint64_t numBins = hi - lo;
+    bool ok = (fwrite(SKETCH_MAGIC, 1, 8, fp) == 8) &&
+        (fwrite(head, sizeof(head), 1, fp) == 1) &&
+        (fwrite(&numVec, sizeof(numVec), 1, fp) == 1) &&
+        (fwrite(&numRanges, sizeof(numRanges), 1, fp) == 1) &&
+        ((numRanges == 0) || (fwrite(&(ranges[0]), sizeof(int64_t), 2 * numRanges, fp) == 2 * numRanges)) &&
+        (fwrite(&pairs, sizeof(pairs), 1, fp) == 1) &&
+        (fwrite(&zeros, sizeof(zeros), 1, fp) == 1) &&
+        (fwrite(&m_min, sizeof(m_min), 1, fp) == 1) &&
+        (fwrite(&m_max, sizeof(m_max), 1, fp) == 1) &&
+        (fwrite(&first, sizeof(first), 1, fp) == 1) &&
+        (fwrite(&numBins, sizeof(numBins), 1, fp) == 1) &&
+        ((numBins == 0) || (fwrite(&(m_counts[lo]), sizeof(uint64_t), numBins, fp) == numBins));
+    ok = (fclose(fp) == 0) && ok;
+    if(!ok) {
+        m_error = "failed to write the file";
+    }
+    return ok;
+}
+
+bool PairSketch::load(const string& file) {
+    reset(0, false);
+    FILE* fp = fopen(file.c_str(), "rb");
+    if(fp == NULL) {
+        m_error = "failed to open the file";
+        return false;
+    }
+    char magic[8];
+    int32_t head[2];
+    int64_t numVec, first;
+    uint64_t numRanges, pairs, zeros, numBins;
+    vector<int64_t> ranges;
+    bool ok = (fread(magic, 1, 8, fp) == 8);
+    if(ok && !memcmp(magic, SKETCH_MAGIC1, 8)) {
+        fclose(fp);
+        m_error = "a sketch of an older format, without its rows (sketch the data again)";
+        return false;
+    }
+    ok = ok && !memcmp(magic, SKETCH_MAGIC, 8) &&
+        (fread(head, sizeof(head), 1, fp) == 1) && (head[0] == SKETCH_SUB_BITS) &&
+        (fread(&numVec, sizeof(numVec), 1, fp) == 1) &&
+        (fread(&numRanges, sizeof(numRanges), 1, fp) == 1) && (numRanges <= (uint64_t) max(numVec, (int64_t) 0));
+    if(ok && (numRanges > 0)) {
+        ranges.resize(2 * numRanges);
+        ok = (fread(&(ranges[0]), sizeof(int64_t), 2 * numRanges, fp) == 2 * numRanges);
+    }
+    ok = ok &&
+        (fread(&pairs, sizeof(pairs), 1, fp) == 1) &&
+        (fread(&zeros, sizeof(zeros), 1, fp) == 1) &&
+        (fread(&m_min, sizeof(m_min), 1, fp) == 1) &&
+        (fread(&m_max, sizeof(m_max), 1, fp) == 1) &&
+        (fread(&first, sizeof(first), 1, fp) == 1) &&
+        (fread(&numBins, sizeof(numBins), 1, fp) == 1) &&
+        (numVec >= 0) && (numVec <= numeric_limits<int>::max()) && (pairs <= TRI(numVec)) &&
+        (numBins <= pairs);
+    // the ranges must be sorted, disjoint, inside the data and hold exactly 'pairs'
+    uint64_t rowPairs = 0;
+    for(size_t r=0;ok && (r<numRanges);r++) {
+        int64_t begin = ranges[2*r], end = ranges[2*r+1];
+        ok = (begin < end) && (end <= numVec) && (begin >= ((r == 0)? 0 : ranges[2*r-1]));
+        rowPairs += ok? TRI(end) - TRI(begin) : 0;
+    }
+    ok = ok && (rowPairs == pairs);
+    if(ok) {
+        m_counts.resize(numBins);
+        ok = (numBins == 0) || (fread(&(m_counts[0]), sizeof(uint64_t), numBins, fp) == numBins);
+    }
+    fclose(fp);
+    if(!ok) {
+        reset(0, false);
+        m_error = "not a sketch file (or a truncated one)";
+        return false;
+    }
+    m_numVec = (int) numVec;
+    m_squared = (head[1] != 0);
+    m_pairs = pairs;
+    m_zeros = zeros;
+    m_first = first;
+    for(size_t r=0;r<numRanges;r++) {
+        addRange((int) ranges[2*r], (int) ranges[2*r+1]);
+    }
+    return true;
+}
+
+
+REAL PairSketch::countBelow(REAL R) const {
+    if(R <= 0) {
+        return 0;
+    }
+    if(R > m_max) {
+        return (REAL) m_pairs;
+    }
+    long int bin = binOf(R);
+    long int last = min(bin - m_first, (long int) m_counts.size());
+    unsigned long int sum = m_zeros;
+    for(long int b=0;b<last;b++) {
+        sum += m_counts[b];
+    }
+    if((bin < m_first) || (last >= (long int) m_counts.size())) {
+        return (REAL) sum;
+    }
+    // the pairs inside the bin of 'R' are taken to be spread uniformly in
+    // log-space between the bin edges (or the min/max, if tighter)
+    REAL lo = max(binEdge(bin), m_min);
+    REAL hi = min(binEdge(bin + 1), m_max);
+    REAL frac = 0;
+    if((R > lo) && (hi > lo)) {
+        frac = min((REAL) (log(R / lo) / log(hi / lo)), (REAL) 1);
+    }
+    return sum + (frac * m_counts[last]);
+}
+
+
+REAL PairSketch::evalCorrDim(int k, int discardl, int discardr,
+                             REAL* log_cr, REAL* log_r, REAL* inter) {
+    REAL min = m_squared? (REAL) sqrt(m_min) : m_min;
+    REAL max = m_squared? (REAL) sqrt(m_max) : m_max;
+    REAL log_min = (REAL) log(min);
+    REAL log_max = (REAL) log(max);
+    REAL div = (REAL) m_numVec * (REAL) m_numVec * m_sets;
+    // evaluate corr-sum for every value of 'R'
+    REAL step = (log_max - log_min) / k;
+    REAL start = log_min + step;
+    for(int i=0;i<k;i++,start+=step) {
+        log_r[i] = start;
+        REAL R = (REAL) exp(start);
+        if(m_squared) {
+            R = R * R;
+        }
+        log_cr[i] = (REAL) log((2 * countBelow(R)) / div);
+    }
+    // least squares
+    REAL c0, c1;
+    int n = k - (discardl + discardr);
+    Metrics::enter(PHASE_FIT);
+    linearLeastSquares(c0, c1, log_r+discardl, log_cr+discardl, n);
+    Metrics::leave();
+    // interpolated values
+    for(int i=0;i<k;i++) {
+        inter[i] = (c0 * log_r[i]) + c1;
+    }
+    return c0;
+}
+
+void PairSketch::getDistMatrixHistogram(int numBins, int* hist, REAL* bins) {
+    REAL min, max, step;
+    min = m_squared? (REAL) sqrt(m_min) : m_min;
+    max = m_squared? (REAL) sqrt(m_max) : m_max;
+    step = (max - min) / numBins;
+    for(int i=0;i<numBins;i++) {
+        bins[i] = min + (i * step);
+        hist[i] = 0;
+    }
+    // every fine bin is shared by the bins it overlaps, in proportion
+    vector<REAL> share(numBins, 0);
+    share[0] = (REAL) m_zeros;
+    for(size_t b=0;b<m_counts.size();b++) {
+        if(m_counts[b] == 0) {
+            continue;
+        }
+        long int bin = m_first + (long int) b;
+        REAL lo = std::max(binEdge(bin), m_min);
+        REAL hi = std::min(binEdge(bin + 1), m_max);
+        if(m_squared) {
+            lo = (REAL) sqrt(lo);
+            hi = (REAL) sqrt(hi);
+        }
+        int first = std::max(0, std::min((int) ((lo - min) / step), numBins - 1));
+        int last = std::max(0, std::min((int) ((hi - min) / step), numBins - 1));
+        for(int loc=first;loc<=last;loc++) {
+            REAL left = (loc == first)? lo : bins[loc];
+            REAL right = (loc == last)? hi : bins[loc] + step;
+            REAL frac = (hi > lo)? (right - left) / (hi - lo) : 1;
+            share[loc] += frac * m_counts[b];
+        }
+    }
+    for(int i=0;i<numBins;i++) {
+        hist[i] = (int) (share[i] + 0.5);
+    }
+}
@@ -0,0 +1,225 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_PAIRSKETCH_H__
+#define __INCLUDED_PAIRSKETCH_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include "ThreadPool.h"
+#include "MemTrack.h"
+
+
+/** mantissa bits kept in the bin index (ie, 2^10 bins per power of 2) */
+#define SKETCH_SUB_BITS  10
+
+
+/** pair counts of the bins, charged to MEM_SKETCH */
+typedef std::vector<unsigned long int, TrackingAllocator<unsigned long int, MEM_SKETCH> > SketchCounts;
+
+
+/**
+ * Compact summary of all the pairwise distances of a set of vectors: a
+ * pair-count histogram over fine logarithmic bins, plus the exact min/max.
+ * From it, 'log_cr', 'log_r', 'inter' and the distance-matrix histogram can
+ * be regenerated for any parameters, without touching the vectors again.
+ *
+ * The bin of a distance is just the top bits of its IEEE-754 representation
+ * (exponent plus SKETCH_SUB_BITS of the mantissa), so the bins don't depend
+ * on the data. Hence, sketches built from disjoint row ranges of the same
+ * vectors (eg: on different machines) can be merged exactly.
+ *
+ * As in 'CorrDim', distances are squared for multi-dimensional vectors.
+ *
+ * A sketch remembers the row ranges it holds, so that merging two sketches
+ * of the same rows (or a merged sketch missing some rows) is caught.
+ *
+ * A sketch can also pool the pairs of many sets of vectors of the same size
+ * (eg: the trajectories of an ensemble), only the pairs inside every set
+ * being counted. The correlation sums are then the averages over the sets.
+ * Such sketches don't track their rows.
+ *
+ * Usage:
+ *  PairSketch s;
+ *  s.reset(numVec, dim > 1);
+ *  s.addPairs(data, numVec, dim, 0, numVec, &pool);
+ *  s.save("data.sketch");
+ */
+class PairSketch {
+public:
+    /**
+     * @brief Constructor of this class. Creates an empty sketch.
+     */
+    PairSketch();
+
+    /**
+     * @brief Empties the sketch
+     * @param numVec number of vectors in the whole data (of every set).
+     * @param squared whether the distances are squared (ie, dim > 1).
+     * @param numSets number of sets whose pairs are pooled. [Defaults to 1]
+     */
+    void reset(int numVec, bool squared, int numSets=1);
+
+    /**
+     * @brief Adds the pairs of the given rows of the distance matrix
+     * @param data the vectors.
+     * @param numVec number of vectors available in 'data'.
+     * @param dim dimension of the vectors.
+     * @param rowBegin first row.
+     * @param rowEnd one past the last row.
+     * @param pool threads to be used (NULL means the calling thread only).
+     *
+     * Row 'i' holds the pairs (i, j) with j < i.
+     */
+    void addPairs(const REAL* data, int numVec, int dim, int rowBegin, int rowEnd, ThreadPool* pool);
+
+    /**
+     * @brief Adds the counts of another sketch of the same data
+     * @param other the other sketch.
+     * @return true on success, else see 'error'
+     *
+     * Fails if both sketches hold some of the same rows.
+     */
+    bool merge(const PairSketch& other);
+
+    /**
+     * @brief Writes the sketch into a file
+     * @param file the file.
+     * @return true on success, else see 'error'
+     *
+     * Only sketches of one set can be saved.
+     */
+    bool save(const std::string& file);
+
+    /**
+     * @brief Reads the sketch from a file
+     * @param file the file.
+     * @return true on success, else see 'error'
+     */
+    bool load(const std::string& file);
+
+    /**
+     * @brief Evaluates the correlation dimension, just like 'CorrDim'
+     * @param k number of points on the log(CR) vs log(R) plot.
+     * @param discardl number of points to be discarded from the left.
+     * @param discardr number of points to be discarded from the right.
+     * @param log_cr log(CR) values (of length 'k').
+     * @param log_r log(R) values (of length 'k').
+     * @param inter interpolated log(CR) values (of length 'k').
+     * @return the correlation dimension
+     */
+    REAL evalCorrDim(int k, int discardl, int discardr, REAL* log_cr, REAL* log_r, REAL* inter);
+
+    /**
+     * @brief Histogram of the distance matrix, just like 'CorrDim'
+     * @param numBins number of bins.
+     * @param hist pair counts (of length 'numBins').
+     * @param bins left edges of the bins (of length 'numBins').
+     */
+    void getDistMatrixHistogram(int numBins, int* hist, REAL* bins);
+
+    /**
+     * @brief Number of pairs added so far
+     * @return the count
+     */
+    unsigned long int numPairs() const { return m_pairs; }
+
+    /**
+     * @brief Whether all the pairs of the data have been added
+     * @return true if complete
+     */
+    bool complete() const { return m_pairs == m_sets * TRI(m_numVec); }
+
+    /**
+     * @brief Row ranges not added yet
+     * @return the ranges, as in "0-1000 2000-3000" (empty if none, or if pooling many sets)
+     */
+    std::string missingRows() const;
+
+    /**
+     * @brief Number of vectors in the whole data
+     * @return the count
+     */
+    int numVectors() const { return m_numVec; }
+
+    /**
+     * @brief Number of sets whose pairs are pooled
+     * @return the count
+     */
+    int numSets() const { return m_sets; }
+
+    /**
+     * @brief Error message of the last failed call
+     * @return the message
+     */
+    const std::string& error() const { return m_error; }
+
+private:
+    /**
+     * @brief Adds the pairs of the given rows, on the calling thread
+     * @param data the vectors.
+     * @param dim dimension of the vectors.
+     * @param rowBegin first row.
+     * @param rowEnd one past the last row.
+     */
+    void addRows(const REAL* data, int dim, int rowBegin, int rowEnd);
+
+    /**
+     * @brief Makes sure that the bins [lo, hi] are stored
+     * @param lo first bin.
+     * @param hi last bin.
+     */
+    void cover(long int lo, long int hi);
+
+    /**
+     * @brief Records that the given rows have been added
+     * @param rowBegin first row.
+     * @param rowEnd one past the last row.
+     * @return false if some of them were already there
+     */
+    bool addRange(int rowBegin, int rowEnd);
+
+    /**
+     * @brief Number of pairs whose (raw) distance is below 'R'
+     * @param R the (raw) distance.
+     * @return the count, interpolated inside the bin holding 'R'
+     */
+    REAL countBelow(REAL R) const;
+
+private:
+    int m_numVec;                            ///< vectors in the whole data
+    bool m_squared;                          ///< whether the distances are squared
+    int m_sets;                              ///< sets whose pairs are pooled
+    unsigned long int m_pairs;               ///< pairs added so far
+    unsigned long int m_zeros;               ///< pairs at distance 0
+    REAL m_min;                              ///< smallest non-zero distance
+    REAL m_max;                              ///< largest distance
+    long int m_first;                        ///< bin of 'm_counts[0]'
+    SketchCounts m_counts;                   ///< pairs in every bin
+    std::vector<std::pair<int,int> > m_rows; ///< row ranges added so far (sorted, disjoint)
+    std::string m_error;                     ///< error message
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_PAIRSKETCH_H__
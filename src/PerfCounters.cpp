@@ -0,0 +1,106 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "PerfCounters.h"
+#include <errno.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+
+using namespace std;
+
+
+PerfCounters::PerfCounters() {
+    for(int e=0;e<PERF_NUM_EVENTS;e++) {
+        m_fd[e] = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for(int e=0;e<PERF_NUM_EVENTS;e++) {
+        if(m_fd[e] >= 0) {
+            close(m_fd[e]);
+        }
+    }
+}
+
+const char* PerfCounters::eventName(int e) {
+    static const char* names[PERF_NUM_EVENTS] = {"cycles", "instructions", "llcMisses",
+                                                 "branchMisses"};
+    return names[e];
+}
+
+
+bool PerfCounters::open() {
+#ifdef __linux__
+    static const unsigned long long configs[PERF_NUM_EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES};
+    int opened = 0;
+    for(int e=0;e<PERF_NUM_EVENTS;e++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // the worker threads are spawned later on, they must be counted too.
+        // (This rules out reading all the events as one group.)
+        attr.inherit = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        m_fd[e] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if(m_fd[e] >= 0) {
+            opened++;
+        }
+        else if(m_error == "") {
+            m_error = string("perf_event_open failed for '") + eventName(e) + "': " + strerror(errno);
+        }
+    }
+    if(opened > 0) {
+        m_error = "";
+    }
+    return opened > 0;
+#else
+    m_error = "performance counters are supported only on Linux";
+    return false;
+#endif
+}
+
+
+void PerfCounters::read(unsigned long long* values) const {
+    for(int e=0;e<PERF_NUM_EVENTS;e++) {
+        // value, time enabled and time running
+        unsigned long long buf[3];
+        values[e] = 0;
+        if((m_fd[e] < 0) || (::read(m_fd[e], buf, sizeof(buf)) != sizeof(buf))) {
+            continue;
+        }
+        if((buf[2] > 0) && (buf[2] < buf[1])) {
+            values[e] = (unsigned long long) ((double) buf[0] * buf[1] / buf[2]);
+        }
+        else {
+            values[e] = buf[0];
+        }
+    }
+}
@@ -0,0 +1,111 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_PERFCOUNTERS_H__
+#define __INCLUDED_PERFCOUNTERS_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+
+
+/** CPU cycles */
+#define PERF_CYCLES        0
+/** instructions retired */
+#define PERF_INSTRUCTIONS  1
+/** misses of the last level cache */
+#define PERF_LLC_MISSES    2
+/** mispredicted branches */
+#define PERF_BRANCH_MISSES 3
+/** number of the above events */
+#define PERF_NUM_EVENTS    4
+
+
+/**
+ * Hardware performance counters of the whole process, using 'perf_event_open'
+ * (Linux only). Only user-space events are counted, which is what an
+ * unprivileged process is allowed to, and the threads started after 'open'
+ * are counted too. Events which the CPU (or the VM, or the kernel settings)
+ * doesn't support are simply left out.
+ *
+ * Usage:
+ *  PerfCounters pc;
+ *  if(!pc.open()) printf("%s\n", pc.error().c_str());
+ *  unsigned long long before[PERF_NUM_EVENTS], after[PERF_NUM_EVENTS];
+ *  pc.read(before);
+ *  ...
+ *  pc.read(after);
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Constructor of this class. Nothing is counted till 'open'.
+     */
+    PerfCounters();
+
+    /**
+     * @brief Destructor of this class. Closes the counters.
+     */
+    ~PerfCounters();
+
+    /**
+     * @brief Starts counting
+     * @return false if none of the events can be counted (see 'error')
+     */
+    bool open();
+
+    /**
+     * @brief Whether an event is being counted
+     * @param e the event (one of the PERF_* above)
+     * @return true if it is
+     */
+    bool available(int e) const { return m_fd[e] >= 0; }
+
+    /**
+     * @brief Reads all the counters
+     * @param values the counts since 'open', one per event (output). They
+     *  are scaled up in case the kernel had to multiplex the counters, and
+     *  are 0 for the events not counted.
+     */
+    void read(unsigned long long* values) const;
+
+    /**
+     * @brief Name of an event, as it appears in the reports
+     * @param e the event
+     * @return the name
+     */
+    static const char* eventName(int e);
+
+    /**
+     * @brief Why 'open' failed
+     * @return the message
+     */
+    const std::string& error() const { return m_error; }
+
+private:
+    int m_fd[PERF_NUM_EVENTS];   ///< one counter per event (-1 if not counted)
+    std::string m_error;         ///< error message
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_PERFCOUNTERS_H__
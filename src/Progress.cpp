@@ -0,0 +1,122 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Progress.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+using namespace std;
+
+
+atomic<unsigned long int> Progress::s_done(0);
+atomic<unsigned long int> Progress::s_total(0);
+atomic<const char*> Progress::s_pass(NULL);
+atomic<double> Progress::s_start(0);
+
+/** the reporter thread */
+static thread s_reporter;
+/** seconds between two reports */
+static int s_interval = PROGRESS_INTERVAL;
+/** status file (empty means stderr) */
+static string s_file;
+/** whether the reporter must exit */
+static bool s_quit = false;
+/** guards 's_quit' */
+static mutex s_lock;
+/** wakes up the reporter when it must exit */
+static condition_variable s_wake;
+
+
+void Progress::begin(const char* pass, unsigned long int total) {
+    s_done.store(0, memory_order_relaxed);
+    s_total.store(total, memory_order_relaxed);
+    s_start.store(wallTime(), memory_order_relaxed);
+    s_pass.store(pass, memory_order_release);
+}
+
+
+void Progress::startReporter(int interval, const string& file) {
+    s_interval = interval;
+    s_file = file;
+    s_quit = false;
+    s_reporter = thread(&Progress::reporterLoop);
+    // a joinable thread must not be destroyed, even on 'exit'
+    atexit(&Progress::stopReporter);
+}
+
+void Progress::stopReporter() {
+    if(!s_reporter.joinable()) {
+        return;
+    }
+    {
+        lock_guard<mutex> lk(s_lock);
+        s_quit = true;
+    }
+    s_wake.notify_one();
+    s_reporter.join();
+    if(s_file != "") {
+        report(true);
+    }
+}
+
+void Progress::reporterLoop() {
+    unique_lock<mutex> lk(s_lock);
+    while(!s_wake.wait_for(lk, chrono::seconds(s_interval), [] { return s_quit; })) {
+        report(false);
+    }
+}
+
+
+void Progress::report(bool final) {
+    const char* pass = s_pass.load(memory_order_acquire);
+    if(pass == NULL) {
+        return;
+    }
+    unsigned long int done = s_done.load(memory_order_relaxed);
+    unsigned long int total = s_total.load(memory_order_relaxed);
+    REAL elapsed = wallTime() - s_start.load(memory_order_relaxed);
+    REAL rate = (elapsed > 0)? done / elapsed : 0;
+    // the ETA of the current pass only, the later ones aren't known yet
+    REAL eta = ((rate > 0) && (total > done))? (total - done) / rate : 0;
+    REAL percent = (total > 0)? (100.0 * done) / total : 0;
+    if(s_file == "") {
+        if(total > 0) {
+            fprintf(stderr, "PROGRESS: %s %.1f%% (%lu of %lu pairs) %.3g pairs/s ETA %.0f s\n",
+                    pass, percent, done, total, rate, eta);
+        }
+        else {
+            fprintf(stderr, "PROGRESS: %s running for %.0f s\n", pass, elapsed);
+        }
+        return;
+    }
+    // replaced atomically, so that the job monitor never sees half a file
+    string tmp = s_file + ".tmp";
+    FILE* fp = fopen(tmp.c_str(), "w");
+    if(fp == NULL) {
+        return;
+    }
+    fprintf(fp, "{\"pass\": \"%s\", \"done\": %lu, \"total\": %lu, \"percent\": %.3f, "
+            "\"pairsPerSec\": %.1f, \"eta\": %.1f, \"elapsed\": %.1f, \"finished\": %s}\n",
+            pass, done, total, percent, rate, eta, elapsed, final? "true" : "false");
+    fclose(fp);
+    rename(tmp.c_str(), s_file.c_str());
+}
@@ -0,0 +1,104 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_PROGRESS_H__
+#define __INCLUDED_PROGRESS_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <atomic>
+
+
+/** default number of seconds between two progress reports */
+#define PROGRESS_INTERVAL  5
+
+
+/**
+ * Progress of the current pass over the pairs, for long runs.
+ *
+ * The engines add the pairs they are done with once per row, with a relaxed
+ * atomic add, which costs nothing next to the row itself. The caller marks
+ * the start of every pass (along with the number of pairs in it), and a
+ * reporter thread periodically prints the progress, the pairs per second and
+ * the ETA on stderr, or writes them (as JSON) into a status file.
+ *
+ * Usage:
+ *  Progress::startReporter(5, "");
+ *  Progress::begin("corrsum", numPairs);
+ *  ... engine calling Progress::add(i) after every row 'i' ...
+ *  Progress::stopReporter();
+ */
+class Progress {
+public:
+    /**
+     * @brief Starts a new pass
+     * @param pass name of the pass. It must stay valid till the next call
+     *  (eg: a string literal).
+     * @param total pairs in the pass (0 if unknown).
+     */
+    static void begin(const char* pass, unsigned long int total);
+
+    /**
+     * @brief Adds to the pairs done in the current pass
+     * @param pairs the pairs
+     */
+    static void add(unsigned long int pairs) {
+        s_done.fetch_add(pairs, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Starts the reporter thread
+     * @param interval seconds between two reports.
+     * @param file status file to be rewritten on every report. Empty means
+     *  print the reports on stderr instead.
+     */
+    static void startReporter(int interval, const std::string& file);
+
+    /**
+     * @brief Stops the reporter thread, if any. The status file gets its
+     *  final report.
+     */
+    static void stopReporter();
+
+private:
+    /**
+     * @brief Prints (or writes) one report
+     * @param final whether the run is over.
+     */
+    static void report(bool final);
+
+    /**
+     * @brief Body of the reporter thread
+     */
+    static void reporterLoop();
+
+private:
+    static std::atomic<unsigned long int> s_done;   ///< pairs done in the current pass
+    static std::atomic<unsigned long int> s_total;  ///< pairs in the current pass
+    static std::atomic<const char*> s_pass;         ///< name of the current pass
+    static std::atomic<double> s_start;             ///< wall time when it began
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_PROGRESS_H__
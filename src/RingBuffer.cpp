@@ -0,0 +1,100 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "RingBuffer.h"
+#include "MemTrack.h"
+
+
+
+
+RingBuffer::RingBuffer(int numSlots, size_t slotBytes) {
+    m_slotBytes = slotBytes;
+    for(int i=0;i<numSlots;i++) {
+        m_slots.push_back(MemTrack::allocate<char>(slotBytes, MEM_IO));
+    }
+    m_lens.assign(numSlots, 0);
+    m_head = 0;
+    m_tail = 0;
+    m_finished = false;
+    m_cancelled = false;
+}
+
+
+RingBuffer::~RingBuffer() {
+    for(size_t i=0;i<m_slots.size();i++) {
+        MemTrack::release(m_slots[i]);
+    }
+}
+
+
+char* RingBuffer::acquire() {
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_notFull.wait(lk, [&] { return m_cancelled || ((m_head - m_tail) < m_slots.size()); });
+    return m_cancelled? NULL : m_slots[m_head % m_slots.size()];
+}
+
+
+void RingBuffer::publish(size_t len) {
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_lens[m_head % m_slots.size()] = len;
+        m_head++;
+    }
+    m_notEmpty.notify_one();
+}
+
+
+void RingBuffer::finish() {
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_finished = true;
+    }
+    m_notEmpty.notify_one();
+}
+
+
+const char* RingBuffer::next(size_t& len) {
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_notEmpty.wait(lk, [&] { return m_cancelled || m_finished || (m_head > m_tail); });
+    if(m_cancelled || (m_head == m_tail)) {
+        return NULL;
+    }
+    len = m_lens[m_tail % m_slots.size()];
+    return m_slots[m_tail % m_slots.size()];
+}
+
+
+void RingBuffer::release() {
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_tail++;
+    }
+    m_notFull.notify_one();
+}
+
+
+void RingBuffer::cancel() {
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_cancelled = true;
+    }
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+}
@@ -0,0 +1,113 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_RINGBUFFER_H__
+#define __INCLUDED_RINGBUFFER_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <condition_variable>
+#include <mutex>
+
+
+/**
+ * Bounded queue of fixed size blocks, handed over in order from one
+ * producer thread to one consumer thread. The blocks are allocated once and
+ * recycled, so the producer can run ahead of the consumer by at most
+ * 'numSlots' blocks.
+ *
+ * Usage:
+ *  RingBuffer ring(8, 1 << 20);
+ *  producer:  while((blk = ring.acquire()) != NULL) { fill; ring.publish(len); } ring.finish();
+ *  consumer:  while((blk = ring.next(len)) != NULL) { use; ring.release(); }
+ */
+class RingBuffer {
+public:
+    /**
+     * @brief Constructor of this class.
+     * @param numSlots number of blocks.
+     * @param slotBytes size of every block (in B).
+     */
+    RingBuffer(int numSlots, size_t slotBytes);
+
+    /**
+     * @brief Destructor of this class. Frees the blocks.
+     */
+    ~RingBuffer();
+
+    /**
+     * @brief Size of every block
+     * @return the size (in B)
+     */
+    size_t slotBytes() const { return m_slotBytes; }
+
+    /**
+     * @brief Next free block for the producer. Waits while all are full.
+     * @return the block, NULL if the consumer has cancelled
+     */
+    char* acquire();
+
+    /**
+     * @brief Hands over the block got from 'acquire' to the consumer
+     * @param len number of bytes filled in.
+     */
+    void publish(size_t len);
+
+    /**
+     * @brief Tells the consumer that no more blocks will come
+     */
+    void finish();
+
+    /**
+     * @brief Next full block for the consumer. Waits while all are empty.
+     * @param len will contain the number of bytes in the block.
+     * @return the block, NULL once the producer has finished (or on cancel)
+     */
+    const char* next(size_t& len);
+
+    /**
+     * @brief Gives back the block got from 'next' to the producer
+     */
+    void release();
+
+    /**
+     * @brief Stops both the sides. Waiting calls return NULL right away.
+     */
+    void cancel();
+
+private:
+    std::vector<char*> m_slots;        ///< the blocks
+    std::vector<size_t> m_lens;        ///< bytes filled in every block
+    size_t m_slotBytes;                ///< size of every block
+    unsigned long int m_head;          ///< blocks published so far
+    unsigned long int m_tail;          ///< blocks released so far
+    bool m_finished;                   ///< whether the producer is done
+    bool m_cancelled;                  ///< whether the pipeline was stopped
+    std::mutex m_lock;                 ///< guards the fields above
+    std::condition_variable m_notFull; ///< signals a released block
+    std::condition_variable m_notEmpty;///< signals a published block
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_RINGBUFFER_H__
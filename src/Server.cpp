@@ -0,0 +1,359 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Server.h"
+#include "cmdline.h"
+#include "Timer.h"
+#include "SysInfo.h"
+#include <cerrno>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+
+using namespace std;
+
+
+struct Server::Connection {
+    int inFd;          ///< jobs are read from here
+    int outFd;         ///< answers are written here
+    bool owned;        ///< whether the fds are to be closed at the end
+    std::mutex lock;   ///< serializes the answers
+
+    Connection(int in, int out, bool own): inFd(in), outFd(out), owned(own) {}
+
+    ~Connection() {
+        if(owned) {
+            close(inFd);
+            if(outFd != inFd) {
+                close(outFd);
+            }
+        }
+    }
+
+    /**
+     * @brief Writes one answer line
+     * @param line the answer (without the trailing newline)
+     */
+    void answer(const string& line) {
+        string buf = line + "\n";
+        lock_guard<std::mutex> lk(lock);
+        size_t done = 0;
+        while(done < buf.size()) {
+            ssize_t n = send(outFd, buf.c_str() + done, buf.size() - done, MSG_NOSIGNAL);
+            // not a socket, fall back to plain write
+            if((n < 0) && (errno == ENOTSOCK)) {
+                n = write(outFd, buf.c_str() + done, buf.size() - done);
+            }
+            if(n <= 0) {
+                return;   // the other end has gone away, nobody to answer
+            }
+            done += n;
+        }
+    }
+};
+
+
+/**
+ * @brief Appends the array to the answer as 'key=a,b,c'
+ * @param out the answer.
+ * @param key name of the array.
+ * @param arr the array.
+ * @param n number of elements.
+ */
+template <typename T>
+static void appendArray(ostringstream& out, const char* key, const T* arr, int n) {
+    out << " " << key << "=";
+    for(int i=0;i<n;i++) {
+        out << ((i > 0)? "," : "") << arr[i];
+    }
+}
+
+
+Server::Server(int numWorkers) {
+    m_busy = 0;
+    m_quit = false;
+    for(int i=0;i<numWorkers;i++) {
+        m_workers.push_back(thread(&Server::workerLoop, this, i));
+    }
+}
+
+
+Server::~Server() {
+    waitIdle();
+    {
+        lock_guard<mutex> lk(m_lock);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for(size_t i=0;i<m_workers.size();i++) {
+        m_workers[i].join();
+    }
+}
+
+
+void Server::waitIdle() {
+    unique_lock<mutex> lk(m_lock);
+    m_idle.wait(lk, [&] { return m_queue.empty() && (m_busy == 0); });
+}
+
+
+void Server::workerLoop(int id) {
+    // a bad job must not bring down the whole server
+    throwOnFatal(true);
+    CorrDimResult result;
+    CorrDimArena arena;
+    while(true) {
+        Job job;
+        {
+            unique_lock<mutex> lk(m_lock);
+            m_wake.wait(lk, [&] { return m_quit || !m_queue.empty(); });
+            if(m_queue.empty()) {
+                return;
+            }
+            job = m_queue.front();
+            m_queue.pop_front();
+            m_busy++;
+        }
+        job.conn->answer(runJob(job, result, arena));
+        job.conn.reset();
+        {
+            lock_guard<mutex> lk(m_lock);
+            m_busy--;
+        }
+        m_idle.notify_all();
+    }
+}
+
+
+string Server::runJob(const Job& job, CorrDimResult& result, CorrDimArena& arena) {
+    istringstream iss(job.line);
+    string tok, id = job.id, mapName = DEFAULT_MAP, engine = "auto";
+    int numEle = NUM_ELEMENTS, maxMem = 0;
+    CorrDimParams params;
+    corrDimDefaults(params);
+    vector<string> mapArgs;
+    string err = "";
+    while(iss >> tok) {
+        if(tok == "--") {
+            while(iss >> tok) {
+                mapArgs.push_back(tok);
+            }
+            break;
+        }
+        size_t eq = tok.find('=');
+        string key = tok.substr(0, eq);
+        string val = (eq == string::npos)? "" : tok.substr(eq + 1);
+        bool ok = true;
+        if(key == "id")             id = val;
+        else if(key == "map")       mapName = val;
+        else if(key == "engine")    engine = val;
+        else if(key == "numele")    ok = from_string<int>(numEle, val) && (numEle > 1);
+        else if(key == "numpts")    ok = from_string<int>(params.numPts, val);
+        else if(key == "discardl")  ok = from_string<int>(params.discardl, val);
+        else if(key == "discardr")  ok = from_string<int>(params.discardr, val);
+        else if(key == "numbins")   ok = from_string<int>(params.numBins, val);
+        else if(key == "maxmem")    ok = from_string<int>(maxMem, val) && (maxMem > 0);
+        else                        ok = false;
+        if(!ok && (err == "")) {
+            err = "bad job field '" + tok + "'";
+        }
+    }
+    ostringstream out;
+    out << "id=" << id;
+    if((err == "") && !parseEngine(engine, params.engine)) {
+        err = "bad engine '" + engine + "'";
+    }
+    for(size_t i=0;(err=="")&&(i<mapArgs.size());i++) {
+        if(mapArgs[i] == "-help") {
+            err = "'-help' is not supported for the maps in this mode";
+        }
+    }
+    ChaoticMap* map = (err == "")? MapRegistry::create(mapName) : NULL;
+    if((err == "") && (map == NULL)) {
+        err = "bad map name '" + mapName + "'";
+    }
+    if(err != "") {
+        out << " status=error msg=" << err;
+        return out.str();
+    }
+    // without 'maxmem', every worker gets an equal share of the memory, as
+    // the jobs run concurrently
+    params.maxMem = (maxMem > 0)? (unsigned long int) maxMem << 20 :
+        (unsigned long int) (availableMemory() * MEM_SAFETY) / m_workers.size();
+    // maps reading files only know their dimension once they've read them
+    unsigned long int vecBytes = (unsigned long int) numEle * max(map->getDimension(), 1) * sizeof(REAL);
+    if((params.maxMem > 0) && (vecBytes > params.maxMem)) {
+        delete map;
+        out << " status=error msg=the vectors need " << (vecBytes >> 10)
+            << "kB, more than the memory budget of " << (params.maxMem >> 10) << "kB";
+        return out.str();
+    }
+    Timer tim;
+    tim.start();
+    REAL* arr = NULL;
+    try {
+        vector<char*> argv;
+        for(size_t i=0;i<mapArgs.size();i++) {
+            argv.push_back(&(mapArgs[i][0]));
+        }
+        argv.push_back(NULL);
+        arr = map->generateVectors(numEle, 0, (int) mapArgs.size(), &(argv[0]));
+        // the library needs all the vectors upfront
+        if(map->getStream() != NULL) {
+            map->getStream()->require(numEle);
+        }
+    }
+    catch(FatalError&) {
+        delete map;
+        out << " status=error msg=bad options for the map '" << mapName << "' (see the server log)";
+        return out.str();
+    }
+    catch(bad_alloc&) {
+        delete map;
+        out << " status=error msg=out of memory while generating the vectors";
+        return out.str();
+    }
+    catch(exception& e) {
+        delete map;
+        out << " status=error msg=failed to generate the vectors (" << e.what() << ")";
+        return out.str();
+    }
+    CorrDimView view = { arr, numEle, map->getDimension() };
+    CorrDimStatus st = corrDimEvaluate(view, params, result, NULL, &arena);
+    map->releaseVectors(arr);
+    delete map;
+    tim.stop();
+    if(st != CORRDIM_OK) {
+        out << " status=error msg=" << corrDimError(st);
+        return out.str();
+    }
+    out << " status=ok dimension=" << result.dimension
+        << " engine=" << engineName(result.engine)
+        << " numele=" << numEle << " time=" << tim.report();
+    appendArray(out, "log_r", &(result.log_r[0]), params.numPts);
+    appendArray(out, "log_cr", &(result.log_cr[0]), params.numPts);
+    appendArray(out, "inter", &(result.inter[0]), params.numPts);
+    appendArray(out, "bins", &(result.bins[0]), params.numBins);
+    appendArray(out, "hist", &(result.hist[0]), params.numBins);
+    return out.str();
+}
+
+
+bool Server::readJobs(shared_ptr<Connection> conn) {
+    char buf[4096];
+    string pending;
+    int lineNum = 0;
+    ssize_t n;
+    while((n = read(conn->inFd, buf, sizeof(buf))) > 0) {
+        pending.append(buf, n);
+        size_t nl;
+        while((nl = pending.find('\n')) != string::npos) {
+            string line = pending.substr(0, nl);
+            pending.erase(0, nl + 1);
+            lineNum++;
+            if(line.find_first_not_of(" \t\r") == string::npos) {
+                continue;
+            }
+            if(line.substr(0, 4) == "quit") {
+                return false;
+            }
+            Job job;
+            job.line = line;
+            job.id = to_string(lineNum);
+            job.conn = conn;
+            {
+                lock_guard<mutex> lk(m_lock);
+                m_queue.push_back(job);
+            }
+            m_wake.notify_one();
+        }
+    }
+    return true;
+}
+
+
+void Server::serveStdin() {
+    // only the answers go to stdout, rest of the chatter goes to stderr
+    fflush(stdout);
+    int out = dup(1);
+    dup2(2, 1);
+    shared_ptr<Connection> conn(new Connection(0, out, false));
+    readJobs(conn);
+    waitIdle();
+    conn.reset();
+    close(out);
+}
+
+
+void Server::serveSocket(const string& path) {
+    signal(SIGPIPE, SIG_IGN);
+    int lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if((lfd < 0) || (path.size() >= sizeof(addr.sun_path))) {
+        fprintf(stderr, "Failed to create the socket '%s'!\n", path.c_str());
+        exit(1);
+    }
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if((bind(lfd, (sockaddr*) &addr, sizeof(addr)) != 0) || (listen(lfd, 64) != 0)) {
+        fprintf(stderr, "Failed to listen on the socket '%s'!\n", path.c_str());
+        exit(1);
+    }
+    fprintf(stdout, "Listening for jobs on '%s'...\n", path.c_str());
+    fflush(stdout);
+    vector<thread> readers;
+    vector<weak_ptr<Connection> > conns;
+    mutex connLock;
+    int fd;
+    while((fd = accept(lfd, NULL, NULL)) >= 0) {
+        shared_ptr<Connection> conn(new Connection(fd, fd, true));
+        {
+            lock_guard<mutex> lk(connLock);
+            conns.push_back(conn);
+        }
+        readers.push_back(thread([this, conn, lfd] {
+            if(!readJobs(conn)) {
+                // 'quit' received, stop accepting new connections
+                shutdown(lfd, SHUT_RDWR);
+            }
+        }));
+    }
+    // stop reading from the clients which are still connected
+    {
+        lock_guard<mutex> lk(connLock);
+        for(size_t i=0;i<conns.size();i++) {
+            shared_ptr<Connection> conn = conns[i].lock();
+            if(conn) {
+                shutdown(conn->inFd, SHUT_RD);
+            }
+        }
+    }
+    for(size_t i=0;i<readers.size();i++) {
+        readers[i].join();
+    }
+    waitIdle();
+    close(lfd);
+    unlink(path.c_str());
+    fprintf(stdout, "Server stopped.\n");
+}
@@ -0,0 +1,132 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_SERVER_H__
+#define __INCLUDED_SERVER_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include "libcorrdim.h"
+#include <deque>
+#include <memory>
+
+
+/**
+ * Long running mode of 'corrdim' (see '-serve'). Jobs arrive as lines of
+ * text, either on stdin or on the connections to a Unix-domain socket, and
+ * are run concurrently by a fixed set of worker threads, one job per worker
+ * (the engines don't spread a job over more threads). Every worker keeps its
+ * result buffers and the scratch memory of the engines across jobs. Every job is answered with exactly one
+ * line, on the same stream it arrived on. Since jobs run concurrently, the
+ * answers may come out of order; match them using the 'id'.
+ *
+ * Job format (all keys are optional, defaults are those of the commandline):
+ *  id=<id> map=<map> numele=<ele> numpts=<pts> discardl=<pts> discardr=<pts>
+ *  numbins=<bins> engine=<eng> maxmem=<mb> [-- <options for the map>]
+ *
+ * Answer format:
+ *  id=<id> status=ok dimension=<d> engine=<eng> numele=<ele> time=<s>
+ *  log_r=<a,b,..> log_cr=<..> inter=<..> bins=<..> hist=<..>
+ *  OR
+ *  id=<id> status=error msg=<message till the end of the line>
+ *
+ * A line containing just 'quit' stops the server.
+ */
+class Server {
+public:
+    /**
+     * @brief Constructor. Spawns the workers.
+     * @param numWorkers number of jobs that can run concurrently.
+     */
+    Server(int numWorkers);
+
+    /**
+     * @brief Destructor. Waits for the pending jobs and joins the workers.
+     */
+    ~Server();
+
+    /**
+     * @brief Reads jobs from stdin and answers them on stdout, till EOF
+     *
+     * Whatever the maps and the engines print is redirected to stderr, so
+     * that stdout only contains the answers.
+     */
+    void serveStdin();
+
+    /**
+     * @brief Listens on a Unix-domain socket, till a 'quit' job arrives
+     * @param path path of the socket (an existing file here is removed!)
+     */
+    void serveSocket(const std::string& path);
+
+private:
+    /** one stream on which jobs arrive and answers leave */
+    struct Connection;
+
+    /** one pending job */
+    struct Job {
+        std::string line;                  ///< the job request
+        std::string id;                    ///< default id (line number)
+        std::shared_ptr<Connection> conn;  ///< where to answer
+    };
+
+    /**
+     * @brief Reads the jobs from one stream, till EOF or 'quit'
+     * @param conn the stream.
+     * @return false if a 'quit' was received.
+     */
+    bool readJobs(std::shared_ptr<Connection> conn);
+
+    /**
+     * @brief Main loop of the workers
+     * @param id index of this worker
+     */
+    void workerLoop(int id);
+
+    /**
+     * @brief Runs one job
+     * @param job the job.
+     * @param result reusable buffers of this worker.
+     * @param arena reusable scratch memory of this worker.
+     * @return the answer (without the trailing newline)
+     */
+    std::string runJob(const Job& job, CorrDimResult& result, CorrDimArena& arena);
+
+    /**
+     * @brief Waits till all the queued jobs are answered
+     */
+    void waitIdle();
+
+private:
+    std::vector<std::thread> m_workers;  ///< the workers
+    std::deque<Job> m_queue;             ///< jobs yet to be picked up
+    int m_busy;                          ///< jobs being run right now
+    bool m_quit;                         ///< whether the workers must exit
+    std::mutex m_lock;                   ///< guards the fields above
+    std::condition_variable m_wake;      ///< signals a new job (or quit)
+    std::condition_variable m_idle;      ///< signals completion of a job
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_SERVER_H__
@@ -0,0 +1,182 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "SysInfo.h"
+#include <sched.h>
+#include <unistd.h>
+#include <sys/sysinfo.h>
+#include <sys/resource.h>
+
+
+using namespace std;
+
+
+/**
+ * @brief Reads the first number from the given file
+ * @param file the file to be read.
+ * @param val will contain the number.
+ * @return false if the file could not be read or doesn't start with a number
+ *
+ * cgroup files contain the word 'max' when there's no limit. That is also
+ * treated as a failure.
+ */
+static bool readNumber(const char* file, unsigned long int& val) {
+    FILE* fp = fopen(file, "r");
+    if(fp == NULL) {
+        return false;
+    }
+    bool ok = (fscanf(fp, "%lu", &val) == 1);
+    fclose(fp);
+    return ok;
+}
+
+/**
+ * @brief Headroom left inside the cgroup memory limit
+ * @param val will contain the number of bytes.
+ * @return false if there's no limit
+ */
+static bool cgroupMemory(unsigned long int& val) {
+    unsigned long int limit, usage;
+    // cgroup v2
+    if(readNumber("/sys/fs/cgroup/memory.max", limit) &&
+       readNumber("/sys/fs/cgroup/memory.current", usage)) {
+        val = (usage < limit)? limit - usage : 0;
+        return true;
+    }
+    // cgroup v1 (an unlimited group reports a huge number here)
+    if(readNumber("/sys/fs/cgroup/memory/memory.limit_in_bytes", limit) &&
+       readNumber("/sys/fs/cgroup/memory/memory.usage_in_bytes", usage)) {
+        val = (usage < limit)? limit - usage : 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Reads a field (in kB) of /proc/self/status
+ * @param field the field, along with its ':' (eg: 'VmRSS:').
+ * @return number of bytes (0 if not found)
+ */
+static unsigned long int statusMemory(const char* field) {
+    unsigned long int val = 0;
+    FILE* fp = fopen("/proc/self/status", "r");
+    if(fp == NULL) {
+        return 0;
+    }
+    size_t len = strlen(field);
+    char line[256];
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        unsigned long int kb;
+        if(!strncmp(line, field, len) && (sscanf(line + len, "%lu", &kb) == 1)) {
+            val = kb << 10;
+            break;
+        }
+    }
+    fclose(fp);
+    return val;
+}
+
+unsigned long int availableMemory() {
+    unsigned long int avail = 0;
+    FILE* fp = fopen("/proc/meminfo", "r");
+    if(fp != NULL) {
+        char line[256];
+        while(fgets(line, sizeof(line), fp) != NULL) {
+            unsigned long int kb;
+            if(sscanf(line, "MemAvailable: %lu kB", &kb) == 1) {
+                avail = kb << 10;
+                break;
+            }
+        }
+        fclose(fp);
+    }
+    if(avail == 0) {
+        struct sysinfo si;
+        if(sysinfo(&si) == 0) {
+            avail = ((unsigned long int) si.freeram + si.bufferram) * si.mem_unit;
+        }
+    }
+    unsigned long int cg;
+    if(cgroupMemory(cg) && ((avail == 0) || (cg < avail))) {
+        avail = cg;
+    }
+    return avail;
+}
+
+int numCores() {
+    int cores = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+        int aff = CPU_COUNT(&set);
+        if((aff > 0) && (aff < cores)) {
+            cores = aff;
+        }
+    }
+    // cgroup v2 quota is of the form '<quota> <period>' or 'max <period>'
+    FILE* fp = fopen("/sys/fs/cgroup/cpu.max", "r");
+    if(fp != NULL) {
+        unsigned long int quota, period;
+        if((fscanf(fp, "%lu %lu", &quota, &period) == 2) && (period > 0)) {
+            int q = (int) ((quota + period - 1) / period);
+            if((q > 0) && (q < cores)) {
+                cores = q;
+            }
+        }
+        fclose(fp);
+    }
+    return (cores < 1)? 1 : cores;
+}
+
+
+unsigned long int residentMemory() {
+    return statusMemory("VmRSS:");
+}
+
+unsigned long int peakResidentMemory() {
+    unsigned long int peak = statusMemory("VmHWM:");
+    struct rusage ru;
+    if(getrusage(RUSAGE_SELF, &ru) == 0) {
+        // in kB on Linux
+        unsigned long int maxrss = (unsigned long int) ru.ru_maxrss << 10;
+        peak = (maxrss > peak)? maxrss : peak;
+    }
+    return peak;
+}
+
+string cpuModel() {
+    FILE* fp = fopen("/proc/cpuinfo", "r");
+    if(fp == NULL) {
+        return "unknown";
+    }
+    string model = "unknown";
+    char line[512];
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        char* colon = strchr(line, ':');
+        if((strncmp(line, "model name", 10) == 0) && (colon != NULL)) {
+            model = colon + 1;
+            model.erase(0, model.find_first_not_of(" \t"));
+            model.erase(model.find_last_not_of(" \t\n") + 1);
+            break;
+        }
+    }
+    fclose(fp);
+    return model;
+}
@@ -0,0 +1,76 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_SYSINFO_H__
+#define __INCLUDED_SYSINFO_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+
+
+/**
+ * @brief Amount of memory this process can still allocate
+ * @return number of bytes
+ *
+ * This is the smallest of the 'MemAvailable' in /proc/meminfo (or the free
+ * and buffer RAM from sysinfo, on older kernels) and the headroom left
+ * inside the cgroup (v1 or v2) memory limit, if there's one.
+ */
+unsigned long int availableMemory();
+
+/**
+ * @brief Number of cores this process can run on
+ * @return number of cores
+ *
+ * This is the smallest of the online cores, the cores in the affinity mask
+ * and the cgroup (v2) cpu quota, if there's one.
+ */
+int numCores();
+
+/**
+ * @brief Memory currently resident for this process
+ * @return number of bytes (0 if unknown)
+ *
+ * This is the 'VmRSS' in /proc/self/status.
+ */
+unsigned long int residentMemory();
+
+/**
+ * @brief Most memory ever resident for this process
+ * @return number of bytes (0 if unknown)
+ *
+ * This is the largest of the 'ru_maxrss' of getrusage and the 'VmHWM' in
+ * /proc/self/status. Unlike the estimates of the cost model, this includes
+ * everything: the vectors, the engines, the thread stacks, the libraries...
+ */
+unsigned long int peakResidentMemory();
+
+/**
+ * @brief Model of the CPU
+ * @return the 'model name' in /proc/cpuinfo ("unknown" if not found)
+ */
+std::string cpuModel();
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_SYSINFO_H__
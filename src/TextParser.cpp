@@ -0,0 +1,352 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "TextParser.h"
+#include "ThreadPool.h"
+#include "MemTrack.h"
+#include <charconv>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+using namespace std;
+
+
+/** smallest chunk worth a task of its own */
+#define MIN_CHUNK_BYTES  (1UL << 20)
+/** chunks per thread, so that uneven lines don't leave threads idle */
+#define CHUNKS_PER_THREAD 4
+
+
+/**
+ * @brief Whether the character separates two values
+ * @param c the character
+ * @return true for a separator
+ */
+static inline bool isSeparator(char c) {
+    return (c == ' ') || (c == '\t') || (c == ',') || (c == '\r');
+}
+
+/**
+ * @brief Counts the values on one line
+ * @param p start of the line.
+ * @param eol end of the line.
+ * @return the count (0 for blank and comment lines)
+ */
+static int countValues(const char* p, const char* eol) {
+    while((p < eol) && isSeparator(*p)) {
+        p++;
+    }
+    if((p == eol) || (*p == '#')) {
+        return 0;
+    }
+    int count = 0;
+    while(p < eol) {
+        count++;
+        while((p < eol) && !isSeparator(*p)) {
+            p++;
+        }
+        while((p < eol) && isSeparator(*p)) {
+            p++;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief End of the line starting at 'p'
+ * @param p start of the line.
+ * @param end end of the buffer.
+ * @return position of the '\n' (or 'end')
+ */
+static inline const char* lineEnd(const char* p, const char* end) {
+    const char* eol = (const char*) memchr(p, '\n', end - p);
+    return (eol == NULL)? end : eol;
+}
+
+
+TextParser::TextParser() {
+    m_text = NULL;
+    m_values = NULL;
+    m_rows = 0;
+    m_cols = 0;
+    m_fileCols = 0;
+    m_bytes = 0;
+}
+
+TextParser::~TextParser() {
+    if(m_values != NULL) {
+        MemTrack::release(m_values);
+    }
+}
+
+REAL* TextParser::release() {
+    REAL* arr = m_values;
+    m_values = NULL;
+    return arr;
+}
+
+
+bool TextParser::parse(const string& file, unsigned long int maxVec, int vecLen, int numThreads) {
+    if(m_values != NULL) {
+        MemTrack::release(m_values);
+        m_values = NULL;
+    }
+    m_rows = 0;
+    m_error = "";
+    int fd = open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if((fd < 0) || (fstat(fd, &st) != 0)) {
+        m_error = "failed to open the file";
+        if(fd >= 0) {
+            close(fd);
+        }
+        return false;
+    }
+    m_bytes = st.st_size;
+    void* ptr = (m_bytes > 0)? mmap(NULL, m_bytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(ptr == MAP_FAILED) {
+        m_error = (m_bytes > 0)? "failed to map the file into memory" : "empty file";
+        return false;
+    }
+    madvise(ptr, m_bytes, MADV_SEQUENTIAL);
+    m_text = (const char*) ptr;
+    const char* end = m_text + m_bytes;
+    // the first data row decides the shape
+    m_fileCols = 0;
+    for(const char* p=m_text;(p<end)&&(m_fileCols==0);) {
+        const char* eol = lineEnd(p, end);
+        m_fileCols = countValues(p, eol);
+        p = eol + 1;
+    }
+    bool ok = (m_fileCols > 0);
+    if(!ok) {
+        m_error = "no values in the file";
+    }
+    ok = ok && setupColumns();
+    if(ok) {
+        // split at line boundaries
+        unsigned long int numChunks = min((unsigned long int) numThreads * CHUNKS_PER_THREAD,
+                                          (m_bytes / MIN_CHUNK_BYTES) + 1);
+        m_chunks.clear();
+        size_t begin = 0;
+        for(unsigned long int c=1;(c<=numChunks)&&(begin<m_bytes);c++) {
+            size_t stop = (c == numChunks)? m_bytes : (m_bytes * c) / numChunks;
+            if(stop < begin) {
+                stop = begin;
+            }
+            stop = lineEnd(m_text + stop, end) - m_text;
+            stop = (stop < m_bytes)? stop + 1 : m_bytes;
+            Chunk ch;
+            ch.begin = begin;
+            ch.end = stop;
+            ch.rows = ch.first = 0;
+            ch.badRow = -1;
+            ch.badCount = 0;
+            m_chunks.push_back(ch);
+            begin = stop;
+        }
+        ThreadPool pool(numThreads);
+        pool.parallelFor((int) m_chunks.size(), [&](int task, int worker) {
+            countRows(m_chunks[task]);
+        });
+        unsigned long int total = 0;
+        for(size_t c=0;c<m_chunks.size();c++) {
+            m_chunks[c].first = total;
+            total += m_chunks[c].rows;
+        }
+        unsigned long int maxRows = (vecLen > 0)? ((maxVec * vecLen) + m_cols - 1) / m_cols : maxVec;
+        m_rows = ((maxRows > 0) && (maxRows < total))? maxRows : total;
+        ok = !checkChunks();
+        if(ok) {
+            m_values = MemTrack::allocate<REAL>(m_rows * m_cols, MEM_VECTORS);
+            pool.parallelFor((int) m_chunks.size(), [&](int task, int worker) {
+                convertRows(m_chunks[task]);
+            });
+            ok = !checkChunks();
+        }
+    }
+    munmap(ptr, m_bytes);
+    m_text = NULL;
+    if(!ok && (m_values != NULL)) {
+        MemTrack::release(m_values);
+        m_values = NULL;
+    }
+    return ok;
+}
+
+
+void TextParser::countRows(Chunk& ch) {
+    const char* p = m_text + ch.begin;
+    const char* end = m_text + ch.end;
+    while(p < end) {
+        const char* eol = lineEnd(p, end);
+        int n = countValues(p, eol);
+        if(n > 0) {
+            if((n != m_fileCols) && (ch.badRow < 0)) {
+                ch.badRow = ch.rows;
+                ch.badCount = n;
+            }
+            ch.rows++;
+        }
+        p = eol + 1;
+    }
+}
+
+
+void TextParser::convertRows(Chunk& ch) {
+    if(ch.first >= m_rows) {
+        return;
+    }
+    const char* p = m_text + ch.begin;
+    const char* end = m_text + ch.end;
+    unsigned long int row = ch.first;
+    REAL* out = m_values + (row * m_cols);
+    while((p < end) && (row < m_rows)) {
+        const char* eol = lineEnd(p, end);
+        while((p < eol) && isSeparator(*p)) {
+            p++;
+        }
+        if((p == eol) || (*p == '#')) {
+            p = eol + 1;
+            continue;
+        }
+        if(!convertLine(p, eol, out) && (ch.badRow < 0)) {
+            ch.badRow = row - ch.first;
+            ch.badCount = -1;
+        }
+        out += m_cols;
+        row++;
+        p = eol + 1;
+    }
+}
+
+
+bool TextParser::convertLine(const char* p, const char* eol, REAL* out) const {
+    bool ok = true;
+    for(int col=0;p<eol;col++) {
+        const char* tok = p;
+        while((p < eol) && !isSeparator(*p)) {
+            p++;
+        }
+        int dest = m_dest[col];
+        if(dest >= 0) {
+            // from_chars doesn't accept a leading '+'
+            const char* num = (*tok == '+')? tok + 1 : tok;
+            from_chars_result res = from_chars(num, p, out[dest]);
+            ok = ok && (res.ec == errc()) && (res.ptr == p);
+        }
+        while((p < eol) && isSeparator(*p)) {
+            p++;
+        }
+    }
+    return ok;
+}
+
+
+bool TextParser::setupColumns() {
+    m_dest.assign(m_fileCols, -1);
+    m_cols = m_columns.empty()? m_fileCols : (int) m_columns.size();
+    for(int i=0;i<m_cols;i++) {
+        int c = m_columns.empty()? i : m_columns[i];
+        if((c < 0) || (c >= m_fileCols) || (m_dest[c] >= 0)) {
+            m_error = "column " + to_string(c + 1) + " is either repeated or not in the file (which has " +
+                to_string(m_fileCols) + " columns)";
+            return false;
+        }
+        m_dest[c] = i;
+    }
+    return true;
+}
+
+
+int TextParser::firstLine(const char* text, size_t len) {
+    const char* end = text + len;
+    for(const char* p=text;p<end;) {
+        const char* eol = lineEnd(p, end);
+        if(eol == end) {
+            break;
+        }
+        int n = countValues(p, eol);
+        if(n > 0) {
+            m_fileCols = n;
+            m_rows = 0;
+            m_error = "";
+            return setupColumns()? 1 : -1;
+        }
+        p = eol + 1;
+    }
+    return 0;
+}
+
+
+bool TextParser::parseLines(const char* text, size_t& len, std::vector<REAL>& out,
+                            unsigned long int maxRows/*=0*/) {
+    const char* end = text + len;
+    unsigned long int last = m_rows + maxRows;
+    const char* p = text;
+    while((p < end) && ((maxRows == 0) || (m_rows < last))) {
+        const char* eol = lineEnd(p, end);
+        int n = countValues(p, eol);
+        if(n > 0) {
+            if(n != m_fileCols) {
+                m_error = "data row " + to_string(m_rows + 1) + " has " + to_string(n) +
+                    " values, expected " + to_string(m_fileCols);
+                return false;
+            }
+            while(isSeparator(*p)) {
+                p++;
+            }
+            size_t at = out.size();
+            out.resize(at + m_cols);
+            if(!convertLine(p, eol, &(out[at]))) {
+                m_error = "bad value on data row " + to_string(m_rows + 1);
+                return false;
+            }
+            m_rows++;
+        }
+        p = (eol < end)? eol + 1 : end;
+    }
+    len = p - text;
+    return true;
+}
+
+
+bool TextParser::checkChunks() {
+    for(size_t c=0;c<m_chunks.size();c++) {
+        const Chunk& ch = m_chunks[c];
+        unsigned long int row = ch.first + ch.badRow;
+        if((ch.badRow < 0) || (row >= m_rows)) {
+            continue;
+        }
+        if(ch.badCount < 0) {
+            m_error = "bad value on data row " + to_string(row + 1);
+        }
+        else {
+            m_error = "data row " + to_string(row + 1) + " has " + to_string(ch.badCount) +
+                " values, expected " + to_string(m_fileCols);
+        }
+        return true;
+    }
+    return false;
+}
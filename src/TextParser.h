@@ -0,0 +1,197 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_TEXTPARSER_H__
+#define __INCLUDED_TEXTPARSER_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+
+
+/**
+ * Parser for text files holding one vector per line, running on all the
+ * cores. The file is mapped into memory and split into chunks at line
+ * boundaries. A first pass counts the rows of every chunk (and checks that
+ * they all have the same number of values), so that the second pass can
+ * convert every chunk straight into its final place, using 'std::from_chars'.
+ *
+ * Values are separated by spaces, tabs or commas. Blank lines and lines
+ * starting with '#' are skipped. Text which can't be mapped (eg: from a pipe)
+ * is converted as it arrives, using 'firstLine' and 'parseLines'.
+ *
+ * Usage:
+ *  TextParser p;
+ *  if(!p.parse("data.txt", 0, 0, 4)) printf("%s\n", p.error().c_str());
+ *  REAL* arr = p.release();   // p.rows() x p.cols() values
+ */
+class TextParser {
+public:
+    /**
+     * @brief Constructor of this class.
+     */
+    TextParser();
+
+    /**
+     * @brief Destructor of this class. Frees the values, unless released.
+     */
+    ~TextParser();
+
+    /**
+     * @brief Keeps only the given columns, in the given order
+     * @param columns the columns (counting from 0). Empty means all.
+     */
+    void selectColumns(const std::vector<int>& columns) { m_columns = columns; }
+
+    /**
+     * @brief Parses the file
+     * @param file the file.
+     * @param maxVec number of vectors needed. 0 means all of them.
+     * @param vecLen values per vector. 0 means one vector per row.
+     * @param numThreads number of threads to be used.
+     * @return true on success, else see 'error'
+     *
+     * Only the rows holding the first 'maxVec' vectors are converted. When
+     * 'vecLen' differs from the values kept per row, the values are simply
+     * regrouped, ie, a vector can span rows.
+     */
+    bool parse(const std::string& file, unsigned long int maxVec, int vecLen, int numThreads);
+
+    /**
+     * @brief Looks for the first data line of text arriving piecewise
+     * @param text the text read so far.
+     * @param len its length.
+     * @return 1 once the line is there (which then decides the shape), 0 if
+     *  more text is needed and -1 on errors (see 'error')
+     *
+     * This (and then 'parseLines') replaces 'parse' when the text can't be
+     * mapped into memory, eg: for pipes.
+     */
+    int firstLine(const char* text, size_t len);
+
+    /**
+     * @brief Converts complete lines of text arriving piecewise
+     * @param text the lines, starting at a line boundary.
+     * @param len their length. Only the last line may lack its '\n'. On
+     *  return, this contains the bytes actually converted.
+     * @param out the values are appended to this.
+     * @param maxRows stop after these many data rows. 0 means all of them.
+     * @return true on success, else see 'error'
+     */
+    bool parseLines(const char* text, size_t& len, std::vector<REAL>& out, unsigned long int maxRows=0);
+
+    /**
+     * @brief Hands over the values to the caller
+     * @return the rows x cols values (to be freed with 'MemTrack::release')
+     */
+    REAL* release();
+
+    /**
+     * @brief Number of rows parsed
+     * @return the count
+     */
+    unsigned long int rows() const { return m_rows; }
+
+    /**
+     * @brief Number of values kept per row
+     * @return the count
+     */
+    int cols() const { return m_cols; }
+
+    /**
+     * @brief Number of values per row in the file
+     * @return the count
+     */
+    int fileCols() const { return m_fileCols; }
+
+    /**
+     * @brief Size of the file
+     * @return the size (in B)
+     */
+    unsigned long int bytes() const { return m_bytes; }
+
+    /**
+     * @brief Error message of the last failed 'parse'
+     * @return the message
+     */
+    const std::string& error() const { return m_error; }
+
+private:
+    /** one piece of the file, handled by one task */
+    struct Chunk {
+        size_t begin;              ///< first byte (always the start of a line)
+        size_t end;                ///< one past the last byte
+        unsigned long int rows;    ///< data rows inside this chunk
+        unsigned long int first;   ///< data rows before this chunk
+        long int badRow;           ///< first bad row (from 'first'), -1 if none
+        int badCount;              ///< values found on that row (-1 for a bad value)
+    };
+
+    /**
+     * @brief First pass over one chunk: counts (and checks) its rows
+     * @param ch the chunk.
+     */
+    void countRows(Chunk& ch);
+
+    /**
+     * @brief Second pass over one chunk: converts its values
+     * @param ch the chunk.
+     */
+    void convertRows(Chunk& ch);
+
+    /**
+     * @brief Converts the values of one data line
+     * @param p first value on the line.
+     * @param eol end of the line.
+     * @param out where to write the kept values.
+     * @return false if a value couldn't be converted
+     */
+    bool convertLine(const char* p, const char* eol, REAL* out) const;
+
+    /**
+     * @brief Decides where every column goes, once 'm_fileCols' is known
+     * @return true on success, else see 'error'
+     */
+    bool setupColumns();
+
+    /**
+     * @brief Finds the first bad row among all chunks and sets the error
+     * @return true if a bad row was found
+     */
+    bool checkChunks();
+
+private:
+    std::vector<int> m_columns;      ///< columns to be kept (empty means all)
+    std::vector<int> m_dest;         ///< destination of every column (-1 to skip)
+    const char* m_text;              ///< the mapped file
+    std::vector<Chunk> m_chunks;     ///< pieces of the file
+    REAL* m_values;                  ///< the parsed values
+    unsigned long int m_rows;        ///< rows parsed
+    int m_cols;                      ///< values kept per row
+    int m_fileCols;                  ///< values per row in the file
+    unsigned long int m_bytes;       ///< bytes scanned
+    std::string m_error;             ///< error message
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_TEXTPARSER_H__
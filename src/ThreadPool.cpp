@@ -0,0 +1,118 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "ThreadPool.h"
+#include "Timer.h"
+#include "Trace.h"
+
+
+
+
+ThreadPool::ThreadPool(int numThreads) {
+    m_size = (numThreads < 1)? 1 : numThreads;
+    m_func = NULL;
+    m_numTasks = 0;
+    m_next = 0;
+    m_running = 0;
+    m_batch = 0;
+    m_quit = false;
+    for(int i=1;i<m_size;i++) {
+        m_threads.push_back(std::thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for(size_t i=0;i<m_threads.size();i++) {
+        m_threads[i].join();
+    }
+}
+
+
+void ThreadPool::runTask(const TaskFunc& func, int task, int id) {
+    if(!Trace::enabled()) {
+        func(task, id);
+        return;
+    }
+    unsigned long long begin = Timer::ticks();
+    func(task, id);
+    Trace::event("task", "task", begin, Timer::ticks(), task);
+}
+
+
+void ThreadPool::drain(int id) {
+    TimerScope tim("tasks");
+    int task;
+    while((task = m_next.fetch_add(1)) < m_numTasks) {
+        runTask(*m_func, task, id);
+    }
+}
+
+
+void ThreadPool::workerLoop(int id) {
+    Trace::nameThread("worker");
+    unsigned long int seen = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lk(m_lock);
+            m_wake.wait(lk, [&] { return m_quit || (m_batch != seen); });
+            if(m_quit) {
+                return;
+            }
+            seen = m_batch;
+        }
+        drain(id);
+        {
+            std::lock_guard<std::mutex> lk(m_lock);
+            m_running--;
+        }
+        m_done.notify_one();
+    }
+}
+
+
+void ThreadPool::parallelFor(int numTasks, const TaskFunc& func) {
+    std::lock_guard<std::mutex> busy(m_busy);
+    if(m_threads.empty()) {
+        TimerScope tim("tasks");
+        for(int i=0;i<numTasks;i++) {
+            runTask(func, i, 0);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_func = &func;
+        m_numTasks = numTasks;
+        m_next = 0;
+        m_running = (int) m_threads.size();
+        m_batch++;
+    }
+    m_wake.notify_all();
+    drain(0);
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_done.wait(lk, [&] { return m_running == 0; });
+    m_func = NULL;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_THREADPOOL_H__
+#define __INCLUDED_THREADPOOL_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+/**
+ * Class holding a fixed set of worker threads, which are kept alive across
+ * calls. Work is handed out as a list of independent tasks, which are
+ * picked up by whichever worker is free.
+ *
+ * Usage:
+ *  ThreadPool pool(4);
+ *  pool.parallelFor(numBlocks, [&](int task, int worker) { ... });
+ */
+class ThreadPool {
+public:
+    /** signature of a task: task index and the index of the worker running it */
+    typedef std::function<void(int, int)> TaskFunc;
+
+    /**
+     * @brief Constructor of this class.
+     * @param numThreads number of workers (including the calling thread).
+     *
+     * The calling thread of 'parallelFor' works as worker 0, so only
+     * (numThreads - 1) threads are actually spawned.
+     */
+    ThreadPool(int numThreads);
+
+    /**
+     * @brief Destructor of this class. Joins all the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Number of workers in this pool
+     * @return number of workers
+     */
+    int size() const { return m_size; }
+
+    /**
+     * @brief Runs 'func' for every task in [0, numTasks) and waits for them
+     * @param numTasks number of tasks.
+     * @param func the function to be run for every task.
+     *
+     * Calls from different threads are serialized. This must NOT be called
+     * from inside one of the tasks!
+     */
+    void parallelFor(int numTasks, const TaskFunc& func);
+
+private:
+    /**
+     * @brief Main loop of the spawned workers
+     * @param id index of this worker
+     */
+    void workerLoop(int id);
+
+    /**
+     * @brief Picks up and runs tasks until none are left
+     * @param id index of this worker
+     */
+    void drain(int id);
+
+    /**
+     * @brief Runs one task, recording it if tracing (see 'Trace')
+     * @param func the task function.
+     * @param task the task.
+     * @param id id of the worker running it.
+     */
+    void runTask(const TaskFunc& func, int task, int id);
+
+private:
+    int m_size;                         ///< number of workers
+    std::vector<std::thread> m_threads; ///< spawned workers
+    std::mutex m_busy;                  ///< serializes 'parallelFor' calls
+    std::mutex m_lock;                  ///< guards the fields below
+    std::condition_variable m_wake;     ///< signals a new batch of tasks
+    std::condition_variable m_done;     ///< signals end of a batch
+    const TaskFunc* m_func;             ///< current task function
+    int m_numTasks;                     ///< number of tasks in current batch
+    std::atomic<int> m_next;            ///< next task to be picked up
+    int m_running;                      ///< spawned workers still in the batch
+    unsigned long int m_batch;          ///< batch counter
+    bool m_quit;                        ///< whether the workers must exit
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_THREADPOOL_H__
@@ -17,7 +17,67 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 \***************************************************************************/
 
 
+
 #include "Timer.h"
+#include "Trace.h"
+#include <mutex>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define __USE_TSC__
+#endif
+
+
+using namespace std;
+
+
+/** one node of the tree of regions of a thread */
+struct Region {
+    const char* name;          ///< name of the region
+    int parent;                ///< enclosing region (-1 for the top ones)
+    int child;                 ///< first region inside it (-1 if none)
+    int sibling;               ///< next region with the same parent (-1 if none)
+    unsigned long int calls;   ///< times it was left
+    unsigned long long ticks;  ///< ticks spent inside it
+};
+
+/** tree of regions of one thread */
+struct RegionTree {
+    vector<Region> nodes;      ///< all the regions entered so far
+    int current;               ///< innermost open region (-1 if none)
+    int first;                 ///< first top region (-1 if none)
+};
+
+/** the same, merged across the threads, for the report */
+struct MergedRegion {
+    string name;                    ///< name of the region
+    unsigned long long ticks;       ///< ticks spent inside it
+    unsigned long int calls;        ///< times it was left
+    int threads;                    ///< threads which entered it
+    vector<MergedRegion> children;  ///< regions inside it
+};
+
+
+/** tree of the calling thread (NULL till it enters its first region) */
+static thread_local RegionTree* s_tree = NULL;
+/** trees of all the threads, which outlive them for the report */
+static vector<RegionTree*> s_trees;
+/** guards 's_trees' */
+static mutex s_treesLock;
+
+
+/**
+ * @brief Reads the monotonic clock
+ * @return seconds
+ */
+static REAL monotonic() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
+/** both clocks at startup, to calibrate the ticks against */
+static const unsigned long long s_ticks0 = Timer::ticks();
+static const REAL s_mono0 = monotonic();
 
 
 Timer::Timer() {
@@ -26,15 +86,9 @@ Timer::Timer() {
     m_elapsed = -2;
 }
 
-#ifdef __USE_TIMEVAL__
-void Timer::setTime(timeval& t) {
-    gettimeofday(&t, 0);
+void Timer::setTime(timespec& t) {
+    clock_gettime(CLOCK_MONOTONIC, &t);
 }
-#else
-void Timer::setTime(clock_t& t) {
-    t = clock();
-}
-#endif
 
 void Timer::start() {
     m_stopped = false;
@@ -61,11 +115,7 @@ REAL Timer::report() {
     if(m_elapsed != -2) {
         return m_elapsed;
     }
-#ifdef __USE_TIMEVAL__
-    m_elapsed = (m_stop.tv_sec - m_start.tv_sec) + ((m_stop.tv_usec - m_start.tv_usec) / 1000000.0);
-#else
-    m_elapsed = (m_stop - m_start) / ((double) CLOCKS_PER_SEC);
-#endif
+    m_elapsed = (m_stop.tv_sec - m_start.tv_sec) + ((m_stop.tv_nsec - m_start.tv_nsec) * 1e-9);
     return m_elapsed;
 }
 
@@ -73,3 +123,173 @@ void Timer::stopAndPrintTime(const char* fmt) {
     stop();
     fprintf(stdout, fmt, report());
 }
+
+
+unsigned long long Timer::ticks() {
+#ifdef __USE_TSC__
+    return __rdtsc();
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+#endif
+}
+
+REAL Timer::tickSeconds() {
+#ifdef __USE_TSC__
+    unsigned long long t = ticks();
+    REAL secs = monotonic() - s_mono0;
+    return (t > s_ticks0)? secs / (t - s_ticks0) : 0;
+#else
+    return 1e-9;
+#endif
+}
+
+
+unsigned long long Timer::enter(const char* name) {
+    RegionTree* tree = s_tree;
+    if(tree == NULL) {
+        tree = s_tree = new RegionTree;
+        tree->current = tree->first = -1;
+        lock_guard<mutex> lk(s_treesLock);
+        s_trees.push_back(tree);
+    }
+    // most regions are entered many times: look for this one first
+    int parent = tree->current;
+    int node = (parent < 0)? tree->first : tree->nodes[parent].child;
+    int last = -1;
+    while((node >= 0) && (tree->nodes[node].name != name) && strcmp(tree->nodes[node].name, name)) {
+        last = node;
+        node = tree->nodes[node].sibling;
+    }
+    if(node < 0) {
+        Region r;
+        r.name = name;
+        r.parent = parent;
+        r.child = r.sibling = -1;
+        r.calls = 0;
+        r.ticks = 0;
+        node = (int) tree->nodes.size();
+        tree->nodes.push_back(r);
+        if(last >= 0) {
+            tree->nodes[last].sibling = node;
+        }
+        else if(parent >= 0) {
+            tree->nodes[parent].child = node;
+        }
+        else {
+            tree->first = node;
+        }
+    }
+    tree->current = node;
+    return ticks();
+}
+
+void Timer::leave(unsigned long long start) {
+    unsigned long long now = ticks();
+    RegionTree* tree = s_tree;
+    if((tree == NULL) || (tree->current < 0)) {
+        return;
+    }
+    Region& r = tree->nodes[tree->current];
+    r.ticks += now - start;
+    r.calls++;
+    tree->current = r.parent;
+    Trace::event(r.name, "region", start, now);
+}
+
+
+/**
+ * @brief Adds the regions of a thread (starting at one of them, along with
+ *  its siblings) to the merged ones
+ * @param tree the tree of the thread.
+ * @param node the first region.
+ * @param out the merged regions.
+ */
+static void mergeRegions(const RegionTree* tree, int node, vector<MergedRegion>& out) {
+    for(;node>=0;node=tree->nodes[node].sibling) {
+        const Region& r = tree->nodes[node];
+        size_t i = 0;
+        while((i < out.size()) && (out[i].name != r.name)) {
+            i++;
+        }
+        if(i == out.size()) {
+            MergedRegion m;
+            m.name = r.name;
+            m.ticks = 0;
+            m.calls = 0;
+            m.threads = 0;
+            out.push_back(m);
+        }
+        out[i].ticks += r.ticks;
+        out[i].calls += r.calls;
+        out[i].threads++;
+        mergeRegions(tree, r.child, out[i].children);
+    }
+}
+
+/**
+ * @brief Prints the merged regions (and those inside them)
+ * @param fp where to print.
+ * @param regions the regions.
+ * @param depth their depth in the tree.
+ * @param secs seconds per tick.
+ */
+static void printMerged(FILE* fp, const vector<MergedRegion>& regions, int depth, REAL secs) {
+    for(size_t i=0;i<regions.size();i++) {
+        const MergedRegion& m = regions[i];
+        unsigned long long inner = 0;
+        for(size_t c=0;c<m.children.size();c++) {
+            inner += m.children[c].ticks;
+        }
+        // a region still open isn't accounted for yet, unlike those inside it
+        unsigned long long self = (inner < m.ticks)? m.ticks - inner : 0;
+        fprintf(fp, "  %*s%-*s %12.6f %12.6f %10lu %7d\n", 2 * depth, "", 30 - (2 * depth),
+                m.name.c_str(), m.ticks * secs, self * secs, m.calls, m.threads);
+        printMerged(fp, m.children, depth + 1, secs);
+    }
+}
+
+void Timer::printRegions(FILE* fp) {
+    vector<MergedRegion> merged;
+    {
+        lock_guard<mutex> lk(s_treesLock);
+        for(size_t t=0;t<s_trees.size();t++) {
+            mergeRegions(s_trees[t], s_trees[t]->first, merged);
+        }
+    }
+    fprintf(fp, "TIMINGS (in s, summed over the threads):\n");
+    fprintf(fp, "  %-30s %12s %12s %10s %7s\n", "region", "inclusive", "exclusive", "calls",
+            "threads");
+    printMerged(fp, merged, 0, tickSeconds());
+}
+
+
+TimerScope::TimerScope(const char* name, const char* fmt/*=NULL*/) {
+    m_fmt = fmt;
+    m_open = true;
+    m_timer.start();
+    m_ticks = Timer::enter(name);
+}
+
+REAL TimerScope::stop() {
+    if(!m_open) {
+        return m_timer.report();
+    }
+    Timer::leave(m_ticks);
+    m_open = false;
+    m_timer.stop();
+    if(m_fmt != NULL) {
+        fprintf(stdout, m_fmt, m_timer.report());
+    }
+    return m_timer.report();
+}
+
+REAL TimerScope::elapsed() {
+    if(!m_open) {
+        return m_timer.report();
+    }
+    Timer t = m_timer;
+    t.stop();
+    return t.report();
+}
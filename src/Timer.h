@@ -20,51 +20,40 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #ifndef __INCLUDED_TIMER_H__
 #define __INCLUDED_TIMER_H__
 
-#define __USE_TIMEVAL__
-#if defined(_WIN32) || defined(__CYGWIN__)
-#undef __USE_TIMEVAL__
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
 #endif
 
 
-#ifdef __USE_TIMEVAL__
-#include <sys/time.h>
-#endif
-#include <sys/types.h>
+#include <stdio.h>
 #include <time.h>
 #include "basics.h"
 
 
 
 /**
- * Class to measure the events.
+ * Class to measure the events, using the monotonic clock (which, unlike the
+ * time of the day, never jumps).
+ *
+ * It also keeps the tree of the regions entered on every thread (see
+ * 'TimerScope'). These are timed with the time-stamp counter of the CPU where
+ * available, which is cheap enough for the hot paths, and converted to seconds
+ * only when printing the report (see 'printRegions').
  */
 class Timer {
 private:
-#ifdef __USE_TIMEVAL__
-    timeval m_start;     ///< clock value when Timer is started
-    timeval m_stop;      ///< clock value when Timer is stopped
-#else
-    clock_t m_start;     ///< clock value when Timer is started
-    clock_t m_stop;      ///< clock value when Timer is stopped
-#endif
+    timespec m_start;    ///< clock value when Timer is started
+    timespec m_stop;     ///< clock value when Timer is stopped
     bool m_stopped;      ///< If the Timer has been stopped after being started
     bool m_started;      ///< True if the Timer has been started
     REAL m_elapsed;      ///< Elapsed number of seconds between start and stop commands
 
 private:
-#ifdef __USE_TIMEVAL__
-    /**
-     * @brief Set current time
-     * @param t the returned time from the system
-     */
-    void setTime(timeval& t);
-#else
     /**
      * @brief Set current time
      * @param t the returned time from the system
      */
-    void setTime(clock_t& t);
-#endif
+    void setTime(timespec& t);
 
 public:
     /**
@@ -103,6 +92,92 @@ public:
      * Also, '%f' is the ONLY formatting character allowed in this string!
      */
     void stopAndPrintTime(const char* fmt);
+
+    /**
+     * @brief Reads the time-stamp counter (or the monotonic clock, in ns,
+     *  where there's none)
+     * @return the ticks
+     */
+    static unsigned long long ticks();
+
+    /**
+     * @brief Duration of one tick
+     * @return seconds
+     *
+     * The counter is calibrated against the monotonic clock over the whole
+     * lifetime of the process, so this gets more accurate as time goes by.
+     */
+    static REAL tickSeconds();
+
+    /**
+     * @brief Enters a region, below the innermost one open on this thread
+     * @param name name of the region. It must stay valid till the end of the
+     *  program (eg: a string literal).
+     * @return the ticks when entering, to be passed to 'leave'
+     */
+    static unsigned long long enter(const char* name);
+
+    /**
+     * @brief Leaves the innermost region open on this thread
+     * @param start what 'enter' returned.
+     */
+    static void leave(unsigned long long start);
+
+    /**
+     * @brief Prints the tree of regions, merged across all the threads
+     * @param fp where to print.
+     *
+     * Every region is printed with its inclusive time (summed over all the
+     * threads which entered it), its exclusive time (ie: without the regions
+     * inside it), the number of times it was entered and the number of
+     * threads. Only the regions left by now are accounted for, and the
+     * threads must not be entering any meanwhile.
+     */
+    static void printRegions(FILE* fp);
+};
+
+
+/**
+ * Marks the lifetime of this object as a region of the 'Timer' tree. Usage:
+ *  {
+ *      TimerScope t("corrsum", "Time taken: %f s\n");
+ *      ...
+ *  }   // prints the time taken, when going out of scope
+ *
+ * The scopes open on a thread must be left in the reverse order.
+ */
+class TimerScope {
+public:
+    /**
+     * @brief Enters the region
+     * @param name name of the region (see 'Timer::enter').
+     * @param fmt if not NULL, printed along with the elapsed time when
+     *  leaving (see 'Timer::stopAndPrintTime').
+     */
+    TimerScope(const char* name, const char* fmt=NULL);
+
+    /**
+     * @brief Leaves the region, unless already done by 'stop'
+     */
+    ~TimerScope() { stop(); }
+
+    /**
+     * @brief Leaves the region before going out of scope
+     * @return the seconds spent in it
+     */
+    REAL stop();
+
+    /**
+     * @brief Seconds spent in the region so far
+     * @return the seconds
+     */
+    REAL elapsed();
+
+private:
+    const char* m_fmt;           ///< message to be printed when leaving
+    unsigned long long m_ticks;  ///< ticks when entering
+    Timer m_timer;               ///< measures the time to be printed
+    bool m_open;                 ///< whether the region hasn't been left yet
 };
 
 
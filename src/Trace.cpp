@@ -0,0 +1,160 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "Trace.h"
+#include "Timer.h"
+#include <mutex>
+
+
+using namespace std;
+
+
+/** one event of a thread */
+struct TraceEvent {
+    const char* name;          ///< name of the event
+    const char* cat;           ///< its category
+    unsigned long long begin;  ///< ticks when it began
+    unsigned long long end;    ///< ticks when it ended
+    long int arg;              ///< number shown along with it (-1 if none)
+};
+
+/** events of one thread */
+struct TraceBuffer {
+    int tid;                   ///< id of the lane of the thread
+    const char* name;          ///< name of the lane (NULL if none)
+    vector<TraceEvent> events; ///< the events, in the order they ended
+    mutex lock;                ///< guards the fields above against 'write'
+};
+
+
+atomic<bool> Trace::s_enabled(false);
+/** buffer of the calling thread (NULL till it records its first event) */
+static thread_local TraceBuffer* s_buffer = NULL;
+/** buffers of all the threads, which outlive them till the exit */
+static vector<TraceBuffer*> s_buffers;
+/** guards 's_buffers' */
+static mutex s_buffersLock;
+/** file where to write the events */
+static string s_file;
+/** ticks when the recording started */
+static unsigned long long s_start = 0;
+
+
+/**
+ * @brief Buffer of the calling thread
+ * @return the buffer (created and registered on the first call)
+ */
+static TraceBuffer* threadBuffer() {
+    if(s_buffer == NULL) {
+        TraceBuffer* buf = new TraceBuffer;
+        buf->name = NULL;
+        lock_guard<mutex> lk(s_buffersLock);
+        buf->tid = (int) s_buffers.size() + 1;
+        s_buffers.push_back(buf);
+        s_buffer = buf;
+    }
+    return s_buffer;
+}
+
+/**
+ * @brief Writes the events at exit
+ */
+static void writeAtExit() {
+    Trace::write();
+}
+
+
+void Trace::start(const string& file) {
+    s_file = file;
+    s_start = Timer::ticks();
+    s_enabled = true;
+    nameThread("main");
+    atexit(writeAtExit);
+}
+
+void Trace::event(const char* name, const char* cat, unsigned long long begin,
+                  unsigned long long end, long int arg/*=-1*/) {
+    if(!enabled()) {
+        return;
+    }
+    TraceEvent ev;
+    ev.name = name;
+    ev.cat = cat;
+    ev.begin = begin;
+    ev.end = end;
+    ev.arg = arg;
+    TraceBuffer* buf = threadBuffer();
+    lock_guard<mutex> lk(buf->lock);
+    // 'write' may have started meanwhile
+    if(s_enabled) {
+        buf->events.push_back(ev);
+    }
+}
+
+void Trace::nameThread(const char* name) {
+    if(!enabled()) {
+        return;
+    }
+    TraceBuffer* buf = threadBuffer();
+    lock_guard<mutex> lk(buf->lock);
+    buf->name = name;
+}
+
+
+void Trace::write() {
+    // no event is recorded after this (see 'event')
+    if(!s_enabled.exchange(false)) {
+        return;
+    }
+    FILE* fp = fopen(s_file.c_str(), "w");
+    if(fp == NULL) {
+        fprintf(stderr, "Failed to open the file '%s' for writing!\n", s_file.c_str());
+        return;
+    }
+    // the timestamps are in us
+    REAL us = Timer::tickSeconds() * 1e6;
+    lock_guard<mutex> lk(s_buffersLock);
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(fp, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+            "\"args\": {\"name\": \"corrdim\"}}");
+    for(size_t b=0;b<s_buffers.size();b++) {
+        TraceBuffer* buf = s_buffers[b];
+        lock_guard<mutex> blk(buf->lock);
+        if(buf->name != NULL) {
+            fprintf(fp, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                    "\"args\": {\"name\": \"%s\"}}", buf->tid, buf->name);
+        }
+        for(size_t e=0;e<buf->events.size();e++) {
+            const TraceEvent& ev = buf->events[e];
+            // events which began before the recording did are clipped
+            unsigned long long begin = (ev.begin > s_start)? ev.begin - s_start : 0;
+            unsigned long long end = (ev.end > s_start)? ev.end - s_start : 0;
+            fprintf(fp, ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, "
+                    "\"tid\": %d, \"ts\": %.3f, \"dur\": %.3f", ev.name, ev.cat, buf->tid,
+                    begin * us, (end - begin) * us);
+            if(ev.arg >= 0) {
+                fprintf(fp, ", \"args\": {\"value\": %ld}", ev.arg);
+            }
+            fprintf(fp, "}");
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+}
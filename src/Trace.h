@@ -0,0 +1,95 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_TRACE_H__
+#define __INCLUDED_TRACE_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <atomic>
+
+
+/**
+ * Timeline of a run in the Chrome Trace Event format, which 'chrome://tracing'
+ * and Perfetto (https://ui.perfetto.dev) display as one lane per thread.
+ *
+ * Every thread appends its events to a buffer of its own, whose lock is
+ * only ever contended by 'write'. The buffers are written into the file when
+ * the program exits. Threads still running then (eg: on an early 'exit')
+ * stop recording, their events so far being written. The regions of 'Timer',
+ * the phases of 'Metrics', the tasks of 'ThreadPool' and the reads of the
+ * vectors are all recorded, once 'start' has been called.
+ *
+ * Usage:
+ *  Trace::start("run.json");
+ *  unsigned long long t0 = Timer::ticks();
+ *  ...
+ *  Trace::event("read", "io", t0, Timer::ticks(), numBytes);
+ */
+class Trace {
+public:
+    /**
+     * @brief Starts recording the events, to be written into the file at exit
+     * @param file the file.
+     */
+    static void start(const std::string& file);
+
+    /**
+     * @brief Whether the events are being recorded
+     * @return true if they are
+     */
+    static bool enabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Records a complete event of the calling thread
+     * @param name name of the event. It must stay valid till the end of the
+     *  program (eg: a string literal).
+     * @param cat its category (same as above).
+     * @param begin ticks (see 'Timer::ticks') when it began.
+     * @param end ticks when it ended.
+     * @param arg a number shown along with the event (eg: the task or the
+     *  bytes read). Negative means none.
+     */
+    static void event(const char* name, const char* cat, unsigned long long begin,
+                      unsigned long long end, long int arg=-1);
+
+    /**
+     * @brief Names the lane of the calling thread
+     * @param name the name (same as for 'event').
+     */
+    static void nameThread(const char* name);
+
+    /**
+     * @brief Writes the events of all the threads into the file
+     *
+     * This is called at exit, so there's normally no need to call it.
+     */
+    static void write();
+
+private:
+    static std::atomic<bool> s_enabled;   ///< whether the events are being recorded
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_TRACE_H__
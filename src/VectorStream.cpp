@@ -0,0 +1,114 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "VectorStream.h"
+#include "MemTrack.h"
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+
+
+VectorStream::VectorStream(int dim, unsigned long int maxVec) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    m_dim = dim;
+    m_maxVec = maxVec;
+    m_reserved = (maxVec > 0)? maxVec * dim * sizeof(REAL) : STREAM_RESERVE_BYTES;
+    m_reserved = ((m_reserved + page - 1) / page) * page;
+    m_committed = 0;
+    m_numVals = 0;
+    m_finished = false;
+    // inaccessible pages cost nothing but address space
+    void* ptr = mmap(NULL, m_reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(ptr == MAP_FAILED) {
+        fprintf(stderr, "Failed to reserve %lu MB for the incoming vectors!\n", m_reserved >> 20);
+        fatalExit(1);
+    }
+    m_data = (REAL*) ptr;
+}
+
+
+VectorStream::~VectorStream() {
+    munmap(m_data, m_reserved);
+    MemTrack::remove(MEM_VECTORS, m_numVals.load(std::memory_order_relaxed) * sizeof(REAL));
+}
+
+
+REAL* VectorStream::reserve(unsigned long int num) {
+    unsigned long int have = m_numVals.load(std::memory_order_relaxed);
+    size_t need = (have + num) * sizeof(REAL);
+    if(need > m_reserved) {
+        fprintf(stderr, "More vectors arrived than the %lu MB reserved for them!\n", m_reserved >> 20);
+        fatalExit(1);
+    }
+    if(need > m_committed) {
+        size_t grow = ((need - m_committed + STREAM_COMMIT_BYTES - 1) / STREAM_COMMIT_BYTES) * STREAM_COMMIT_BYTES;
+        grow = std::min(grow, m_reserved - m_committed);
+        if(mprotect((char*) m_data + m_committed, grow, PROT_READ | PROT_WRITE) != 0) {
+            fprintf(stderr, "Out of memory after %lu MB of incoming vectors!\n", m_committed >> 20);
+            fatalExit(1);
+        }
+        m_committed += grow;
+    }
+    return m_data + have;
+}
+
+
+void VectorStream::commit(unsigned long int num) {
+    // only the values, the pages committed ahead of them are untouched
+    MemTrack::add(MEM_VECTORS, num * sizeof(REAL));
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_numVals.store(m_numVals.load(std::memory_order_relaxed) + num, std::memory_order_release);
+    }
+    m_arrived.notify_all();
+}
+
+
+void VectorStream::append(const REAL* vals, unsigned long int num) {
+    memcpy(reserve(num), vals, num * sizeof(REAL));
+    commit(num);
+}
+
+
+void VectorStream::finish() {
+    {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_finished.store(true, std::memory_order_release);
+    }
+    m_arrived.notify_all();
+}
+
+
+unsigned long int VectorStream::waitVectors(unsigned long int numVec) {
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_arrived.wait(lk, [&] { return (numVectors() >= numVec) || finished(); });
+    return numVectors();
+}
+
+
+void VectorStream::requireSlow(unsigned long int numVec) {
+    unsigned long int have = waitVectors(numVec);
+    if(have < numVec) {
+        fprintf(stderr, "Input ended after %lu vectors, but %lu were expected!\n", have,
+                (m_maxVec > 0)? m_maxVec : numVec);
+        fatalExit(1);
+    }
+}
@@ -0,0 +1,156 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_VECTORSTREAM_H__
+#define __INCLUDED_VECTORSTREAM_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+
+/** address space reserved for a stream of unknown length */
+#define STREAM_RESERVE_BYTES (1UL << 40)
+/** memory is committed to the stream in steps of this much */
+#define STREAM_COMMIT_BYTES  (8UL << 20)
+
+
+/**
+ * Vectors which are still arriving, eg: from a pipe. One producer appends
+ * values while the engines consume the vectors already there.
+ *
+ * The whole capacity is reserved upfront as address space only, and memory
+ * is committed to it as it grows. This way, the buffer never moves and the
+ * consumers can keep on using 'data()' while it grows.
+ *
+ * Usage:
+ *  VectorStream s(dim, numVec);
+ *  producer:  s.append(vals, num); ...; s.finish();
+ *        or:  p = s.reserve(num); ... write into p ...; s.commit(num);
+ *  consumer:  s.require(i + 1); ... use row 'i' of s.data() ...
+ */
+class VectorStream {
+public:
+    /**
+     * @brief Constructor of this class.
+     * @param dim dimension of the vectors.
+     * @param maxVec most vectors this stream will hold. 0 means unknown.
+     */
+    VectorStream(int dim, unsigned long int maxVec);
+
+    /**
+     * @brief Destructor of this class. Frees the buffer.
+     */
+    ~VectorStream();
+
+    /**
+     * @brief Start of the values (which never moves)
+     * @return the pointer
+     */
+    REAL* data() const { return m_data; }
+
+    /**
+     * @brief Dimension of the vectors
+     * @return dimension
+     */
+    int dimension() const { return m_dim; }
+
+    /**
+     * @brief Number of complete vectors which have arrived so far
+     * @return the count
+     */
+    unsigned long int numVectors() const { return m_numVals.load(std::memory_order_acquire) / m_dim; }
+
+    /**
+     * @brief Whether the producer has finished
+     * @return true if no more vectors will arrive
+     */
+    bool finished() const { return m_finished.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Room for the next values (to be called only by the producer)
+     * @param num number of values to be written.
+     * @return where to write them. They become visible only on 'commit'.
+     */
+    REAL* reserve(unsigned long int num);
+
+    /**
+     * @brief Makes the values written after 'reserve' visible to the consumers
+     * @param num number of values written. Partial vectors are fine.
+     */
+    void commit(unsigned long int num);
+
+    /**
+     * @brief Appends values (to be called only by the producer)
+     * @param vals the values.
+     * @param num number of values. Partial vectors are fine.
+     */
+    void append(const REAL* vals, unsigned long int num);
+
+    /**
+     * @brief Tells the consumers that no more vectors will arrive
+     */
+    void finish();
+
+    /**
+     * @brief Waits till the given number of vectors have arrived
+     * @param numVec the number of vectors needed.
+     * @return the number of vectors there. Less than 'numVec' only if the
+     *  producer finished early.
+     */
+    unsigned long int waitVectors(unsigned long int numVec);
+
+    /**
+     * @brief Same as 'waitVectors', but exits if the stream ends too early
+     * @param numVec the number of vectors needed.
+     */
+    void require(unsigned long int numVec) {
+        if(m_numVals.load(std::memory_order_acquire) < numVec * m_dim) {
+            requireSlow(numVec);
+        }
+    }
+
+private:
+    /**
+     * @brief Waiting part of 'require'
+     * @param numVec the number of vectors needed.
+     */
+    void requireSlow(unsigned long int numVec);
+
+private:
+    REAL* m_data;                          ///< the reserved buffer
+    int m_dim;                             ///< dimension of the vectors
+    unsigned long int m_maxVec;            ///< vectors expected (0 if unknown)
+    size_t m_reserved;                     ///< bytes reserved
+    size_t m_committed;                    ///< bytes usable so far
+    std::atomic<unsigned long int> m_numVals; ///< values which have arrived
+    std::atomic<bool> m_finished;          ///< whether the producer is done
+    std::mutex m_lock;                     ///< guards the waiting
+    std::condition_variable m_arrived;     ///< signals new values (or the end)
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_VECTORSTREAM_H__
@@ -19,25 +19,63 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "basics.h"
+#include <chrono>
 
 
 using namespace std;
 
 
-vector<string> listMaps() {
-    FILE* fp = fopen("maps.list", "r");
-    if(fp == NULL) {
-        fprintf(stderr, "Failed to open the file 'maps.list' for reading the list of maps!\n");
-        exit(1);
+/** whether 'fatalExit' throws on this thread */
+static thread_local bool s_throwOnFatal = false;
+
+void fatalExit(int code) {
+    if(s_throwOnFatal) {
+        FatalError err;
+        err.code = code;
+        throw err;
     }
-    char line[256];
-    vector<string> all_maps;
-    while(!feof(fp)) {
-        if(fscanf(fp, "%s", line)) {
-            all_maps.push_back(line);
+    exit(code);
+}
+
+void throwOnFatal(bool flag) {
+    s_throwOnFatal = flag;
+}
+
+
+vector<int> splitRows(int numVec, int numBlocks, int first/*=0*/) {
+    vector<int> bounds(numBlocks + 1, numVec);
+    unsigned long int total = TRI(numVec) - TRI(first);
+    int r = first;
+    bounds[0] = first;
+    for(int b=1;b<numBlocks;b++) {
+        unsigned long int target = TRI(first) + (total * b) / numBlocks;
+        while((r < numVec) && (TRI(r) < target)) {
+            r++;
         }
+        bounds[b] = r;
     }
-    fclose(fp);
-    return all_maps;
+    return bounds;
 }
 
+
+void linearLeastSquares(REAL& c0, REAL& c1, const REAL* x, const REAL* y, int n) {
+    // Xc = Y   OR   X'Xc = X'Y
+    // c0 * xi + c1 = yi
+    REAL x_sum2 = 0;
+    REAL x_sum = 0;
+    REAL y_sum = 0;
+    REAL xy_sum = 0;
+    for(int i=0;i<n;i++) {
+        xy_sum += (x[i] * y[i]);
+        y_sum += y[i];
+        x_sum += x[i];
+        x_sum2 += (x[i] * x[i]);
+    }
+    c1 = ((x_sum * xy_sum) - (x_sum2 * y_sum)) / ((x_sum * x_sum) - (n * x_sum2));
+    c0 = (xy_sum - (x_sum * c1)) / x_sum2;
+}
+
+
+REAL wallTime() {
+    return chrono::duration<REAL>(chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -38,6 +38,31 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include <stdlib.h>
 
 
+/**
+ * Thrown by 'fatalExit' instead of terminating the process, on threads
+ * which have asked for it through 'throwOnFatal'.
+ */
+struct FatalError {
+    int code;   ///< the exit code which would have been used
+};
+
+/**
+ * @brief Terminates the process with the given exit code
+ * @param code the exit code
+ *
+ * On threads which have called 'throwOnFatal(true)', this throws a
+ * 'FatalError' instead. This way, a long running process (see '-serve') can
+ * survive a bad request. Used by all the macros below.
+ */
+void fatalExit(int code);
+
+/**
+ * @brief Whether 'fatalExit' should throw, for the calling thread only
+ * @param flag true to throw, false to exit
+ */
+void throwOnFatal(bool flag);
+
+
 template <typename T>
 bool from_string(T& val, const std::string& str) {
     std::istringstream iss(str);
@@ -54,52 +79,79 @@ bool from_string(T& val, const char* str) {
     i++;                                                                \
     if(i >= argc) {                                                     \
         fprintf(stderr, "Option '%s' requires an argument!\n", opt);    \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
 #define GET_INTEGER(var, opt, arg)                                      \
     if(!from_string<int>(var, arg)) {                                   \
         fprintf(stderr, "Argument to '%s' must be an integer!\n", opt); \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
 #define GET_NUMBER(var, opt, arg)                                       \
     if(!from_string<REAL>(var, arg)) {                                  \
         fprintf(stderr, "Argument to '%s' must be a number!\n", opt);   \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
 #define CHECK_POSITIVE(var, opt)                                        \
     if(var <= 0) {                                                      \
         fprintf(stderr, "Argument to '%s' must be positive!\n", opt);   \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
 #define CHECK_NEGATIVE(var, opt)                                        \
     if(var > 0) {                                                       \
         fprintf(stderr, "Argument to '%s' must be positive!\n", opt);   \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
 #define CHECK_RANGE(var, opt, min, max)                                 \
     if((var < min) || (var > max)) {                                    \
         fprintf(stderr, "Range for the argument to '%s' is [%f,%f]!\n", \
                 opt, min, max);                                         \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
 #define CHECK_RANGE_INT(var, opt, min, max)                             \
     if((var < min) || (var > max)) {                                    \
         fprintf(stderr, "Range for the argument to '%s' is [%d,%d]!\n", \
                 opt, min, max);                                         \
-        exit(1);                                                        \
+        fatalExit(1);                                                   \
     }
 
+/** number of elements in the lower triangular distance matrix before row 'i' */
+#define TRI(i)   ((((unsigned long int) (i)) * ((i) - 1)) >> 1)
+
+
+/**
+ * @brief Splits the rows of the lower triangular distance matrix into blocks
+ * @param numVec number of rows (data points).
+ * @param numBlocks number of blocks desired.
+ * @param first first row to be split. [Defaults to 0]
+ * @return (numBlocks + 1) row boundaries. Block 'b' is [ret[b], ret[b+1]).
+ *
+ * Row 'i' contains 'i' pairs. So, the blocks are chosen to contain roughly
+ * the same number of pairs, not the same number of rows.
+ */
+std::vector<int> splitRows(int numVec, int numBlocks, int first=0);
+
+/**
+ * @brief Evaluates linear least square solution, ie, the line 'c0 * x + c1'
+ *  closest to the points (used by all the engines for the best-fit)
+ * @param c0 slope of the line
+ * @param c1 displacement of the line
+ * @param x points along x-axis
+ * @param y points along y-axis
+ * @param n number of points
+ */
+void linearLeastSquares(REAL& c0, REAL& c1, const REAL* x, const REAL* y, int n);
+
 /**
- * @brief Reads the file 'maps.list' to generate the list of maps supported
- * @return list of maps
+ * @brief Monotonic wall-clock time, for timing without a 'Timer'
+ * @return seconds since an arbitrary (but fixed) point
  */
-std::vector<std::string> listMaps();
+REAL wallTime();
 
 
 /* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
@@ -19,7 +19,7 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "cmdline.h"
-#include "allMaps.h"
+#include "CorrDimLowMem.h"
 
 
 using namespace std;
@@ -39,7 +39,15 @@ void showHelp(const vector<string>& list) {
     fprintf(stdout, "corrdim: Program to evaluate the correlation dimension from the\n");
     fprintf(stdout, "         points on a trajectory of a map.\n");
     fprintf(stdout, "USAGE:\n");
-    fprintf(stdout, " corrdim [-h] [-map <map>, -lowmem, -dump <file>, -numpts <pts>,\n");
+    fprintf(stdout, " corrdim [-h] [-map <map>, -engine <eng>, -lowmem, -maxmem <mb>,\n");
+    fprintf(stdout, "               -threads <n>, -calibrate, -serve <sock>, -batch <path>,\n");
+    fprintf(stdout, "               -batch-out <file>, -nopipeline, -sketch <file>,\n");
+    fprintf(stdout, "               -from-sketch <file>, -shard <i/n>, -merge <file>,\n");
+    fprintf(stdout, "               -checkpoint <file>, -checkpoint-every <s>, -resume <file>,\n");
+    fprintf(stdout, "               -tol <t>, -deadline <s>, -metrics <file>, -timings,\n");
+    fprintf(stdout, "               -perf-counters, -trace <file>, -progress <s>, -status <file>,\n");
+    fprintf(stdout, "               -ensemble <k>, -pooled, -sweep <opt=start:stop:steps>,\n");
+    fprintf(stdout, "               -dump <file>, -numpts <pts>,\n");
     fprintf(stdout, "               -numele <ele>, -discardl <pts>, -discardr <pts>,\n");
     fprintf(stdout, "               -dump-dist-hist <file>, -numbins <bins>]\n");
     fprintf(stdout, "          [... options specific for the maps ...]\n");
@@ -49,11 +57,79 @@ void showHelp(const vector<string>& list) {
     for(vector<string>::const_iterator itr=list.begin();itr!=list.end();itr++) {
         fprintf(stdout, "                        . %s\n", itr->c_str());
     }
-    fprintf(stdout, "  -lowmem            Use the low-memory version of the 'CorrDim' class.\n");
+    fprintf(stdout, "  -engine <eng>      Engine evaluating the corr-dim. 'full' stores the whole\n");
+    fprintf(stdout, "                     distance matrix, 'lowmem' stores none of it, 'hybrid'\n");
+    fprintf(stdout, "                     stores as much as fits in memory and recomputes the rest\n");
+    fprintf(stdout, "                     on all threads. 'auto' chooses the fastest one which fits\n");
+    fprintf(stdout, "                     in memory, using a cost model. [auto]\n");
+    fprintf(stdout, "  -lowmem            Same as '-engine lowmem'.\n");
+    fprintf(stdout, "  -maxmem <mb>       Memory budget in MB. If the distance matrix doesn't fit\n");
+    fprintf(stdout, "                     inside it, only a part of it is stored and the rest is\n");
+    fprintf(stdout, "                     recomputed. [available memory]\n");
+    fprintf(stdout, "  -threads <n>       Number of worker threads for 'hybrid'. [all cores]\n");
+    fprintf(stdout, "  -calibrate         Redo the one-off calibration of the cost model.\n");
+    fprintf(stdout, "  -serve <sock>      Run as a server, answering jobs arriving on the Unix socket\n");
+    fprintf(stdout, "                     <sock> (or on stdin, if <sock> is '-'). See README. [\"\"]\n");
+    fprintf(stdout, "  -batch <path>      Evaluate every series in the file <path> (or in all the\n");
+    fprintf(stdout, "                     files in the directory <path>), one series per thread.\n");
+    fprintf(stdout, "                     See README. [\"\"]\n");
+    fprintf(stdout, "  -batch-out <file>  Write the results table of '-batch' into <file>. [stdout]\n");
+    fprintf(stdout, "  -nopipeline        Generate (or read) all the vectors before starting the\n");
+    fprintf(stdout, "                     engine, instead of overlapping the two.\n");
+    fprintf(stdout, "  -sketch <file>     Also save a compact pair-count sketch of the distances\n");
+    fprintf(stdout, "                     into <file>. This computes all the distances once\n");
+    fprintf(stdout, "                     more, after the engine: up to twice the run time.\n");
+    fprintf(stdout, "                     '-shard 0/1' saves only the sketch. [\"\"]\n");
+    fprintf(stdout, "  -from-sketch <file>  Evaluate the corr-dim from the sketch in <file>\n");
+    fprintf(stdout, "                     instead of from a map. Repeat it to merge the sketches\n");
+    fprintf(stdout, "                     of disjoint parts of the same data. See README.\n");
+    fprintf(stdout, "  -shard <i/n>       Only sketch the i-th (from 0) of 'n' equal parts of\n");
+    fprintf(stdout, "                     the pairs, into the file given by '-sketch'. No engine\n");
+    fprintf(stdout, "                     is run. See README.\n");
+    fprintf(stdout, "  -merge <file>      Same as '-from-sketch', but all the pairs of the data\n");
+    fprintf(stdout, "                     must be covered. Repeat it once per shard.\n");
+    fprintf(stdout, "  -checkpoint <file> Periodically save the progress of the 'lowmem' engine\n");
+    fprintf(stdout, "                     into <file> (and on SIGTERM). Implies '-lowmem'. [\"\"]\n");
+    fprintf(stdout, "  -checkpoint-every <s>  Seconds between two checkpoints. [%d]\n", CKPT_INTERVAL);
+    fprintf(stdout, "  -resume <file>     Resume the run checkpointed in <file>, which must be\n");
+    fprintf(stdout, "                     started with the same arguments. [\"\"]\n");
+    fprintf(stdout, "  -tol <t>           Estimate the corr-dim progressively, from pairs taken\n");
+    fprintf(stdout, "                     in random blocks, and stop once the slope changes by\n");
+    fprintf(stdout, "                     less than <t> over the last %d refits. Implies\n", PROG_WINDOW);
+    fprintf(stdout, "                     '-lowmem'. See README. [0, ie, never]\n");
+    fprintf(stdout, "  -deadline <s>      Same, but stop after <s> seconds at the latest. [0, ie,\n");
+    fprintf(stdout, "                     never]\n");
+    fprintf(stdout, "  -metrics <file>    Write the time, CPU time, pairs and throughput of every\n");
+    fprintf(stdout, "                     phase of the run into <file>, as JSON. See README. [\"\"]\n");
+    fprintf(stdout, "  -timings           At the end, print the inclusive and exclusive times of\n");
+    fprintf(stdout, "                     all the timed regions, summed over the threads.\n");
+    fprintf(stdout, "  -perf-counters     Count the cycles, instructions, LLC misses and branch\n");
+    fprintf(stdout, "                     misses of every phase (see '-metrics') and print them\n");
+    fprintf(stdout, "                     at the end, along with the IPC and misses per pair.\n");
+    fprintf(stdout, "                     Ignored, with a warning, where there are no counters.\n");
+    fprintf(stdout, "  -trace <file>      Write the timeline of the phases, regions, worker tasks\n");
+    fprintf(stdout, "                     and reads into <file>, in the Chrome Trace Event format\n");
+    fprintf(stdout, "                     (for chrome://tracing or Perfetto). [\"\"]\n");
+    fprintf(stdout, "  -progress <s>      Every <s> seconds, print the progress of the current pass\n");
+    fprintf(stdout, "                     over the pairs, the pairs/s and the ETA on stderr. [0,\n");
+    fprintf(stdout, "                     ie, never]\n");
+    fprintf(stdout, "  -status <file>     Rewrite <file> with the progress (as JSON) instead of\n");
+    fprintf(stdout, "                     printing it. See README. [\"\"]\n");
+    fprintf(stdout, "  -ensemble <k>      Generate <k> trajectories of the map at once, from\n");
+    fprintf(stdout, "                     different initial values, and evaluate the corr-dim of\n");
+    fprintf(stdout, "                     every one of them (one per thread). Only for the maps\n");
+    fprintf(stdout, "                     with an ensemble mode. See README. [0, ie, just one]\n");
+    fprintf(stdout, "  -pooled            With '-ensemble', evaluate one corr-dim from the corr-sums\n");
+    fprintf(stdout, "                     averaged over all the trajectories instead.\n");
+    fprintf(stdout, "  -sweep <opt=start:stop:steps>  Evaluate the corr-dim for <steps> values\n");
+    fprintf(stdout, "                     of the option '-<opt>' of the map, evenly spaced from\n");
+    fprintf(stdout, "                     <start> to <stop> (eg: 'lambda=3.6:4:41'), one value per\n");
+    fprintf(stdout, "                     thread, and write one line per value. See README. [\"\"]\n");
     fprintf(stdout, "  -dump <file>       Dump 'log_r' and 'log_cr' arrays into <file>. [\"\"]\n");
     fprintf(stdout, "  -numpts <pts>      Number of 'R' for which correlation sum\n");
     fprintf(stdout, "                     needs to be evaluated. [%d]\n", NUM_POINTS);
-    fprintf(stdout, "  -numele <ele>      Number of elements in the trajectory. [%d]\n", NUM_ELEMENTS);
+    fprintf(stdout, "  -numele <ele>      Number of elements in the trajectory. [%d, or all of\n", NUM_ELEMENTS);
+    fprintf(stdout, "                     the file for CustomVectors]\n");
     fprintf(stdout, "  -discardl <pts>    Number of points on left side to be discarded before\n");
     fprintf(stdout, "                     doing the best-fit. [%d]\n", NUM_DISCARD_L);
     fprintf(stdout, "  -discardr <pts>    Number of points on right side to be discarded before\n");
@@ -75,23 +151,48 @@ CmdLine::CmdLine() {
     discardl = NUM_DISCARD_L;
     discardr = NUM_DISCARD_R;
     numPts = NUM_POINTS;
-    numEle = NUM_ELEMENTS;
+    numEle = -1;
     mapName = DEFAULT_MAP;
     dimension = 0;
     dump = "";
     distHist = "";
     numBins = NUM_BINS;
-    useLowMem = false;
+    engine = ENGINE_AUTO;
+    maxMem = 0;
+    serve = "";
+    batch = "";
+    batchOut = "";
+    numThreads = 0;
+    recalibrate = false;
+    pipeline = true;
+    sketch = "";
+    merge = false;
+    shard = 0;
+    numShards = 0;
+    checkpoint = "";
+    resume = "";
+    ckptInterval = CKPT_INTERVAL;
+    tol = 0;
+    deadline = 0;
+    metrics = "";
+    timings = false;
+    perfCounters = false;
+    trace = "";
+    progress = 0;
+    status = "";
+    ensemble = 0;
+    pooled = false;
+    sweepParam = "";
+    sweepStart = sweepStop = 0;
+    sweepSteps = 0;
     map = NULL;
     array = NULL;
-    list = listMaps();
+    list = MapRegistry::names();
 }
 
 void CmdLine::validateMap() {
-    for(vector<string>::const_iterator itr=list.begin();itr!=list.end();itr++) {
-        if(*itr == mapName) {
-            return;
-        }
+    if(MapRegistry::has(mapName)) {
+        return;
     }
     fprintf(stderr, "Bad map name specified '%s'!\n", mapName.c_str());
     exit(1);
@@ -101,7 +202,15 @@ void CmdLine::showHelp() {
     fprintf(stdout, "corrdim: Program to evaluate the correlation dimension from the\n");
     fprintf(stdout, "         points on a trajectory of a map.\n");
     fprintf(stdout, "USAGE:\n");
-    fprintf(stdout, " corrdim [-h] [-map <map>, -lowmem, -dump <file>, -numpts <pts>,\n");
+    fprintf(stdout, " corrdim [-h] [-map <map>, -engine <eng>, -lowmem, -maxmem <mb>,\n");
+    fprintf(stdout, "               -threads <n>, -calibrate, -serve <sock>, -batch <path>,\n");
+    fprintf(stdout, "               -batch-out <file>, -nopipeline, -sketch <file>,\n");
+    fprintf(stdout, "               -from-sketch <file>, -shard <i/n>, -merge <file>,\n");
+    fprintf(stdout, "               -checkpoint <file>, -checkpoint-every <s>, -resume <file>,\n");
+    fprintf(stdout, "               -tol <t>, -deadline <s>, -metrics <file>, -timings,\n");
+    fprintf(stdout, "               -perf-counters, -trace <file>, -progress <s>, -status <file>,\n");
+    fprintf(stdout, "               -ensemble <k>, -pooled, -sweep <opt=start:stop:steps>,\n");
+    fprintf(stdout, "               -dump <file>, -numpts <pts>,\n");
     fprintf(stdout, "               -numele <ele>, -discardl <pts>, -discardr <pts>,\n");
     fprintf(stdout, "               -dump-dist-hist <file>, -numbins <bins>]\n");
     fprintf(stdout, "          [... options specific for the maps ...]\n");
@@ -111,11 +220,79 @@ void CmdLine::showHelp() {
     for(vector<string>::const_iterator itr=list.begin();itr!=list.end();itr++) {
         fprintf(stdout, "                        . %s\n", itr->c_str());
     }
-    fprintf(stdout, "  -lowmem            Use the low-memory version of the 'CorrDim' class.\n");
+    fprintf(stdout, "  -engine <eng>      Engine evaluating the corr-dim. 'full' stores the whole\n");
+    fprintf(stdout, "                     distance matrix, 'lowmem' stores none of it, 'hybrid'\n");
+    fprintf(stdout, "                     stores as much as fits in memory and recomputes the rest\n");
+    fprintf(stdout, "                     on all threads. 'auto' chooses the fastest one which fits\n");
+    fprintf(stdout, "                     in memory, using a cost model. [auto]\n");
+    fprintf(stdout, "  -lowmem            Same as '-engine lowmem'.\n");
+    fprintf(stdout, "  -maxmem <mb>       Memory budget in MB. If the distance matrix doesn't fit\n");
+    fprintf(stdout, "                     inside it, only a part of it is stored and the rest is\n");
+    fprintf(stdout, "                     recomputed. [available memory]\n");
+    fprintf(stdout, "  -threads <n>       Number of worker threads for 'hybrid'. [all cores]\n");
+    fprintf(stdout, "  -calibrate         Redo the one-off calibration of the cost model.\n");
+    fprintf(stdout, "  -serve <sock>      Run as a server, answering jobs arriving on the Unix socket\n");
+    fprintf(stdout, "                     <sock> (or on stdin, if <sock> is '-'). See README. [\"\"]\n");
+    fprintf(stdout, "  -batch <path>      Evaluate every series in the file <path> (or in all the\n");
+    fprintf(stdout, "                     files in the directory <path>), one series per thread.\n");
+    fprintf(stdout, "                     See README. [\"\"]\n");
+    fprintf(stdout, "  -batch-out <file>  Write the results table of '-batch' into <file>. [stdout]\n");
+    fprintf(stdout, "  -nopipeline        Generate (or read) all the vectors before starting the\n");
+    fprintf(stdout, "                     engine, instead of overlapping the two.\n");
+    fprintf(stdout, "  -sketch <file>     Also save a compact pair-count sketch of the distances\n");
+    fprintf(stdout, "                     into <file>. This computes all the distances once\n");
+    fprintf(stdout, "                     more, after the engine: up to twice the run time.\n");
+    fprintf(stdout, "                     '-shard 0/1' saves only the sketch. [\"\"]\n");
+    fprintf(stdout, "  -from-sketch <file>  Evaluate the corr-dim from the sketch in <file>\n");
+    fprintf(stdout, "                     instead of from a map. Repeat it to merge the sketches\n");
+    fprintf(stdout, "                     of disjoint parts of the same data. See README.\n");
+    fprintf(stdout, "  -shard <i/n>       Only sketch the i-th (from 0) of 'n' equal parts of\n");
+    fprintf(stdout, "                     the pairs, into the file given by '-sketch'. No engine\n");
+    fprintf(stdout, "                     is run. See README.\n");
+    fprintf(stdout, "  -merge <file>      Same as '-from-sketch', but all the pairs of the data\n");
+    fprintf(stdout, "                     must be covered. Repeat it once per shard.\n");
+    fprintf(stdout, "  -checkpoint <file> Periodically save the progress of the 'lowmem' engine\n");
+    fprintf(stdout, "                     into <file> (and on SIGTERM). Implies '-lowmem'. [\"\"]\n");
+    fprintf(stdout, "  -checkpoint-every <s>  Seconds between two checkpoints. [%d]\n", CKPT_INTERVAL);
+    fprintf(stdout, "  -resume <file>     Resume the run checkpointed in <file>, which must be\n");
+    fprintf(stdout, "                     started with the same arguments. [\"\"]\n");
+    fprintf(stdout, "  -tol <t>           Estimate the corr-dim progressively, from pairs taken\n");
+    fprintf(stdout, "                     in random blocks, and stop once the slope changes by\n");
+    fprintf(stdout, "                     less than <t> over the last %d refits. Implies\n", PROG_WINDOW);
+    fprintf(stdout, "                     '-lowmem'. See README. [0, ie, never]\n");
+    fprintf(stdout, "  -deadline <s>      Same, but stop after <s> seconds at the latest. [0, ie,\n");
+    fprintf(stdout, "                     never]\n");
+    fprintf(stdout, "  -metrics <file>    Write the time, CPU time, pairs and throughput of every\n");
+    fprintf(stdout, "                     phase of the run into <file>, as JSON. See README. [\"\"]\n");
+    fprintf(stdout, "  -timings           At the end, print the inclusive and exclusive times of\n");
+    fprintf(stdout, "                     all the timed regions, summed over the threads.\n");
+    fprintf(stdout, "  -perf-counters     Count the cycles, instructions, LLC misses and branch\n");
+    fprintf(stdout, "                     misses of every phase (see '-metrics') and print them\n");
+    fprintf(stdout, "                     at the end, along with the IPC and misses per pair.\n");
+    fprintf(stdout, "                     Ignored, with a warning, where there are no counters.\n");
+    fprintf(stdout, "  -trace <file>      Write the timeline of the phases, regions, worker tasks\n");
+    fprintf(stdout, "                     and reads into <file>, in the Chrome Trace Event format\n");
+    fprintf(stdout, "                     (for chrome://tracing or Perfetto). [\"\"]\n");
+    fprintf(stdout, "  -progress <s>      Every <s> seconds, print the progress of the current pass\n");
+    fprintf(stdout, "                     over the pairs, the pairs/s and the ETA on stderr. [0,\n");
+    fprintf(stdout, "                     ie, never]\n");
+    fprintf(stdout, "  -status <file>     Rewrite <file> with the progress (as JSON) instead of\n");
+    fprintf(stdout, "                     printing it. See README. [\"\"]\n");
+    fprintf(stdout, "  -ensemble <k>      Generate <k> trajectories of the map at once, from\n");
+    fprintf(stdout, "                     different initial values, and evaluate the corr-dim of\n");
+    fprintf(stdout, "                     every one of them (one per thread). Only for the maps\n");
+    fprintf(stdout, "                     with an ensemble mode. See README. [0, ie, just one]\n");
+    fprintf(stdout, "  -pooled            With '-ensemble', evaluate one corr-dim from the corr-sums\n");
+    fprintf(stdout, "                     averaged over all the trajectories instead.\n");
+    fprintf(stdout, "  -sweep <opt=start:stop:steps>  Evaluate the corr-dim for <steps> values\n");
+    fprintf(stdout, "                     of the option '-<opt>' of the map, evenly spaced from\n");
+    fprintf(stdout, "                     <start> to <stop> (eg: 'lambda=3.6:4:41'), one value per\n");
+    fprintf(stdout, "                     thread, and write one line per value. See README. [\"\"]\n");
     fprintf(stdout, "  -dump <file>       Dump 'log_r' and 'log_cr' arrays into <file>. [\"\"]\n");
     fprintf(stdout, "  -numpts <pts>      Number of 'R' for which correlation sum\n");
     fprintf(stdout, "                     needs to be evaluated. [%d]\n", NUM_POINTS);
-    fprintf(stdout, "  -numele <ele>      Number of elements in the trajectory. [%d]\n", NUM_ELEMENTS);
+    fprintf(stdout, "  -numele <ele>      Number of elements in the trajectory. [%d, or all of\n", NUM_ELEMENTS);
+    fprintf(stdout, "                     the file for CustomVectors]\n");
     fprintf(stdout, "  -discardl <pts>    Number of points on left side to be discarded before\n");
     fprintf(stdout, "                     doing the best-fit. [%d]\n", NUM_DISCARD_L);
     fprintf(stdout, "  -discardr <pts>    Number of points on right side to be discarded before\n");
@@ -134,15 +311,81 @@ void CmdLine::showHelp() {
 void CmdLine::printParams() {
     fprintf(stdout, "PARAMETERS: numPts=%d discardl=%d discardr=%d\n", numPts, discardl, discardr);
     fprintf(stdout, "PARAMETERS: dump=%s map=%s\n", dump.c_str(), mapName.c_str());
+    if(maxMem > 0) {
+        fprintf(stdout, "PARAMETERS: maxmem=%dMB\n", maxMem);
+    }
+    fprintf(stdout, "PARAMETERS: engine=%s%s threads=%d predictedTime=%fs predictedMem=%lukB\n",
+            engineName(plan.engine), (plan.automatic? "(auto)" : ""), plan.threads,
+            plan.predTime, plan.predMem >> 10);
+}
+
+void CmdLine::planEngine() {
+    CostModel model(recalibrate);
+    plan = model.plan(engine, numEle, dimension, numPts, numBins,
+                      (unsigned long int) maxMem << 20, numThreads);
 }
 
 void CmdLine::validateInputs() {
+    validateParams();
+    if(ensemble > 0) {
+        if((sketch != "") || (numShards > 0) || (checkpoint != "") || (resume != "") || progressive()) {
+            fprintf(stderr, "'-ensemble' can't be used along with '-sketch', '-shard', '-checkpoint', "
+                    "'-resume', '-tol' or '-deadline'!\n");
+            exit(1);
+        }
+        if(!pooled && ((dump != "") || (distHist != ""))) {
+            fprintf(stderr, "'-dump' and '-dump-dist-hist' need '-pooled' along with '-ensemble'!\n");
+            exit(1);
+        }
+    }
+    else if(pooled) {
+        fprintf(stderr, "'-pooled' needs '-ensemble'!\n");
+        exit(1);
+    }
+    if(sweepSteps > 0) {
+        if((ensemble > 0) || (sketch != "") || (numShards > 0) || (checkpoint != "") || (resume != "") ||
+           progressive() || (dump != "") || (distHist != "")) {
+            fprintf(stderr, "'-sweep' can't be used along with '-ensemble', '-sketch', '-shard', "
+                    "'-checkpoint', '-resume', '-tol', '-deadline', '-dump' or '-dump-dist-hist'!\n");
+            exit(1);
+        }
+    }
+    if((checkpoint != "") || (resume != "")) {
+        if((engine != ENGINE_AUTO) && (engine != ENGINE_LOWMEM)) {
+            fprintf(stderr, "Checkpoints are supported only by the 'lowmem' engine!\n");
+            exit(1);
+        }
+        engine = ENGINE_LOWMEM;
+    }
+    if(progressive()) {
+        if((engine != ENGINE_AUTO) && (engine != ENGINE_LOWMEM)) {
+            fprintf(stderr, "'-tol' and '-deadline' are supported only by the 'lowmem' engine!\n");
+            exit(1);
+        }
+        if((checkpoint != "") || (resume != "") || (distHist != "")) {
+            fprintf(stderr, "'-tol' and '-deadline' can't be used along with '-checkpoint', "
+                    "'-resume' or '-dump-dist-hist'!\n");
+            exit(1);
+        }
+        engine = ENGINE_LOWMEM;
+    }
+    validateMap();
+    map = MapRegistry::create(mapName);
+    // maps reading files know their own length, where 0 means all of it
+    if(numEle < 0) {
+        numEle = map->sizedByInput()? 0 : NUM_ELEMENTS;
+    }
+    else if((numEle == 0) && !map->sizedByInput()) {
+        fprintf(stderr, "Argument to '-numele' must be positive!\n");
+        exit(1);
+    }
+}
+
+void CmdLine::validateParams() {
     CHECK_POSITIVE(numPts, "-numpts");
     CHECK_POSITIVE(numBins, "-numbins");
-    CHECK_POSITIVE(numEle, "-numele");
     CHECK_POSITIVE(discardl, "-discardl");
     CHECK_POSITIVE(discardr, "-discardr");
-    validateMap();
     if(discardl >= (numPts>>1)) {
         fprintf(stderr, "Argument to '-discardl' should be less than half the arg to '-numpts'!\n");
         exit(1);
@@ -151,6 +394,5 @@ void CmdLine::validateInputs() {
         fprintf(stderr, "Argument to '-discardr' should be less than half the arg to '-numpts'!\n");
         exit(1);
     }
-    map = getMap(mapName);
 }
 
@@ -27,6 +27,9 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "basics.h"
 #include "maps/ChaoticMap.h"
+#include "CostModel.h"
+#include "Checkpoint.h"
+#include "Progress.h"
 
 
 /** default value of number of points to be discarded on log(CR) vs log(R) graph from the left most point */
@@ -65,13 +68,43 @@ public:
     int discardl;    ///< number of points to be discarded from the left
     int discardr;    ///< number of points to be discarded from the right
     int numPts;      ///< number of points on the log(CR) vs log(R) plot
-    int numEle;      ///< number of points to be considered from the chaotic map
+    int numEle;      ///< number of points to be considered from the chaotic map (-1 until given)
     std::string mapName;  ///< map to be used
     int dimension;        ///< dimension of the map
     std::string dump;     ///< file name where to dump the log(CR) vs log(R) plot values
     std::string distHist; ///< file name where to dump the distance matrix histogram
     int numBins;          ///< number of bins in the histogram
-    bool useLowMem;       ///< whether to use CorrDimLowMem or not
+    EngineType engine;    ///< engine asked for (ENGINE_AUTO lets the cost model choose)
+    int maxMem;           ///< memory budget in MB (0 means unlimited)
+    int numThreads;       ///< number of worker threads (0 means all cores)
+    bool recalibrate;     ///< whether to redo the cost model calibration
+    std::string serve;    ///< socket to serve the jobs on ('-' is stdin). Empty means one-shot run
+    std::string batch;    ///< file (or directory) with the series for batch mode
+    std::string batchOut; ///< file where to write the batch results (empty means stdout)
+    bool pipeline;        ///< whether the engine works on the vectors while they're being generated
+    std::string sketch;   ///< file where to save the pair-count sketch (empty means none)
+    std::vector<std::string> fromSketch; ///< sketches to work from, instead of a map
+    bool merge;           ///< whether the sketches must hold all the pairs of the data
+    int shard;            ///< shard to be evaluated (counting from 0)
+    int numShards;        ///< number of shards (0 means no sharding)
+    std::string checkpoint; ///< file where to checkpoint the 'lowmem' engine (empty means none)
+    std::string resume;   ///< checkpoint to resume the 'lowmem' engine from (empty means none)
+    int ckptInterval;     ///< seconds between two checkpoints
+    REAL tol;             ///< tolerance on the slope of the progressive estimator (0 means none)
+    REAL deadline;        ///< seconds allowed to the progressive estimator (0 means none)
+    std::string metrics;  ///< file where to write the metrics of the run (empty means none)
+    bool timings;         ///< whether to print the tree of timed regions at the end
+    bool perfCounters;    ///< whether to charge the hardware performance counters to the phases
+    std::string trace;    ///< file where to write the timeline of the run (empty means none)
+    int progress;         ///< seconds between two progress reports (0 means none)
+    std::string status;   ///< file where to write the progress reports (empty means stderr)
+    int ensemble;         ///< number of trajectories generated together (0 means just one)
+    bool pooled;          ///< whether the trajectories of the ensemble are pooled into one corr-dim
+    std::string sweepParam; ///< option of the map to be swept (without the '-')
+    REAL sweepStart;      ///< first value of the swept option
+    REAL sweepStop;       ///< last value of the swept option
+    int sweepSteps;       ///< number of values of the swept option (0 means no sweep)
+    EnginePlan plan;      ///< engine actually used, along with its predicted cost
     ChaoticMap* map;      ///< pointer to the map to be used
     REAL* array;          ///< pointer to the element array from the map
     std::vector<std::string> list;   ///< list of all maps currently supported
@@ -98,6 +131,25 @@ public:
      */
     void validateInputs();
 
+    /**
+     * @brief Checks the parameters which are common to all the modes
+     */
+    void validateParams();
+
+    /**
+     * @brief Chooses the engine using the cost model
+     *
+     * This must be called only after the vectors have been generated, as
+     * the dimension of the vectors is needed.
+     */
+    void planEngine();
+
+    /**
+     * @brief Whether the progressive estimator is asked for
+     * @return true if '-tol' or '-deadline' was passed
+     */
+    bool progressive() const { return (tol > 0) || (deadline > 0); }
+
 
 private:
     /**
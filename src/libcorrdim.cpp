@@ -0,0 +1,167 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "libcorrdim.h"
+#include "cmdline.h"
+#include "CorrDim.h"
+#include "CorrDimLowMem.h"
+#include "CorrDimHybrid.h"
+#include "SysInfo.h"
+#include <cmath>
+#include <new>
+
+
+using namespace std;
+
+
+const char* corrDimError(CorrDimStatus st) {
+    switch(st) {
+    case CORRDIM_OK:          return "success";
+    case CORRDIM_BAD_DATA:    return "bad input data (NULL, non-finite values, less than 2 vectors or bad dimension)";
+    case CORRDIM_BAD_PARAMS:  return "bad parameters (numPts, numBins, discardl, discardr or engine)";
+    case CORRDIM_NO_MEMORY:   return "out of memory";
+    case CORRDIM_DEGENERATE:  return "all the vectors are identical";
+    default:                  return "internal error";
+    }
+}
+
+
+void corrDimDefaults(CorrDimParams& params) {
+    params.numPts = NUM_POINTS;
+    params.discardl = NUM_DISCARD_L;
+    params.discardr = NUM_DISCARD_R;
+    params.numBins = NUM_BINS;
+    params.engine = ENGINE_AUTO;
+    params.maxMem = 0;
+}
+
+
+/**
+ * @brief Runs the given engine and fills up the results
+ * @param cd the engine.
+ * @param params the parameters.
+ * @param result the results.
+ */
+template <typename Engine>
+static void evaluate(Engine& cd, const CorrDimParams& params, CorrDimResult& result) {
+    result.dimension = cd.evalCorrDim(params.numPts, params.discardl, params.discardr,
+                                      &(result.log_cr[0]), &(result.log_r[0]),
+                                      &(result.inter[0]));
+    // only the points used for the fit
+    int n = params.numPts - (params.discardl + params.discardr);
+    REAL sum = 0;
+    for(int i=params.discardl;i<params.discardl+n;i++) {
+        REAL diff = result.log_cr[i] - result.inter[i];
+        sum += diff * diff;
+    }
+    result.residual = (REAL) sqrt(sum / n);
+    if(params.numBins > 0) {
+        cd.getDistMatrixHistogram(params.numBins, &(result.hist[0]), &(result.bins[0]));
+    }
+}
+
+
+CorrDimStatus corrDimEvaluate(const CorrDimView& view, const CorrDimParams& params,
+                              CorrDimResult& result, ThreadPool* pool/*=NULL*/,
+                              CorrDimArena* arena/*=NULL*/) {
+    if((view.data == NULL) || (view.numVec < 2) || (view.dim < 1)) {
+        return CORRDIM_BAD_DATA;
+    }
+    if((params.numPts <= 0) || (params.numBins < 0) ||
+       (params.discardl < 0) || (params.discardl >= (params.numPts>>1)) ||
+       (params.discardr < 0) || (params.discardr >= (params.numPts>>1)) ||
+       (params.engine < ENGINE_AUTO) || (params.engine >= ENGINE_COUNT)) {
+        return CORRDIM_BAD_PARAMS;
+    }
+    unsigned long int numEle = (unsigned long int) view.numVec * view.dim;
+    for(unsigned long int j=0;j<numEle;j++) {
+        if(!std::isfinite(view.data[j])) {
+            return CORRDIM_BAD_DATA;
+        }
+    }
+    // no non-zero distance to work with, 'R' would be meaningless
+    unsigned long int i = view.dim;
+    while((i < numEle) && (view.data[i] == view.data[i % view.dim])) {
+        i++;
+    }
+    if(i == numEle) {
+        return CORRDIM_DEGENERATE;
+    }
+    int threads = (pool == NULL)? 1 : pool->size();
+    unsigned long int budget = params.maxMem;
+    if(budget == 0) {
+        budget = (unsigned long int) (availableMemory() * MEM_SAFETY);
+    }
+    // the signal is owned by the caller, don't count it
+    unsigned long int base = baseMemory(view.numVec, 0, params.numPts, params.numBins);
+    result.engine = (params.engine == ENGINE_AUTO)? ENGINE_HYBRID : params.engine;
+    try {
+        result.log_r.resize(params.numPts);
+        result.log_cr.resize(params.numPts);
+        result.inter.resize(params.numPts);
+        result.hist.resize((params.numBins > 0)? params.numBins : 1);
+        result.bins.resize((params.numBins > 0)? params.numBins : 1);
+        if(result.engine == ENGINE_FULL) {
+            result.memory = base + distMatrixMemory(view.numVec);
+            if((params.maxMem > 0) && (result.memory > params.maxMem)) {
+                return CORRDIM_NO_MEMORY;
+            }
+            REAL* dist = NULL;
+            if(arena != NULL) {
+                if(arena->dist.size() < TRI(view.numVec)) {
+                    arena->dist.resize(TRI(view.numVec));
+                }
+                dist = &(arena->dist[0]);
+            }
+            CorrDim cd(view.data, view.numVec, view.dim, dist);
+            evaluate(cd, params, result);
+        }
+        else if(result.engine == ENGINE_LOWMEM) {
+            result.memory = base;
+            CorrDimLowMem cd(view.data, view.numVec, view.dim);
+            evaluate(cd, params, result);
+        }
+        else {
+            unsigned long int over = base + hybridOverhead(view.numVec, threads);
+            if((params.maxMem > 0) && (over > params.maxMem)) {
+                return CORRDIM_NO_MEMORY;
+            }
+            unsigned long int tiles = (budget > over)? budget - over : 0;
+            REAL* buf = NULL;
+            if(arena != NULL) {
+                unsigned long int size = CorrDimHybrid::bufferSize(view.numVec, tiles, threads);
+                if(arena->tiles.size() < size) {
+                    arena->tiles.resize(size);
+                }
+                buf = &(arena->tiles[0]);
+            }
+            CorrDimHybrid cd(view.data, view.numVec, view.dim, tiles, pool, NULL, buf);
+            result.memory = over + cd.storedBytes();
+            evaluate(cd, params, result);
+        }
+    }
+    catch(bad_alloc&) {
+        return CORRDIM_NO_MEMORY;
+    }
+    catch(...) {
+        return CORRDIM_INTERNAL;
+    }
+    return CORRDIM_OK;
+}
@@ -0,0 +1,131 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+#ifndef __INCLUDED_LIBCORRDIM_H__
+#define __INCLUDED_LIBCORRDIM_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "basics.h"
+#include "CostModel.h"
+#include "ThreadPool.h"
+
+
+/**
+ * Status codes returned by the library. None of the library calls ever
+ * terminate the process.
+ */
+enum CorrDimStatus {
+    CORRDIM_OK = 0,          ///< success
+    CORRDIM_BAD_DATA,        ///< NULL data, non-finite values, less than 2 vectors or bad dimension
+    CORRDIM_BAD_PARAMS,      ///< bad numPts, numBins, discardl, discardr or engine
+    CORRDIM_NO_MEMORY,       ///< an allocation failed (or doesn't fit in 'maxMem')
+    CORRDIM_DEGENERATE,      ///< all the vectors are the same, no distances to work with
+    CORRDIM_INTERNAL         ///< any other failure (eg: threads could not be spawned)
+};
+
+/**
+ * @brief Human readable message for the given status
+ * @param st the status
+ * @return the message
+ */
+const char* corrDimError(CorrDimStatus st);
+
+
+/**
+ * Non-owning view of the input vectors. Nothing is copied, the library
+ * only reads from 'data' for the duration of the call.
+ */
+struct CorrDimView {
+    const REAL* data;   ///< numVec x dim matrix, flattened out in row-major order
+    int numVec;         ///< number of vectors
+    int dim;            ///< dimension of one vector
+};
+
+/**
+ * Parameters of one evaluation. Use 'corrDimDefaults' to fill in the same
+ * defaults as the commandline tool.
+ */
+struct CorrDimParams {
+    int numPts;          ///< number of points on the log(CR) vs log(R) plot
+    int discardl;        ///< points to be discarded from the left for best-fit
+    int discardr;        ///< points to be discarded from the right for best-fit
+    int numBins;         ///< bins in the distance matrix histogram (0 skips it)
+    EngineType engine;   ///< engine to be used (ENGINE_AUTO uses 'hybrid')
+    unsigned long int maxMem;  ///< memory budget (in B) for the engine. 0 means available memory
+};
+
+/**
+ * Results of one evaluation. This is meant to be reused across calls: the
+ * arrays are only resized, so once they've grown to the needed size, there
+ * are no more allocations for them.
+ */
+struct CorrDimResult {
+    REAL dimension;               ///< the correlation dimension
+    REAL residual;                ///< RMS distance of the fitted log(C(R)) from the best-fit line
+    std::vector<REAL> log_r;      ///< log(R) values
+    std::vector<REAL> log_cr;     ///< log(C(R)) values
+    std::vector<REAL> inter;      ///< best-fit log(C(R)) values
+    std::vector<int> hist;        ///< distance matrix histogram
+    std::vector<REAL> bins;       ///< value of each histogram bin
+    EngineType engine;            ///< engine which was actually used
+    unsigned long int memory;     ///< memory (in B) used by the engine
+};
+
+
+/**
+ * Scratch memory of the engines, which can be kept across calls by a
+ * caller running many small evaluations back to back (one per thread).
+ * Like 'CorrDimResult', it only ever grows.
+ */
+struct CorrDimArena {
+    std::vector<REAL> dist;       ///< distance matrix of the 'full' engine
+    std::vector<REAL> tiles;      ///< tiles and scratch rows of the 'hybrid' engine
+};
+
+
+/**
+ * @brief Fills the parameters with the commandline defaults
+ * @param params the parameters
+ */
+void corrDimDefaults(CorrDimParams& params);
+
+/**
+ * @brief Evaluates the correlation dimension of the given vectors
+ * @param view the input vectors (not copied, not freed).
+ * @param params the parameters.
+ * @param result will contain the results.
+ * @param pool workers for the 'hybrid' engine. NULL means the calling
+ *  thread alone. The same pool can be used across calls.
+ * @param arena scratch memory to be reused. NULL means allocate afresh.
+ * @return the status. 'result' is valid only on CORRDIM_OK.
+ *
+ * The engine for ENGINE_AUTO is 'hybrid', which stores as much of the
+ * distance matrix as fits inside 'maxMem' and recomputes the rest.
+ */
+CorrDimStatus corrDimEvaluate(const CorrDimView& view, const CorrDimParams& params,
+                              CorrDimResult& result, ThreadPool* pool=NULL,
+                              CorrDimArena* arena=NULL);
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_LIBCORRDIM_H__
@@ -0,0 +1,151 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+
+#include "ChaoticFlow.h"
+#include "MemTrack.h"
+
+
+int ChaoticFlow::generateChunk(REAL* out, int numVec) {
+    if(!m_settled) {
+        advance(m_x, m_y, m_z, (long int) m_transient * m_stride);
+        m_settled = true;
+    }
+    int j = 0;
+    for(int i=0;i<numVec;i++,j+=3) {
+        advance(m_x, m_y, m_z, m_stride);
+        out[j] = m_x;
+        out[j+1] = m_y;
+        out[j+2] = m_z;
+    }
+    return numVec;
+}
+
+void ChaoticFlow::showFlowHelp() {
+    fprintf(stdout, "  -dt <dt>         Integration step. [%f]\n", FLOW_DT);
+    fprintf(stdout, "  -stride <n>      Integration steps between two vectors. [%d]\n", FLOW_STRIDE);
+    fprintf(stdout, "  -transient <n>   Vectors discarded at the start. [%d]\n", FLOW_TRANSIENT);
+    fprintf(stdout, "  -x0 <x0>         Initial x-value for the flow. [%f]\n", FLOW_X0);
+    fprintf(stdout, "  -y0 <y0>         Initial y-value for the flow. [%f]\n", FLOW_X0);
+    fprintf(stdout, "  -z0 <z0>         Initial z-value for the flow. [%f]\n", FLOW_X0);
+}
+
+void ChaoticFlow::parseOptions(int numEle, int pos, int argc, char** argv) {
+    REAL dt = FLOW_DT;
+    int stride = FLOW_STRIDE;
+    int transient = FLOW_TRANSIENT;
+    REAL x0 = FLOW_X0;
+    REAL y0 = FLOW_X0;
+    REAL z0 = FLOW_X0;
+    for(;pos<argc;pos++) {
+        if(!strcmp("-help", argv[pos])) {
+            this->showHelp();
+        }
+        else if(!strcmp("-dt", argv[pos])) {
+            OPTION_CHECK("-dt", pos, argc);
+            GET_NUMBER(dt, "-dt", argv[pos]);
+        }
+        else if(!strcmp("-stride", argv[pos])) {
+            OPTION_CHECK("-stride", pos, argc);
+            GET_INTEGER(stride, "-stride", argv[pos]);
+        }
+        else if(!strcmp("-transient", argv[pos])) {
+            OPTION_CHECK("-transient", pos, argc);
+            GET_INTEGER(transient, "-transient", argv[pos]);
+        }
+        else if(!strcmp("-x0", argv[pos])) {
+            OPTION_CHECK("-x0", pos, argc);
+            GET_NUMBER(x0, "-x0", argv[pos]);
+        }
+        else if(!strcmp("-y0", argv[pos])) {
+            OPTION_CHECK("-y0", pos, argc);
+            GET_NUMBER(y0, "-y0", argv[pos]);
+        }
+        else if(!strcmp("-z0", argv[pos])) {
+            OPTION_CHECK("-z0", pos, argc);
+            GET_NUMBER(z0, "-z0", argv[pos]);
+        }
+        else if(!parseParam(pos, argc, argv)) {
+            fprintf(stderr, "Unknown option passed '%s'!\n", argv[pos]);
+            fatalExit(1);
+        }
+    }
+    CHECK_POSITIVE(dt, "-dt");
+    CHECK_POSITIVE(stride, "-stride");
+    if(transient < 0) {
+        fprintf(stderr, "Argument to '-transient' must not be negative!\n");
+        fatalExit(1);
+    }
+    fprintf(stdout, "PARAMETERS: numEle=%d ", numEle);
+    printParams();
+    fprintf(stdout, "dt=%f stride=%d transient=%d x0=%f y0=%f z0=%f\n", dt, stride, transient,
+            x0, y0, z0);
+    m_dt = dt;
+    m_stride = stride;
+    m_transient = transient;
+    m_settled = false;
+    m_x = x0;
+    m_y = y0;
+    m_z = z0;
+}
+
+REAL* ChaoticFlow::generateVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating numbers from %s... ", m_name);
+    TimerScope tim(m_name, "Time taken: %f s\n");
+    REAL* arr = MemTrack::allocate<REAL>((unsigned long int) numEle * 3, MEM_VECTORS);
+    generateChunk(arr, numEle);
+    tim.stop();
+    return arr;
+}
+
+REAL* ChaoticFlow::generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating %d trajectories from %s... ", numTraj, m_name);
+    TimerScope tim(m_name, "Time taken: %f s\n");
+    int stride = ensembleStride(numTraj);
+    unsigned long int rowLen = (unsigned long int) stride * 3;
+    REAL* arr = MemTrack::allocate<REAL>(numEle * rowLen, MEM_VECTORS);
+    // the lanes don't depend on each other, so every group goes all the way at once
+    for(int k=0;k<stride;k+=ENSEMBLE_LANES) {
+        LaneVec x, y, z;
+        for(int l=0;l<ENSEMBLE_LANES;l++) {
+            x[l] = m_x + ((k + l) * FLOW_STEP);
+            y[l] = m_y;
+            z[l] = m_z;
+        }
+        advanceLanes(x, y, z, (long int) m_transient * m_stride);
+        REAL* row = arr + k;
+        for(int t=0;t<numEle;t++,row+=rowLen) {
+            advanceLanes(x, y, z, m_stride);
+            *(LaneVec*) row = x;
+            *(LaneVec*) (row + stride) = y;
+            *(LaneVec*) (row + 2 * stride) = z;
+        }
+    }
+    tim.stop();
+    return arr;
+}
+
+REAL* ChaoticFlow::startVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating numbers from %s... in the background\n", m_name);
+    return startChunks(numEle);
+}
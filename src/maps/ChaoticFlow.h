@@ -0,0 +1,193 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#ifndef __INCLUDED_CHAOTICFLOW_H__
+#define __INCLUDED_CHAOTICFLOW_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "ChaoticMap.h"
+
+
+/** default integration step of the flows */
+#define FLOW_DT          0.01
+/** default number of integration steps between two vectors */
+#define FLOW_STRIDE      10
+/** default number of vectors discarded, while the trajectory settles on the attractor */
+#define FLOW_TRANSIENT   1000
+/** default initial value of all the three coordinates */
+#define FLOW_X0          1.0
+/** step between the initial 'x' of two trajectories, in ensemble mode */
+#define FLOW_STEP        1e-3
+
+
+/**
+ * Base class for the continuous flows in 3 dimensions, integrated with the
+ * classic 4th order Runge-Kutta method at a fixed step '-dt'. One vector is
+ * kept every '-stride' steps, after throwing away the first '-transient' of
+ * them. The derived classes only supply the right-hand side of the system,
+ * through 'advance' and 'advanceLanes', which usually just call 'rk4' with
+ * the same function object. This way, the ensembles run through exactly the
+ * same arithmetic, ENSEMBLE_LANES trajectories at a time.
+ */
+class ChaoticFlow : public ChaoticMap {
+public:
+    /**
+     * @brief Constructor of this class.
+     * @param name name of the flow (for the messages)
+     */
+    ChaoticFlow(const char* name): m_name(name), m_settled(false) {}
+
+    /**
+     * @brief generate the first 'numEle' vectors from this flow
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the desired vector
+     */
+    REAL* generateVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Same as 'generateVectors', but the vectors are generated in the
+     *  background, while the engines work on the first ones
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the desired vector (see 'getStream')
+     */
+    REAL* startVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Generates the next vectors of this flow (the very first call
+     *  also goes through the transient)
+     * @param out where to write the vectors.
+     * @param numVec number of vectors wanted.
+     * @return number of vectors written (always 'numVec')
+     */
+    int generateChunk(REAL* out, int numVec);
+
+    /**
+     * @brief Generates 'numTraj' trajectories at once, ENSEMBLE_LANES at a
+     *  time, starting from ('x0', 'y0', 'z0'), 'x0' moving by FLOW_STEP from
+     *  one to the next
+     * @param numEle number of vectors per trajectory.
+     * @param numTraj number of trajectories.
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the trajectories (see 'ChaoticMap::laneVectors')
+     *
+     * Every group of lanes is integrated from its initial values to its last
+     * vector in one go, with its state kept in registers.
+     */
+    REAL* generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv);
+
+    /**
+     * @brief Tells the dimension of each vector for this flow
+     * @return dimension
+     */
+    int getDimension() { return 3; }
+
+protected:
+    /**
+     * @brief Parses one option specific to the flow
+     * @param pos position of the option in 'argv' (moved past its argument).
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return false if there's no such option
+     */
+    virtual bool parseParam(int& pos, int argc, char** argv) = 0;
+
+    /**
+     * @brief Prints the parameters specific to the flow, on the 'PARAMETERS' line
+     */
+    virtual void printParams() = 0;
+
+    /**
+     * @brief Integrates one trajectory
+     * @param x, y, z the state (updated).
+     * @param steps number of steps.
+     */
+    virtual void advance(REAL& x, REAL& y, REAL& z, long int steps) = 0;
+
+    /**
+     * @brief Integrates ENSEMBLE_LANES trajectories at once
+     * @param x, y, z the states (updated).
+     * @param steps number of steps.
+     */
+    virtual void advanceLanes(LaneVec& x, LaneVec& y, LaneVec& z, long int steps) = 0;
+
+    /**
+     * @brief Prints the help on the options common to all the flows
+     */
+    void showFlowHelp();
+
+    /**
+     * @brief Integrates the system 'f' with the classic Runge-Kutta method
+     * @param x, y, z the state (REAL or LaneVec, updated).
+     * @param steps number of steps of size 'm_dt'.
+     * @param f the right-hand side, as 'f(x, y, z, dx, dy, dz)'.
+     */
+    template <typename V, typename F>
+    void rk4(V& x, V& y, V& z, long int steps, const F& f) const {
+        REAL h = m_dt;
+        REAL h2 = m_dt / 2;
+        REAL h6 = m_dt / 6;
+        V k1x, k1y, k1z, k2x, k2y, k2z, k3x, k3y, k3z, k4x, k4y, k4z;
+        for(long int s=0;s<steps;s++) {
+            f(x, y, z, k1x, k1y, k1z);
+            f(x + h2 * k1x, y + h2 * k1y, z + h2 * k1z, k2x, k2y, k2z);
+            f(x + h2 * k2x, y + h2 * k2y, z + h2 * k2z, k3x, k3y, k3z);
+            f(x + h * k3x, y + h * k3y, z + h * k3z, k4x, k4y, k4z);
+            x += h6 * (k1x + 2 * (k2x + k3x) + k4x);
+            y += h6 * (k1y + 2 * (k2y + k3y) + k4y);
+            z += h6 * (k1z + 2 * (k2z + k3z) + k4z);
+        }
+    }
+
+private:
+    /**
+     * @brief Parses the options of this flow and prints them
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     */
+    void parseOptions(int numEle, int pos, int argc, char** argv);
+
+private:
+    const char* m_name;  ///< name of the flow
+    REAL m_dt;       ///< integration step
+    int m_stride;    ///< integration steps between two vectors
+    int m_transient; ///< vectors discarded at the start
+    bool m_settled;  ///< whether the transient is over
+    REAL m_x;        ///< current x-value of the flow
+    REAL m_y;        ///< current y-value of the flow
+    REAL m_z;        ///< current z-value of the flow
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_CHAOTICFLOW_H__
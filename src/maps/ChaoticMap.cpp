@@ -0,0 +1,125 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#include "ChaoticMap.h"
+#include "Metrics.h"
+#include "MemTrack.h"
+#include "Trace.h"
+#include <climits>
+#include <algorithm>
+
+
+
+
+bool MapRegistry::add(const char* name, MapFactory factory) {
+    maps()[name] = factory;
+    return true;
+}
+
+ChaoticMap* MapRegistry::create(const std::string& name) {
+    std::unordered_map<std::string, MapFactory>::const_iterator itr = maps().find(name);
+    return (itr == maps().end())? NULL : itr->second();
+}
+
+bool MapRegistry::has(const std::string& name) {
+    return maps().count(name) > 0;
+}
+
+std::vector<std::string> MapRegistry::names() {
+    std::vector<std::string> list;
+    for(std::unordered_map<std::string, MapFactory>::const_iterator itr=maps().begin();itr!=maps().end();itr++) {
+        list.push_back(itr->first);
+    }
+    std::sort(list.begin(), list.end());
+    return list;
+}
+
+std::unordered_map<std::string, MapFactory>& MapRegistry::maps() {
+    static std::unordered_map<std::string, MapFactory> s_maps;
+    return s_maps;
+}
+
+
+void ChaoticMap::laneVectors(const REAL* arr, int numTraj, int traj, int numEle, int dim, REAL* out) {
+    unsigned long int stride = ensembleStride(numTraj);
+    unsigned long int num = (unsigned long int) numEle * dim;
+    const REAL* in = arr + traj;
+    for(unsigned long int i=0;i<num;i++,in+=stride) {
+        out[i] = *in;
+    }
+}
+
+void ChaoticMap::releaseVectors(REAL* arr) {
+    if((m_stream != NULL) && (arr == m_stream->data())) {
+        closeStream();
+        return;
+    }
+    MemTrack::release(arr);
+}
+
+
+REAL* ChaoticMap::startChunks(int& numEle) {
+    m_stream = new VectorStream(getDimension(), numEle);
+    m_producer = std::thread(&ChaoticMap::produce, this, numEle);
+    if(numEle > 0) {
+        return m_stream->data();
+    }
+    m_producer.join();
+    unsigned long int numVec = m_stream->numVectors();
+    if(numVec > INT_MAX) {
+        fprintf(stderr, "Input has too many vectors (%lu), use '-numele'!\n", numVec);
+        fatalExit(1);
+    }
+    numEle = (int) numVec;
+    return m_stream->data();
+}
+
+
+void ChaoticMap::produce(int numEle) {
+    Trace::nameThread("producer");
+    TimerScope tim("produce");
+    REAL wall = wallTime();
+    REAL cpu = Metrics::threadCpuTime();
+    int dim = getDimension();
+    unsigned long int left = (numEle > 0)? numEle : ULONG_MAX;
+    while(left > 0) {
+        int want = (left < CHUNK_VECTORS)? (int) left : CHUNK_VECTORS;
+        int got = generateChunk(m_stream->reserve((unsigned long int) want * dim), want);
+        m_stream->commit((unsigned long int) got * dim);
+        left -= got;
+        if(got < want) {
+            break;
+        }
+    }
+    m_prodWall = wallTime() - wall;
+    m_prodCpu = Metrics::threadCpuTime() - cpu;
+    m_stream->finish();
+}
+
+
+void ChaoticMap::closeStream() {
+    if(m_producer.joinable()) {
+        m_producer.join();
+    }
+    if(m_stream != NULL) {
+        delete m_stream;
+        m_stream = NULL;
+    }
+}
@@ -27,32 +27,133 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 #include "basics.h"
 #include "Timer.h"
+#include "VectorStream.h"
+#include <thread>
+#include <unordered_map>
+
+
+/** number of vectors generated at a time, when they are produced in chunks */
+#define CHUNK_VECTORS   4096
+/** trajectories advanced by one vector instruction, in ensemble mode */
+#define ENSEMBLE_LANES  4
+/** step between the first values of two trajectories, for the maps on (0,1) */
+#define ENSEMBLE_STEP   0.6180339887498949
+
+
+/**
+ * One value of ENSEMBLE_LANES trajectories (a GCC vector). Arithmetic on it
+ * works lane by lane. It needs no more alignment than REAL, so it can be
+ * loaded from (and stored to) anywhere in an ensemble.
+ */
+typedef REAL LaneVec __attribute__((vector_size(ENSEMBLE_LANES * sizeof(REAL)), aligned(sizeof(REAL))));
 
 
 /**
  * Base class to generate numbers from the a chaotic map.
+ *
+ * Maps can also generate their vectors piece by piece ('generateChunk'). In
+ * that case, 'startVectors' hands the vectors over to the engines while they
+ * are still being generated on a thread of their own. Since row 'i' of the
+ * distance matrix needs only the vectors 0..i, the engines work on the
+ * first vectors while the rest are being produced.
  */
 class ChaoticMap {
 public:
     /**
      * @brief Constructor of this class.
      */
-    ChaoticMap() {}
+    ChaoticMap(): m_stream(NULL), m_prodWall(0), m_prodCpu(0) {}
 
     /**
-     * @brief Destructor of this class.
+     * @brief Destructor of this class. Waits for the generating thread, if any.
      */
-    virtual ~ChaoticMap() {}
+    virtual ~ChaoticMap() { closeStream(); }
 
     /**
      * @brief generate the first 'numEle' vectors from this ChaoticMap
-     * @param numEle number of elements in the output vector
+     * @param numEle number of elements in the output vector. For maps which
+     *  are sized by their input (see 'sizedByInput'), 0 means all of it. On
+     *  return, this contains the number of vectors actually generated.
      * @param pos start of the arguments in 'argv'
      * @param argc total number of ALL commandline arguments.
      * @param argv list of ALL commandline arguments.
      * @return the desired vector
      */
-    virtual REAL* generateVectors(int numEle, int pos, int argc, char** argv) = 0;
+    virtual REAL* generateVectors(int& numEle, int pos, int argc, char** argv) = 0;
+
+    /**
+     * @brief Same as 'generateVectors', but returns before all the vectors
+     *  are there, for maps which can generate them in chunks
+     * @param numEle same as in 'generateVectors'.
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the desired vector, which may still be arriving (see 'getStream')
+     *
+     * By default, this just calls 'generateVectors'.
+     */
+    virtual REAL* startVectors(int& numEle, int pos, int argc, char** argv) {
+        return generateVectors(numEle, pos, argc, argv);
+    }
+
+    /**
+     * @brief Generates the next vectors (for maps producing them in chunks)
+     * @param out where to write the vectors.
+     * @param numVec number of vectors wanted.
+     * @return number of vectors written. Less than 'numVec' only at the end
+     *  of the input.
+     */
+    virtual int generateChunk(REAL* out, int numVec) { return 0; }
+
+    /**
+     * @brief Generates many trajectories at once, from different initial
+     *  values (see '-ensemble')
+     * @param numEle number of vectors per trajectory.
+     * @param numTraj number of trajectories.
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the trajectories, in structure-of-arrays order (see
+     *  'laneVectors'), to be freed with 'releaseVectors'. NULL for maps
+     *  without an ensemble mode, which is the default.
+     *
+     * Trajectory 0 is the one 'generateVectors' would have generated.
+     */
+    virtual REAL* generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv) {
+        return NULL;
+    }
+
+    /**
+     * @brief Distance between two consecutive values of one trajectory, in
+     *  the output of 'generateEnsemble'
+     * @param numTraj number of trajectories.
+     * @return 'numTraj' rounded up to a multiple of ENSEMBLE_LANES
+     */
+    static int ensembleStride(int numTraj) {
+        return ((numTraj + ENSEMBLE_LANES - 1) / ENSEMBLE_LANES) * ENSEMBLE_LANES;
+    }
+
+    /**
+     * @brief Copies one trajectory out of an ensemble
+     * @param arr the ensemble. Component 'c' of vector 't' of trajectory
+     *  'k' is at [((t * dim) + c) * ensembleStride(numTraj) + k].
+     * @param numTraj number of trajectories.
+     * @param traj the trajectory to be copied.
+     * @param numEle number of vectors per trajectory.
+     * @param dim dimension of the vectors.
+     * @param out where to write its 'numEle' x 'dim' values.
+     */
+    static void laneVectors(const REAL* arr, int numTraj, int traj, int numEle, int dim, REAL* out);
+
+    /**
+     * @brief Frees the vectors returned by 'generateVectors'
+     * @param arr the vectors
+     *
+     * Maps which don't allocate the vectors with 'new []' (eg: the ones
+     * mapping a file into memory) must override this, and hand over the
+     * rest to this one.
+     */
+    virtual void releaseVectors(REAL* arr);
 
     /**
      * @brief Tells the dimension of each vector for this map
@@ -60,14 +161,132 @@ public:
      */
     virtual int getDimension() { return 1; }
 
+    /**
+     * @brief Whether the number of vectors can come from the input itself
+     * @return true for maps reading from a file, where '-numele' is optional
+     */
+    virtual bool sizedByInput() { return false; }
+
+    /**
+     * @brief Vectors returned by 'startVectors' which may still be arriving
+     * @return the stream the engines must wait on, NULL when all the vectors
+     *  are already there
+     */
+    VectorStream* getStream() { return m_stream; }
+
+    /**
+     * @brief Bytes read from the input so far
+     * @return the count (0 for maps generating their vectors)
+     */
+    virtual unsigned long int bytesRead() { return 0; }
+
+    /**
+     * @brief Time spent by the generating thread (see 'startVectors')
+     * @param wall its wall time in s (output).
+     * @param cpu its CPU time in s (output).
+     *
+     * Both are 0 if there's no such thread. They are final only once the
+     * vectors have been released.
+     */
+    void producerTime(REAL& wall, REAL& cpu) const { wall = m_prodWall; cpu = m_prodCpu; }
+
 protected:
     /**
      * @brief Print help message on usage of this class and exit
      */
     virtual void showHelp() = 0;
+
+    /**
+     * @brief Starts generating the vectors in chunks, on a thread of its own
+     * @param numEle number of vectors. 0 means till 'generateChunk' runs
+     *  dry, in which case this waits for all of them and updates 'numEle'.
+     * @return the vectors, which may still be arriving (see 'getStream')
+     */
+    REAL* startChunks(int& numEle);
+
+    /**
+     * @brief Waits for the generating thread and frees the stream
+     */
+    void closeStream();
+
+private:
+    /**
+     * @brief Main loop of the generating thread
+     * @param numEle number of vectors (0 means all).
+     */
+    void produce(int numEle);
+
+protected:
+    VectorStream* m_stream;  ///< vectors being generated in chunks (NULL if none)
+
+private:
+    std::thread m_producer;  ///< thread generating the chunks
+    REAL m_prodWall;         ///< wall time of that thread (in s)
+    REAL m_prodCpu;          ///< CPU time of that thread (in s)
 };
 
 
+/** function creating a new object of a map */
+typedef ChaoticMap* (*MapFactory)();
+
+/**
+ * Registry of all the maps, keyed by the name of their class.
+ *
+ * Every map registers itself, before 'main' starts, by putting
+ * 'REGISTER_MAP(<class>)' in its source file. So, neither a list of the
+ * maps nor any file I/O is needed to find them.
+ */
+class MapRegistry {
+public:
+    /**
+     * @brief Registers a map
+     * @param name name of the map (on the commandline).
+     * @param factory creates a new object of the map.
+     * @return true (so that this can initialize a static)
+     */
+    static bool add(const char* name, MapFactory factory);
+
+    /**
+     * @brief Creates a new object of the given map
+     * @param name name of the map.
+     * @return the map (to be deleted by the caller), NULL if there's no such map
+     */
+    static ChaoticMap* create(const std::string& name);
+
+    /**
+     * @brief Whether there's a map by this name
+     * @param name name of the map.
+     * @return true if it's been registered
+     */
+    static bool has(const std::string& name);
+
+    /**
+     * @brief Names of all the maps
+     * @return the names, sorted
+     */
+    static std::vector<std::string> names();
+
+private:
+    /**
+     * @brief The registry itself
+     * @return the registry
+     *
+     * A function-local static, so that it's there before the first map
+     * registers itself, whatever the order of the static initializers.
+     */
+    static std::unordered_map<std::string, MapFactory>& maps();
+};
+
+/**
+ * Registers the map 'cls' under its own name. To be used once, in the source
+ * file of the map, outside any function.
+ */
+#define REGISTER_MAP(cls)                                               \
+    static ChaoticMap* create##cls() { return new cls(); }              \
+    static const bool s_registered##cls __attribute__((unused)) =       \
+        MapRegistry::add(#cls, &create##cls)
+
+
 /* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
 #endif // __INCLUDED_CHAOTICMAP_H__
 
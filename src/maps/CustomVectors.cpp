@@ -19,24 +19,165 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "CustomVectors.h"
+#include "MemTrack.h"
+#include "SysInfo.h"
+#include "Trace.h"
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 
+REGISTER_MAP(CustomVectors);
+
+
+/** bytes read at a time, when the file is read in chunks */
+#define STREAM_BLOCK_BYTES (1UL << 20)
+/** blocks read ahead of the parsing */
+#define STREAM_BLOCKS      8
+
+
+/**
+ * @brief Whether the file is a stream (stdin, a pipe, ...) rather than a
+ *  regular file, which can't be mapped into memory
+ * @param file the file ('-' means stdin).
+ * @return true for streams
+ */
+static bool isStream(const std::string& file) {
+    struct stat st;
+    return (file == "-") || ((stat(file.c_str(), &st) == 0) && !S_ISREG(st.st_mode));
+}
+
+/**
+ * @brief Parses the header of a .npy file
+ * @param base start of the file.
+ * @param len length of the file.
+ * @param offset will contain the start of the data.
+ * @param width will contain the bytes per value (8 for float64, 4 for float32).
+ * @param shape will contain the shape of the array.
+ * @return an error message, empty string on success
+ *
+ * Only little-endian, C-ordered float64/float32 arrays are supported (which
+ * is what numpy writes by default on x86 and ARM).
+ */
+static std::string parseNpyHeader(const char* base, size_t len, size_t& offset,
+                                  int& width, std::vector<unsigned long int>& shape) {
+    if((len < 10) || memcmp(base, "\x93NUMPY", 6)) {
+        return "not a .npy file";
+    }
+    size_t hlen, start;
+    if(base[6] == 1) {
+        hlen = (unsigned char) base[8] | ((unsigned char) base[9] << 8);
+        start = 10;
+    }
+    else if((len >= 12) && ((base[6] == 2) || (base[6] == 3))) {
+        hlen = (unsigned char) base[8] | ((unsigned char) base[9] << 8) |
+            ((unsigned char) base[10] << 16) | ((size_t) (unsigned char) base[11] << 24);
+        start = 12;
+    }
+    else {
+        return "unsupported .npy version";
+    }
+    if(start + hlen > len) {
+        return "truncated .npy header";
+    }
+    std::string header(base + start, hlen);
+    offset = start + hlen;
+    size_t pos = header.find("'descr'");
+    pos = (pos == std::string::npos)? pos : header.find('\'', pos + 7);
+    if(pos == std::string::npos) {
+        return "no 'descr' in the .npy header";
+    }
+    std::string descr = header.substr(pos + 1, header.find('\'', pos + 1) - pos - 1);
+    if(descr == "<f8") {
+        width = 8;
+    }
+    else if(descr == "<f4") {
+        width = 4;
+    }
+    else {
+        return "unsupported dtype '" + descr + "' (only '<f8' and '<f4' are supported)";
+    }
+    pos = header.find("'fortran_order'");
+    if((pos != std::string::npos) && (header.find("True", pos) < header.find(',', pos))) {
+        return "fortran-ordered arrays are not supported";
+    }
+    pos = header.find("'shape'");
+    pos = (pos == std::string::npos)? pos : header.find('(', pos);
+    if(pos == std::string::npos) {
+        return "no 'shape' in the .npy header";
+    }
+    std::istringstream iss(header.substr(pos + 1, header.find(')', pos) - pos - 1));
+    std::string tok;
+    shape.clear();
+    while(std::getline(iss, tok, ',')) {
+        unsigned long int val;
+        if(from_string<unsigned long int>(val, tok)) {
+            shape.push_back(val);
+        }
+    }
+    if((shape.size() < 1) || (shape.size() > 2)) {
+        return "only 1-d and 2-d arrays are supported";
+    }
+    return "";
+}
+
+
+CustomVectors::~CustomVectors() {
+    if(m_map != NULL) {
+        munmap(m_map, m_mapLen);
+        MemTrack::remove(MEM_VECTORS, m_mapLen);
+    }
+    stopReading();
+}
 
 
 void CustomVectors::showHelp() {
     fprintf(stdout, "OPTIONS FOR CUSTOM MAP:\n");
-    fprintf(stdout, "   [-help, -file <file>]\n");
+    fprintf(stdout, "   [-help, -dim <dim>, -file <file>, -format <fmt>, -columns <list>,\n");
+    fprintf(stdout, "    -ingest-only]\n");
     fprintf(stdout, "  -help           Print this help and exit\n");
-    fprintf(stdout, "  -dim <dim>      Dimension of the vectors. This is a mandatory option!\n");
+    fprintf(stdout, "  -dim <dim>      Dimension of the vectors. If it differs from the number\n");
+    fprintf(stdout, "                  of values per line, the values are just regrouped into\n");
+    fprintf(stdout, "                  vectors of <dim>. [values per line (or .npy columns)]\n");
     fprintf(stdout, "  -file <file>    File from which to read the vectors. This is a\n");
-    fprintf(stdout, "                  mandatory option!\n");
-    exit(0);
+    fprintf(stdout, "                  mandatory option! '-' (or a named pipe) reads the\n");
+    fprintf(stdout, "                  vectors as they arrive. With '-numele', the engines\n");
+    fprintf(stdout, "                  start on the first ones, without waiting for the end.\n");
+    fprintf(stdout, "  -format <fmt>   Format of the file. 'text' (one vector per line), 'npy'\n");
+    fprintf(stdout, "                  (NumPy array of float64/float32), 'f64' or 'f32' (raw\n");
+    fprintf(stdout, "                  little-endian values) or 'scanf' (old, sequential reader\n");
+    fprintf(stdout, "                  of text files). Binary files are mapped into memory\n");
+    fprintf(stdout, "                  instead of being read. [npy if the file starts like\n");
+    fprintf(stdout, "                  one, else text]\n");
+    fprintf(stdout, "  -columns <list> Comma separated list of the columns (counting from 1)\n");
+    fprintf(stdout, "                  of a text file to be used. [all]\n");
+    fprintf(stdout, "  -ingest-only    Only read the file, print the speed of doing so and exit.\n");
+    fatalExit(0);
+}
+
+
+REAL* CustomVectors::generateVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    return readVectors(numEle, false);
+}
+
+
+REAL* CustomVectors::startVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    return readVectors(numEle, true);
 }
 
 
-REAL* CustomVectors::generateVectors(int numEle, int pos, int argc, char** argv) {
-    std::string file = "";
-    Timer tim;
+void CustomVectors::parseOptions(int numEle, int pos, int argc, char** argv) {
+    m_file = "";
+    m_format = "";
+    m_columns.clear();
+    m_ingestOnly = false;
     m_dim = -1;
     for(;pos<argc;pos++) {
         if(!strcmp("-help", argv[pos])) {
@@ -49,35 +190,418 @@ REAL* CustomVectors::generateVectors(int numEle, int pos, int argc, char** argv)
         }
         else if(!strcmp("-file", argv[pos])) {
             OPTION_CHECK("-file", pos, argc);
-            file = argv[pos];
+            m_file = argv[pos];
+        }
+        else if(!strcmp("-format", argv[pos])) {
+            OPTION_CHECK("-format", pos, argc);
+            m_format = argv[pos];
+            if((m_format != "text") && (m_format != "npy") && (m_format != "f64") &&
+               (m_format != "f32") && (m_format != "scanf")) {
+                fprintf(stderr, "Argument to '-format' must be one of text, npy, f64, f32 or scanf!\n");
+                fatalExit(1);
+            }
+        }
+        else if(!strcmp("-columns", argv[pos])) {
+            OPTION_CHECK("-columns", pos, argc);
+            std::istringstream iss(argv[pos]);
+            std::string tok;
+            while(std::getline(iss, tok, ',')) {
+                int col;
+                GET_INTEGER(col, "-columns", tok);
+                CHECK_POSITIVE(col, "-columns");
+                m_columns.push_back(col - 1);
+            }
+        }
+        else if(!strcmp("-ingest-only", argv[pos])) {
+            m_ingestOnly = true;
         }
         else {
             fprintf(stderr, "Unknown option passed '%s'!\n", argv[pos]);
-            exit(1);
+            fatalExit(1);
         }
     }
-    if(file == "") {
+    if(m_file == "") {
         fprintf(stderr, "'-file' is a mandatory option for 'custom-map'!\n");
-        exit(1);
+        fatalExit(1);
+    }
+    m_pipe = isStream(m_file);
+    if(m_pipe && ((m_format == "npy") || (m_format == "scanf"))) {
+        fprintf(stderr, "'-format %s' needs a regular file, not a pipe!\n", m_format.c_str());
+        fatalExit(1);
+    }
+    if(m_pipe && (m_format == "")) {
+        // peeking at the magic would eat the first bytes of a pipe
+        m_format = "text";
+    }
+    else if(m_format == "") {
+        char magic[6];
+        FILE* fp = fopen(m_file.c_str(), "rb");
+        bool npy = (fp != NULL) && (fread(magic, 1, 6, fp) == 6) && !memcmp(magic, "\x93NUMPY", 6);
+        if(fp != NULL) {
+            fclose(fp);
+        }
+        m_format = npy? "npy" : "text";
+    }
+    if(!m_columns.empty() && (m_format != "text")) {
+        fprintf(stderr, "'-columns' is supported only for '-format text'!\n");
+        fatalExit(1);
+    }
+    if((m_dim == -1) && ((m_format == "f64") || (m_format == "f32") || (m_format == "scanf"))) {
+        fprintf(stderr, "'-dim' is a mandatory option for '-format %s'!\n", m_format.c_str());
+        fatalExit(1);
+    }
+    if((numEle == 0) && (m_format == "scanf")) {
+        fprintf(stderr, "'-numele' is a mandatory option for '-format scanf'!\n");
+        fatalExit(1);
+    }
+}
+
+
+REAL* CustomVectors::readVectors(int& numEle, bool overlap) {
+    // pipes can only be read in chunks. Text files too, when the engines can
+    // start on the first vectors. Binary files are better mapped into memory.
+    bool chunks = m_pipe || (overlap && !m_ingestOnly && (numEle > 0) && (m_format == "text"));
+    fprintf(stdout, "Generating numbers from file=%s... ", m_file.c_str());
+    fflush(stdout);
+    TimerScope tim("CustomVectors");
+    REAL* arr;
+    if(chunks) {
+        arr = openStream(numEle);
+        if(overlap && !m_ingestOnly && !m_stream->finished()) {
+            fprintf(stdout, "in the background, the engines start on the first vectors\n");
+            fprintf(stdout, "PARAMETERS: dim=%d numEle=%d file=%s format=%s\n", m_dim, numEle,
+                    m_file.c_str(), m_format.c_str());
+            return arr;
+        }
+        m_stream->require(numEle);
+    }
+    else if(m_format == "text") {
+        arr = readText(m_file, m_columns, numEle);
     }
+    else if(m_format == "scanf") {
+        arr = readTextScanf(m_file, (unsigned long int) numEle * m_dim);
+    }
+    else {
+        arr = mapBinary(m_file, m_format, numEle);
+    }
+    REAL secs = tim.stop();
+    unsigned long int bytes = (unsigned long int) numEle * m_dim * sizeof(REAL);
+    fprintf(stdout, "Time taken: %f s (%.1f MB/s of vectors)\n", secs, (bytes / 1048576.0) / secs);
+    // the shape of the files is known only after reading them
+    fprintf(stdout, "PARAMETERS: dim=%d numEle=%d file=%s format=%s\n", m_dim, numEle,
+            m_file.c_str(), m_format.c_str());
+    if(m_ingestOnly) {
+        releaseVectors(arr);
+        fatalExit(0);
+    }
+    return arr;
+}
+
+
+void CustomVectors::releaseVectors(REAL* arr) {
+    if((m_stream != NULL) && (arr == m_stream->data())) {
+        stopReading();
+        return;
+    }
+    const char* ptr = (const char*) arr;
+    if((m_map != NULL) && (ptr >= (const char*) m_map) && (ptr < (const char*) m_map + m_mapLen)) {
+        munmap(m_map, m_mapLen);
+        MemTrack::remove(MEM_VECTORS, m_mapLen);
+        m_map = NULL;
+        m_mapLen = 0;
+        return;
+    }
+    ChaoticMap::releaseVectors(arr);
+}
+
+
+REAL* CustomVectors::readText(const std::string& file, const std::vector<int>& columns, int& numEle) {
+    TextParser parser;
+    parser.selectColumns(columns);
+    // a '-dim' differing from the columns regroups the values, as 'scanf' does
+    if(!parser.parse(file, numEle, (m_dim == -1)? 0 : m_dim, numCores())) {
+        fprintf(stderr, "Failed to read the vectors from '%s': %s!\n", file.c_str(),
+                parser.error().c_str());
+        fatalExit(1);
+    }
+    m_bytesRead = parser.bytes();
     if(m_dim == -1) {
-        fprintf(stderr, "'-dim' is a mandatory option for 'custom-map'!\n");
-        exit(1);
+        m_dim = parser.cols();
+    }
+    unsigned long int numVec = (parser.rows() * parser.cols()) / m_dim;
+    if(numEle == 0) {
+        if(numVec > INT_MAX) {
+            fprintf(stderr, "File '%s' has too many vectors (%lu), use '-numele'!\n",
+                    file.c_str(), numVec);
+            fatalExit(1);
+        }
+        numEle = (int) numVec;
     }
-    fprintf(stdout, "PARAMETERS: dim=%d numEle=%d file=%s\n", m_dim, numEle, file.c_str());
-    fprintf(stdout, "Generating numbers from file=%s... ", file.c_str());
-    tim.start();
-    int num = numEle * m_dim;
+    else if(numVec < (unsigned long int) numEle) {
+        fprintf(stderr, "File '%s' has only %lu vectors, but '-numele' is %d!\n",
+                file.c_str(), numVec, numEle);
+        fatalExit(1);
+    }
+    return parser.release();
+}
+
+
+REAL* CustomVectors::readTextScanf(const std::string& file, unsigned long int num) {
     FILE* fp = fopen(file.c_str(), "r");
     if(fp == NULL) {
         fprintf(stderr, "Failed to open the file '%s' for reading the vectors!\n", file.c_str());
-        exit(1);
+        fatalExit(1);
     }
-    REAL* arr = new REAL[num];
-    for(int i=0;i<num;i++) {
+    REAL* arr = MemTrack::allocate<REAL>(num, MEM_VECTORS);
+    for(unsigned long int i=0;i<num;i++) {
         fscanf(fp, "%lf", &(arr[i]));
     }
+    m_bytesRead = ftell(fp);
     fclose(fp);
-    tim.stopAndPrintTime("Time taken: %f s\n");
     return arr;
 }
+
+
+REAL* CustomVectors::mapBinary(const std::string& file, const std::string& format, int& numEle) {
+    int fd = open(file.c_str(), O_RDONLY);
+    struct stat st;
+    if((fd < 0) || (fstat(fd, &st) != 0)) {
+        fprintf(stderr, "Failed to open the file '%s' for reading the vectors!\n", file.c_str());
+        fatalExit(1);
+    }
+    size_t len = st.st_size;
+    // private and writable: nothing is copied unless somebody writes into it
+    void* ptr = (len > 0)? mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if(ptr == MAP_FAILED) {
+        fprintf(stderr, "Failed to map the file '%s' into memory!\n", file.c_str());
+        fatalExit(1);
+    }
+    m_map = ptr;
+    m_mapLen = len;
+    MemTrack::add(MEM_VECTORS, len);
+    m_bytesRead = len;
+    const char* base = (const char*) ptr;
+    size_t offset = 0;
+    int width = (format == "f32")? 4 : 8;
+    unsigned long int numVec;
+    if(format == "npy") {
+        std::vector<unsigned long int> shape;
+        std::string err = parseNpyHeader(base, len, offset, width, shape);
+        if(err != "") {
+            fprintf(stderr, "Failed to read '%s': %s!\n", file.c_str(), err.c_str());
+            fatalExit(1);
+        }
+        int dim = (shape.size() == 2)? (int) shape[1] : 1;
+        if((m_dim != -1) && (m_dim != dim)) {
+            fprintf(stderr, "Argument to '-dim' is %d, but the file '%s' has %d columns!\n",
+                    m_dim, file.c_str(), dim);
+            fatalExit(1);
+        }
+        m_dim = dim;
+        numVec = shape[0];
+        if(offset + (numVec * m_dim * width) > len) {
+            fprintf(stderr, "File '%s' is shorter than its header says!\n", file.c_str());
+            fatalExit(1);
+        }
+    }
+    else {
+        numVec = len / ((unsigned long int) width * m_dim);
+    }
+    if(numEle == 0) {
+        if(numVec > INT_MAX) {
+            fprintf(stderr, "File '%s' has too many vectors (%lu), use '-numele'!\n",
+                    file.c_str(), numVec);
+            fatalExit(1);
+        }
+        numEle = (int) numVec;
+    }
+    else if(numVec < (unsigned long int) numEle) {
+        fprintf(stderr, "File '%s' has only %lu vectors, but '-numele' is %d!\n",
+                file.c_str(), numVec, numEle);
+        fatalExit(1);
+    }
+    unsigned long int num = (unsigned long int) numEle * m_dim;
+    if((width == sizeof(REAL)) && ((offset % sizeof(REAL)) == 0)) {
+        madvise(ptr, len, MADV_WILLNEED);
+        return (REAL*) (base + offset);
+    }
+    // float32 values need to be widened, the file is not needed after that
+    REAL* arr = MemTrack::allocate<REAL>(num, MEM_VECTORS);
+    for(unsigned long int i=0;i<num;i++) {
+        if(width == 4) {
+            float val;
+            memcpy(&val, base + offset + (i * 4), 4);
+            arr[i] = val;
+        }
+        else {
+            memcpy(&(arr[i]), base + offset + (i * 8), 8);
+        }
+    }
+    munmap(m_map, m_mapLen);
+    MemTrack::remove(MEM_VECTORS, m_mapLen);
+    m_map = NULL;
+    m_mapLen = 0;
+    return arr;
+}
+
+
+REAL* CustomVectors::openStream(int& numEle) {
+    int fd = (m_file == "-")? 0 : open(m_file.c_str(), O_RDONLY);
+    if(fd < 0) {
+        fprintf(stderr, "Failed to open the file '%s' for reading the vectors!\n", m_file.c_str());
+        fatalExit(1);
+    }
+    m_wake = eventfd(0, 0);
+    m_ring = new RingBuffer(STREAM_BLOCKS, STREAM_BLOCK_BYTES);
+    m_io = std::thread(&CustomVectors::readBlocks, this, fd);
+    m_text.clear();
+    m_vals.clear();
+    m_valPos = 0;
+    m_eof = false;
+    if(m_format == "text") {
+        // the first data line decides the shape
+        m_parser.selectColumns(m_columns);
+        int found;
+        while((found = m_parser.firstLine(m_text.data(), m_text.size())) == 0) {
+            if(m_eof) {
+                fprintf(stderr, "Failed to read the vectors from '%s': no values in the file!\n",
+                        m_file.c_str());
+                fatalExit(1);
+            }
+            nextBlock();
+            if(m_eof) {
+                // the last line may lack its '\n'
+                m_text += '\n';
+            }
+        }
+        if(found < 0) {
+            fprintf(stderr, "Failed to read the vectors from '%s': %s!\n", m_file.c_str(),
+                    m_parser.error().c_str());
+            fatalExit(1);
+        }
+        if(m_dim == -1) {
+            m_dim = m_parser.cols();
+        }
+    }
+    return startChunks(numEle);
+}
+
+
+void CustomVectors::readBlocks(int fd) {
+    Trace::nameThread("reader");
+    struct pollfd fds[2] = { {fd, POLLIN, 0}, {m_wake, POLLIN, 0} };
+    char* blk;
+    while((blk = m_ring->acquire()) != NULL) {
+        // a pipe may keep us waiting, unless 'stopReading' says otherwise
+        if((poll(fds, 2, -1) < 0) && (errno != EINTR)) {
+            break;
+        }
+        if(fds[1].revents != 0) {
+            break;
+        }
+        if(fds[0].revents == 0) {
+            continue;
+        }
+        unsigned long long begin = Timer::ticks();
+        ssize_t n = read(fd, blk, m_ring->slotBytes());
+        Trace::event("read", "io", begin, Timer::ticks(), n);
+        if((n < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if(n < 0) {
+            fprintf(stderr, "Failed to read the vectors from '%s': %s!\n", m_file.c_str(),
+                    strerror(errno));
+            fatalExit(1);
+        }
+        if(n == 0) {
+            break;
+        }
+        m_ring->publish(n);
+    }
+    m_ring->finish();
+    if(fd != 0) {
+        close(fd);
+    }
+}
+
+
+void CustomVectors::nextBlock() {
+    size_t len;
+    const char* blk = m_ring->next(len);
+    if(blk == NULL) {
+        m_eof = true;
+    }
+    else {
+        m_text.append(blk, len);
+        m_bytesRead += len;
+        m_ring->release();
+    }
+}
+
+
+int CustomVectors::generateChunk(REAL* out, int numVec) {
+    unsigned long int need = (unsigned long int) numVec * m_dim;
+    m_vals.erase(m_vals.begin(), m_vals.begin() + m_valPos);
+    m_valPos = 0;
+    while(true) {
+        // convert whatever is complete: lines of text or binary values
+        size_t done = m_text.size();
+        if(!m_eof && (m_format == "text")) {
+            size_t last = m_text.rfind('\n');
+            done = (last == std::string::npos)? 0 : last + 1;
+        }
+        if(m_format == "text") {
+            // no more rows than needed, the rest may never be asked for
+            unsigned long int rows = (need - std::min(need, m_vals.size()) + m_parser.cols() - 1) / m_parser.cols();
+            if(!m_parser.parseLines(m_text.data(), done, m_vals, std::max(rows, 1UL))) {
+                fprintf(stderr, "Failed to read the vectors from '%s': %s!\n", m_file.c_str(),
+                        m_parser.error().c_str());
+                fatalExit(1);
+            }
+        }
+        else {
+            int width = (m_format == "f32")? 4 : 8;
+            done -= done % width;
+            for(size_t i=0;i<done;i+=width) {
+                if(width == 4) {
+                    float val;
+                    memcpy(&val, m_text.data() + i, 4);
+                    m_vals.push_back(val);
+                }
+                else {
+                    REAL val;
+                    memcpy(&val, m_text.data() + i, 8);
+                    m_vals.push_back(val);
+                }
+            }
+        }
+        m_text.erase(0, done);
+        if((m_vals.size() >= need) || m_eof) {
+            break;
+        }
+        nextBlock();
+    }
+    int got = (int) (std::min(need, m_vals.size() - m_valPos) / m_dim);
+    memcpy(out, &(m_vals[0]) + m_valPos, (size_t) got * m_dim * sizeof(REAL));
+    m_valPos += (size_t) got * m_dim;
+    return got;
+}
+
+
+void CustomVectors::stopReading() {
+    if(m_ring == NULL) {
+        return;
+    }
+    uint64_t one = 1;
+    m_ring->cancel();
+    if(write(m_wake, &one, sizeof(one)) < 0) {
+        // the reading thread still stops at the next block
+    }
+    m_io.join();
+    // the generating thread may still be waiting on the ring
+    closeStream();
+    close(m_wake);
+    delete m_ring;
+    m_ring = NULL;
+}
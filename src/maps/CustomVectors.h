@@ -26,6 +26,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "ChaoticMap.h"
+#include "TextParser.h"
+#include "RingBuffer.h"
 
 
 /**
@@ -33,6 +35,18 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 class CustomVectors : public ChaoticMap {
 public:
+    /**
+     * @brief Constructor of this class.
+     */
+    CustomVectors(): m_dim(-1), m_pipe(false), m_ingestOnly(false), m_map(NULL), m_mapLen(0),
+                     m_ring(NULL), m_wake(-1), m_valPos(0), m_eof(false), m_bytesRead(0) {}
+
+    /**
+     * @brief Destructor of this class. Unmaps the file, if still mapped, and
+     *  stops reading the stream, if any.
+     */
+    ~CustomVectors();
+
     /**
      * @brief generate the first 'numEle' vectors from the given map
      * @param numEle number of elements in the output vector
@@ -41,7 +55,27 @@ public:
      * @param argv list of ALL commandline arguments.
      * @return the desired vector
      */
-    REAL* generateVectors(int numEle, int pos, int argc, char** argv);
+    REAL* generateVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Same as 'generateVectors', but text files (with '-numele') and
+     *  pipes are read in the background, while the engines work on the
+     *  first vectors
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the desired vector (see 'getStream')
+     */
+    REAL* startVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Converts the next vectors read from the file
+     * @param out where to write the vectors.
+     * @param numVec number of vectors wanted.
+     * @return number of vectors written (less only at the end of the file)
+     */
+    int generateChunk(REAL* out, int numVec);
 
     /**
      * @brief Tells the dimension of each vector for this map
@@ -49,6 +83,24 @@ public:
      */
     int getDimension() { return m_dim; }
 
+    /**
+     * @brief The file decides the number of vectors, when '-numele' isn't given
+     * @return true
+     */
+    bool sizedByInput() { return true; }
+
+    /**
+     * @brief Frees the vectors (or unmaps the file they came from)
+     * @param arr the vectors returned by 'generateVectors'
+     */
+    void releaseVectors(REAL* arr);
+
+    /**
+     * @brief Bytes read from the file so far
+     * @return the count
+     */
+    unsigned long int bytesRead() { return m_bytesRead; }
+
 protected:
     /**
      * @brief Print help message on usage of this class and exit
@@ -56,7 +108,97 @@ protected:
     void showHelp();
 
 private:
-    int m_dim;   ///< dimension of the data
+    /**
+     * @brief Parses the options of this map
+     * @param numEle number of vectors needed (0 means all).
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     */
+    void parseOptions(int numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Reads the vectors, in whichever way suits the file best
+     * @param numEle number of vectors needed (0 means all, updated on return).
+     * @param overlap whether the vectors may still be arriving on return.
+     * @return the values
+     */
+    REAL* readVectors(int& numEle, bool overlap);
+
+    /**
+     * @brief Reads the vectors from a text file, on all the cores
+     * @param file the file.
+     * @param columns columns to be used (counting from 0). Empty means all.
+     * @param numEle number of vectors needed (0 means all, updated on return).
+     * @return the values
+     */
+    REAL* readText(const std::string& file, const std::vector<int>& columns, int& numEle);
+
+    /**
+     * @brief Reads the vectors from a text file, one value at a time
+     * @param file the file.
+     * @param num number of values to be read.
+     * @return the values
+     */
+    REAL* readTextScanf(const std::string& file, unsigned long int num);
+
+    /**
+     * @brief Maps a binary file (.npy or raw) into memory
+     * @param file the file.
+     * @param format 'npy', 'f64' or 'f32'.
+     * @param numEle number of vectors needed (0 means all, updated on return).
+     * @return the values (inside the mapping for float64, a copy for float32)
+     */
+    REAL* mapBinary(const std::string& file, const std::string& format, int& numEle);
+
+    /**
+     * @brief Starts reading the vectors in chunks (see 'generateChunk')
+     * @param numEle number of vectors needed (0 means all, updated on return).
+     * @return the values, which may still be arriving (see 'getStream')
+     *
+     * A thread reads the file block by block into a ring buffer, while
+     * another one converts the blocks into vectors. When 'numEle' is given,
+     * this returns as soon as the shape of the vectors is known. Else, the
+     * whole file has to be read first to know the number of vectors.
+     */
+    REAL* openStream(int& numEle);
+
+    /**
+     * @brief Reads the file into the ring buffer (on its own thread)
+     * @param fd the file.
+     */
+    void readBlocks(int fd);
+
+    /**
+     * @brief Moves the next block from the ring buffer to 'm_text'
+     *
+     * Sets 'm_eof' once there are no more blocks.
+     */
+    void nextBlock();
+
+    /**
+     * @brief Stops reading the file and frees the stream
+     */
+    void stopReading();
+
+private:
+    int m_dim;       ///< dimension of the data
+    std::string m_file;          ///< file to read
+    std::string m_format;        ///< format of the file
+    std::vector<int> m_columns;  ///< columns to be used (empty means all)
+    bool m_pipe;     ///< whether the file is a pipe (or stdin)
+    bool m_ingestOnly;  ///< whether to only read the file
+    void* m_map;     ///< the mapped file (NULL if none)
+    size_t m_mapLen; ///< length of the mapping
+    RingBuffer* m_ring;          ///< blocks read, but not yet converted (NULL if none)
+    std::thread m_io;            ///< thread reading the blocks
+    int m_wake;                  ///< eventfd to stop the reading thread
+    TextParser m_parser;         ///< converts the text blocks
+    std::string m_text;          ///< bytes not yet converted
+    std::vector<REAL> m_vals;    ///< values not yet handed over
+    size_t m_valPos;             ///< first value of 'm_vals' not yet handed over
+    bool m_eof;                  ///< whether the ring buffer has run dry
+    unsigned long int m_bytesRead;  ///< bytes read from the file so far
 };
 
 
@@ -19,18 +19,21 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "HenonMap.h"
+#include "MemTrack.h"
 
 
-REAL* HenonMap::generate(REAL a, REAL b, REAL x0, REAL y0, int k) {
-    REAL* arr = new REAL[k<<1];
+REGISTER_MAP(HenonMap);
+
+
+int HenonMap::generateChunk(REAL* out, int numVec) {
     int j = 0;
-    for(int i=0;i<k;i++,j+=2) {
-        arr[j] = y0 + 1 - (a * x0 * x0);
-        arr[j+1] = b * x0;
-        x0 = arr[j];
-        y0 = arr[j+1];
+    for(int i=0;i<numVec;i++,j+=2) {
+        out[j] = m_y + 1 - (m_a * m_x * m_x);
+        out[j+1] = m_b * m_x;
+        m_x = out[j];
+        m_y = out[j+1];
     }
-    return arr;
+    return numVec;
 }
 
 void HenonMap::showHelp() {
@@ -45,15 +48,14 @@ void HenonMap::showHelp() {
             HENON_X0);
     fprintf(stdout, "  -y0 <y0>      Initial y-value for the map. [%f]\n",
             HENON_X0);
-    exit(0);
+    fatalExit(0);
 }
 
-REAL* HenonMap::generateVectors(int numEle, int pos, int argc, char** argv) {
+void HenonMap::parseOptions(int numEle, int pos, int argc, char** argv) {
     REAL a = HENON_A;
     REAL b = HENON_B;
     REAL x0 = HENON_X0;
     REAL y0 = HENON_Y0;
-    Timer tim;
     for(;pos<argc;pos++) {
         if(!strcmp("-help", argv[pos])) {
             this->showHelp();
@@ -76,16 +78,57 @@ REAL* HenonMap::generateVectors(int numEle, int pos, int argc, char** argv) {
         }
         else {
             fprintf(stderr, "Unknown option passed '%s'!\n", argv[pos]);
-            exit(1);
+            fatalExit(1);
         }
     }
     CHECK_RANGE(b, "-b", 0.0, 1.0);
     fprintf(stdout, "PARAMETERS: numEle=%d a=%f b=%f x0=%f y0=%f\n",
             numEle, a, b, x0, y0);
+    m_a = a;
+    m_b = b;
+    m_x = x0;
+    m_y = y0;
+}
+
+REAL* HenonMap::generateVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
     fprintf(stdout, "Generating numbers from HenonMap... ");
-    tim.start();
-    REAL* arr = this->generate(a, b, x0, y0, numEle);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    TimerScope tim("HenonMap", "Time taken: %f s\n");
+    REAL* arr = MemTrack::allocate<REAL>(numEle<<1, MEM_VECTORS);
+    generateChunk(arr, numEle);
+    tim.stop();
     return arr;
 }
 
+REAL* HenonMap::generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating %d trajectories from HenonMap... ", numTraj);
+    TimerScope tim("HenonMap", "Time taken: %f s\n");
+    int stride = ensembleStride(numTraj);
+    REAL* arr = MemTrack::allocate<REAL>(((unsigned long int) numEle * stride)<<1, MEM_VECTORS);
+    // the 'x' of all the trajectories, followed by their 'y'
+    std::vector<REAL> first(stride<<1, m_y);
+    for(int k=0;k<stride;k++) {
+        first[k] = m_x + (k * HENON_STEP);
+    }
+    // every vector of all the trajectories comes from the previous one
+    const REAL* prev = &(first[0]);
+    REAL* row = arr;
+    for(int t=0;t<numEle;t++,prev=row,row+=(stride<<1)) {
+        for(int k=0;k<stride;k+=ENSEMBLE_LANES) {
+            LaneVec x = *(const LaneVec*) (prev + k);
+            LaneVec y = *(const LaneVec*) (prev + stride + k);
+            *(LaneVec*) (row + k) = y + 1 - (m_a * x * x);
+            *(LaneVec*) (row + stride + k) = m_b * x;
+        }
+    }
+    tim.stop();
+    return arr;
+}
+
+REAL* HenonMap::startVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating numbers from HenonMap... in the background\n");
+    return startChunks(numEle);
+}
+
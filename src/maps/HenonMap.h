@@ -36,6 +36,8 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #define HENON_X0     1.44
 /** default initial value y0 */
 #define HENON_Y0     0.89
+/** step between the initial 'x' of two trajectories, in ensemble mode */
+#define HENON_STEP   1e-7
 
 
 /**
@@ -51,7 +53,39 @@ public:
      * @param argv list of ALL commandline arguments.
      * @return the desired vector
      */
-    REAL* generateVectors(int numEle, int pos, int argc, char** argv);
+    REAL* generateVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Same as 'generateVectors', but the vectors are generated in the
+     *  background, while the engines work on the first ones
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the desired vector (see 'getStream')
+     */
+    REAL* startVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Generates the next vectors of this map
+     * @param out where to write the vectors.
+     * @param numVec number of vectors wanted.
+     * @return number of vectors written (always 'numVec')
+     */
+    int generateChunk(REAL* out, int numVec);
+
+    /**
+     * @brief Generates 'numTraj' trajectories at once, ENSEMBLE_LANES at a
+     *  time, starting from ('x0', 'y0'), 'x0'
+     *  moving by HENON_STEP from one to the next
+     * @param numEle number of vectors per trajectory.
+     * @param numTraj number of trajectories.
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the trajectories (see 'ChaoticMap::laneVectors')
+     */
+    REAL* generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv);
 
     /**
      * @brief Tells the dimension of each vector for this map
@@ -67,19 +101,19 @@ protected:
 
 private:
     /**
-     * @brief Generate the first 'k' numbers from the HenonMap.
-     * @param a the parameter of the HenonMap for x-values.
-     * @param b the parameter of the HenonMap for y-values.
-     * @param x0 the seed for the HenonMap.
-     * @param y0 the seed for the HenonMap.
-     * @param k generate the first 'k' numbers.
-     * @return an array of first 'k' numbers from the HenonMap.
-     *
-     * 'x0' must be between 0 and 1.
-     * The returned array is the responsibility of the caller. The caller
-     * should 'delete' the memory pointer!
+     * @brief Parses the options of this map and prints them
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
      */
-    REAL* generate(REAL a, REAL b, REAL x0, REAL y0, int k);
+    void parseOptions(int numEle, int pos, int argc, char** argv);
+
+private:
+    REAL m_a;   ///< the parameter of the HenonMap for x-values
+    REAL m_b;   ///< the parameter of the HenonMap for y-values
+    REAL m_x;   ///< current x-value of the map
+    REAL m_y;   ///< current y-value of the map
 };
 
 
@@ -19,15 +19,19 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "LogisticMap.h"
+#include "MemTrack.h"
+#include <cmath>
 
 
-REAL* LogisticMap::generate(REAL lambda, REAL x0, int k) {
-    REAL* arr = new REAL[k];
-    for(int i=0;i<k;i++) {
-        x0 = lambda * x0 * (1 - x0);
-        arr[i] = x0;
+REGISTER_MAP(LogisticMap);
+
+
+int LogisticMap::generateChunk(REAL* out, int numVec) {
+    for(int i=0;i<numVec;i++) {
+        m_x = m_lambda * m_x * (1 - m_x);
+        out[i] = m_x;
     }
-    return arr;
+    return numVec;
 }
 
 
@@ -37,13 +41,12 @@ void LogisticMap::showHelp() {
     fprintf(stdout, "  -help           Print this help and exit.\n");
     fprintf(stdout, "  -lambda <lam>   Value of lambda for the map. [%f]\n", LOGISTIC_LAMBDA);
     fprintf(stdout, "  -x0 <x0>        Initial value for the map. [%f]\n", LOGISTIC_X0);
-    exit(0);
+    fatalExit(0);
 }
 
-REAL* LogisticMap::generateVectors(int numEle, int pos, int argc, char** argv) {
+void LogisticMap::parseOptions(int numEle, int pos, int argc, char** argv) {
     REAL lambda = LOGISTIC_LAMBDA;
     REAL x0 = LOGISTIC_X0;
-    Timer tim;
     for(;pos<argc;pos++) {
         if(!strcmp("-help", argv[pos])) {
             this->showHelp();
@@ -58,15 +61,54 @@ REAL* LogisticMap::generateVectors(int numEle, int pos, int argc, char** argv) {
         }
         else {
             fprintf(stderr, "Unknown option passed '%s'!\n", argv[pos]);
-            exit(1);
+            fatalExit(1);
         }
     }
     CHECK_RANGE(x0, "-x0", 0.0, 1.0);
     fprintf(stdout, "PARAMETERS: numEle=%d lambda=%f x0=%f\n", numEle, lambda, x0);
+    m_lambda = lambda;
+    m_x = x0;
+}
+
+
+REAL* LogisticMap::generateVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
     fprintf(stdout, "Generating numbers from LogisticMap... ");
-    tim.start();
-    REAL* arr = this->generate(lambda, x0, numEle);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    TimerScope tim("LogisticMap", "Time taken: %f s\n");
+    REAL* arr = MemTrack::allocate<REAL>(numEle, MEM_VECTORS);
+    generateChunk(arr, numEle);
+    tim.stop();
+    return arr;
+}
+
+
+REAL* LogisticMap::generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating %d trajectories from LogisticMap... ", numTraj);
+    TimerScope tim("LogisticMap", "Time taken: %f s\n");
+    int stride = ensembleStride(numTraj);
+    REAL* arr = MemTrack::allocate<REAL>((unsigned long int) numEle * stride, MEM_VECTORS);
+    std::vector<REAL> x0(stride);
+    for(int k=0;k<stride;k++) {
+        x0[k] = fmod(m_x + (k * ENSEMBLE_STEP), 1.0);
+    }
+    // every value of all the trajectories comes from the previous one
+    const REAL* prev = &(x0[0]);
+    REAL* row = arr;
+    for(int t=0;t<numEle;t++,prev=row,row+=stride) {
+        for(int k=0;k<stride;k+=ENSEMBLE_LANES) {
+            LaneVec x = *(const LaneVec*) (prev + k);
+            *(LaneVec*) (row + k) = m_lambda * x * (1 - x);
+        }
+    }
+    tim.stop();
     return arr;
 }
 
+
+REAL* LogisticMap::startVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating numbers from LogisticMap... in the background\n");
+    return startChunks(numEle);
+}
+
@@ -47,7 +47,39 @@ public:
      * @param argv list of ALL commandline arguments.
      * @return the desired vector
      */
-    REAL* generateVectors(int numEle, int pos, int argc, char** argv);
+    REAL* generateVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Same as 'generateVectors', but the vectors are generated in the
+     *  background, while the engines work on the first ones
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the desired vector (see 'getStream')
+     */
+    REAL* startVectors(int& numEle, int pos, int argc, char** argv);
+
+    /**
+     * @brief Generates the next vectors of this map
+     * @param out where to write the vectors.
+     * @param numVec number of vectors wanted.
+     * @return number of vectors written (always 'numVec')
+     */
+    int generateChunk(REAL* out, int numVec);
+
+    /**
+     * @brief Generates 'numTraj' trajectories at once, ENSEMBLE_LANES at a
+     *  time, starting from 'x0' and then
+     *  every ENSEMBLE_STEP (modulo 1)
+     * @param numEle number of vectors per trajectory.
+     * @param numTraj number of trajectories.
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return the trajectories (see 'ChaoticMap::laneVectors')
+     */
+    REAL* generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv);
 
 protected:
     /**
@@ -57,17 +89,19 @@ protected:
 
 private:
     /**
-     * @brief Generate the first 'k' numbers from the LogisticMap.
-     * @param lambda the parameter of the LogisticMap.
-     * @param x0 the seed for the LogisticMap.
-     * @param k generate the first 'k' numbers.
-     * @return an array of first 'k' numbers from the LogisticMap.
+     * @brief Parses the options of this map and prints them
+     * @param numEle number of elements in the output vector
+     * @param pos start of the arguments in 'argv'
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
      *
-     * 'x0' must be between 0 and 1.
-     * The returned array is the responsibility of the caller. The caller
-     * should 'delete' the memory pointer!
+     * The seed 'x0' must be between 0 and 1.
      */
-    REAL* generate(REAL lambda, REAL x0, int k);
+    void parseOptions(int numEle, int pos, int argc, char** argv);
+
+private:
+    REAL m_lambda;   ///< the parameter of the LogisticMap
+    REAL m_x;        ///< current value of the map
 };
 
 
@@ -0,0 +1,86 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+
+#include "LorenzFlow.h"
+
+
+REGISTER_MAP(LorenzFlow);
+
+
+/** right-hand side of the Lorenz system, for one trajectory or for LaneVec's */
+struct LorenzFlowRhs {
+    REAL sigma;
+    REAL rho;
+    REAL beta;
+
+    template <typename V>
+    void operator()(const V& x, const V& y, const V& z, V& dx, V& dy, V& dz) const {
+        dx = sigma * (y - x);
+        dy = x * (rho - z) - y;
+        dz = x * y - beta * z;
+    }
+};
+
+
+void LorenzFlow::showHelp() {
+    fprintf(stdout, "OPTIONS FOR LORENZ SYSTEM:\n");
+    fprintf(stdout, "      [-help, -sigma <sigma>, -rho <rho>, -beta <beta>, -dt <dt>,\n");
+    fprintf(stdout, "       -stride <n>, -transient <n>, -x0 <x0>, -y0 <y0>, -z0 <z0>]\n");
+    fprintf(stdout, "  -help            Print this help and exit.\n");
+    fprintf(stdout, "  -sigma <sigma>   Value of 'sigma' for the system. [%f]\n", LORENZ_SIGMA);
+    fprintf(stdout, "  -rho <rho>       Value of 'rho' for the system. [%f]\n", LORENZ_RHO);
+    fprintf(stdout, "  -beta <beta>     Value of 'beta' for the system. [%f]\n", LORENZ_BETA);
+    showFlowHelp();
+    fatalExit(0);
+}
+
+bool LorenzFlow::parseParam(int& pos, int argc, char** argv) {
+    if(!strcmp("-sigma", argv[pos])) {
+        OPTION_CHECK("-sigma", pos, argc);
+        GET_NUMBER(m_sigma, "-sigma", argv[pos]);
+    }
+    else if(!strcmp("-rho", argv[pos])) {
+        OPTION_CHECK("-rho", pos, argc);
+        GET_NUMBER(m_rho, "-rho", argv[pos]);
+    }
+    else if(!strcmp("-beta", argv[pos])) {
+        OPTION_CHECK("-beta", pos, argc);
+        GET_NUMBER(m_beta, "-beta", argv[pos]);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void LorenzFlow::printParams() {
+    fprintf(stdout, "sigma=%f rho=%f beta=%f ", m_sigma, m_rho, m_beta);
+}
+
+void LorenzFlow::advance(REAL& x, REAL& y, REAL& z, long int steps) {
+    LorenzFlowRhs f = { m_sigma, m_rho, m_beta };
+    rk4(x, y, z, steps, f);
+}
+
+void LorenzFlow::advanceLanes(LaneVec& x, LaneVec& y, LaneVec& z, long int steps) {
+    LorenzFlowRhs f = { m_sigma, m_rho, m_beta };
+    rk4(x, y, z, steps, f);
+}
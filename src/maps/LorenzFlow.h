@@ -0,0 +1,95 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#ifndef __INCLUDED_LORENZFLOW_H__
+#define __INCLUDED_LORENZFLOW_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "ChaoticFlow.h"
+
+
+/** default value of parameter sigma */
+#define LORENZ_SIGMA    10.0
+/** default value of parameter rho */
+#define LORENZ_RHO      28.0
+/** default value of parameter beta */
+#define LORENZ_BETA     (8.0 / 3.0)
+
+
+/**
+ * Class to generate vectors from the Lorenz system:
+ *   dx/dt = sigma * (y - x)
+ *   dy/dt = x * (rho - z) - y
+ *   dz/dt = x * y - beta * z
+ */
+class LorenzFlow : public ChaoticFlow {
+public:
+    /**
+     * @brief Constructor of this class.
+     */
+    LorenzFlow(): ChaoticFlow("LorenzFlow"), m_sigma(LORENZ_SIGMA), m_rho(LORENZ_RHO), m_beta(LORENZ_BETA) {}
+
+protected:
+    /**
+     * @brief Print help message on usage of this class and exit
+     */
+    void showHelp();
+
+    /**
+     * @brief Parses one option specific to this system
+     * @param pos position of the option in 'argv' (moved past its argument).
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return false if there's no such option
+     */
+    bool parseParam(int& pos, int argc, char** argv);
+
+    /**
+     * @brief Prints the parameters of this system
+     */
+    void printParams();
+
+    /**
+     * @brief Integrates one trajectory
+     * @param x, y, z the state (updated).
+     * @param steps number of steps.
+     */
+    void advance(REAL& x, REAL& y, REAL& z, long int steps);
+
+    /**
+     * @brief Integrates ENSEMBLE_LANES trajectories at once
+     * @param x, y, z the states (updated).
+     * @param steps number of steps.
+     */
+    void advanceLanes(LaneVec& x, LaneVec& y, LaneVec& z, long int steps);
+
+private:
+    REAL m_sigma;   ///< the parameter sigma of the system
+    REAL m_rho;     ///< the parameter rho of the system
+    REAL m_beta;    ///< the parameter beta of the system
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_LORENZFLOW_H__
@@ -0,0 +1,86 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+
+#include "RosslerFlow.h"
+
+
+REGISTER_MAP(RosslerFlow);
+
+
+/** right-hand side of the Rossler system, for one trajectory or for LaneVec's */
+struct RosslerFlowRhs {
+    REAL a;
+    REAL b;
+    REAL c;
+
+    template <typename V>
+    void operator()(const V& x, const V& y, const V& z, V& dx, V& dy, V& dz) const {
+        dx = -y - z;
+        dy = x + a * y;
+        dz = b + z * (x - c);
+    }
+};
+
+
+void RosslerFlow::showHelp() {
+    fprintf(stdout, "OPTIONS FOR ROSSLER SYSTEM:\n");
+    fprintf(stdout, "      [-help, -a <a>, -b <b>, -c <c>, -dt <dt>,\n");
+    fprintf(stdout, "       -stride <n>, -transient <n>, -x0 <x0>, -y0 <y0>, -z0 <z0>]\n");
+    fprintf(stdout, "  -help            Print this help and exit.\n");
+    fprintf(stdout, "  -a <a>           Value of 'a' for the system. [%f]\n", ROSSLER_A);
+    fprintf(stdout, "  -b <b>           Value of 'b' for the system. [%f]\n", ROSSLER_B);
+    fprintf(stdout, "  -c <c>           Value of 'c' for the system. [%f]\n", ROSSLER_C);
+    showFlowHelp();
+    fatalExit(0);
+}
+
+bool RosslerFlow::parseParam(int& pos, int argc, char** argv) {
+    if(!strcmp("-a", argv[pos])) {
+        OPTION_CHECK("-a", pos, argc);
+        GET_NUMBER(m_a, "-a", argv[pos]);
+    }
+    else if(!strcmp("-b", argv[pos])) {
+        OPTION_CHECK("-b", pos, argc);
+        GET_NUMBER(m_b, "-b", argv[pos]);
+    }
+    else if(!strcmp("-c", argv[pos])) {
+        OPTION_CHECK("-c", pos, argc);
+        GET_NUMBER(m_c, "-c", argv[pos]);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+void RosslerFlow::printParams() {
+    fprintf(stdout, "a=%f b=%f c=%f ", m_a, m_b, m_c);
+}
+
+void RosslerFlow::advance(REAL& x, REAL& y, REAL& z, long int steps) {
+    RosslerFlowRhs f = { m_a, m_b, m_c };
+    rk4(x, y, z, steps, f);
+}
+
+void RosslerFlow::advanceLanes(LaneVec& x, LaneVec& y, LaneVec& z, long int steps) {
+    RosslerFlowRhs f = { m_a, m_b, m_c };
+    rk4(x, y, z, steps, f);
+}
@@ -0,0 +1,95 @@
+/***************************************************************************\
+Tool to find the correlation dimension of a sequence.
+Copyright (C) 2010 Tejaswi.
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <http://www.gnu.org/licenses/>.
+\***************************************************************************/
+
+
+
+#ifndef __INCLUDED_ROSSLERFLOW_H__
+#define __INCLUDED_ROSSLERFLOW_H__
+
+#ifndef __cplusplus
+#error A C++ compiler is required to compile this code!
+#endif
+
+
+#include "ChaoticFlow.h"
+
+
+/** default value of parameter a */
+#define ROSSLER_A       0.2
+/** default value of parameter b */
+#define ROSSLER_B       0.2
+/** default value of parameter c */
+#define ROSSLER_C       5.7
+
+
+/**
+ * Class to generate vectors from the Rossler system:
+ *   dx/dt = -y - z
+ *   dy/dt = x + a * y
+ *   dz/dt = b + z * (x - c)
+ */
+class RosslerFlow : public ChaoticFlow {
+public:
+    /**
+     * @brief Constructor of this class.
+     */
+    RosslerFlow(): ChaoticFlow("RosslerFlow"), m_a(ROSSLER_A), m_b(ROSSLER_B), m_c(ROSSLER_C) {}
+
+protected:
+    /**
+     * @brief Print help message on usage of this class and exit
+     */
+    void showHelp();
+
+    /**
+     * @brief Parses one option specific to this system
+     * @param pos position of the option in 'argv' (moved past its argument).
+     * @param argc total number of ALL commandline arguments.
+     * @param argv list of ALL commandline arguments.
+     * @return false if there's no such option
+     */
+    bool parseParam(int& pos, int argc, char** argv);
+
+    /**
+     * @brief Prints the parameters of this system
+     */
+    void printParams();
+
+    /**
+     * @brief Integrates one trajectory
+     * @param x, y, z the state (updated).
+     * @param steps number of steps.
+     */
+    void advance(REAL& x, REAL& y, REAL& z, long int steps);
+
+    /**
+     * @brief Integrates ENSEMBLE_LANES trajectories at once
+     * @param x, y, z the states (updated).
+     * @param steps number of steps.
+     */
+    void advanceLanes(LaneVec& x, LaneVec& y, LaneVec& z, long int steps);
+
+private:
+    REAL m_a;       ///< the parameter a of the system
+    REAL m_b;       ///< the parameter b of the system
+    REAL m_c;       ///< the parameter c of the system
+};
+
+
+/* DO NOT WRITE ANYTHING BELOW THIS LINE!!! */
+#endif // __INCLUDED_ROSSLERFLOW_H__
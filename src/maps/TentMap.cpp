@@ -19,30 +19,34 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 
 
 #include "TentMap.h"
+#include "MemTrack.h"
+#include <cmath>
 
 
-REAL* TentMap::generate(REAL mu, REAL x0, int k) {
-    REAL* arr = new REAL[k];
-    for(int i=0;i<k;i++) {
-        x0 = (x0 >= 0.5)?  mu * (1 - x0)  :  mu * x0;
-        arr[i] = x0;
+REGISTER_MAP(TentMap);
+
+
+int TentMap::generateChunk(REAL* out, int numVec) {
+    for(int i=0;i<numVec;i++) {
+        m_x = (m_x >= 0.5)?  m_mu * (1 - m_x)  :  m_mu * m_x;
+        out[i] = m_x;
     }
-    return arr;
+    return numVec;
 }
 
+
 void TentMap::showHelp() {
     fprintf(stdout, "OPTIONS FOR TENT MAP:\n");
     fprintf(stdout, "      [-help, -mu <mu>, -x0 <x0>]\n");
     fprintf(stdout, "  -help         Print this help and exit.\n");
     fprintf(stdout, "  -mu <mu>      Value of mu for the map. [%f]\n", TENT_MU);
     fprintf(stdout, "  -x0 <x0>      Initial value for the map. [%f]\n", TENT_X0);
-    exit(0);
+    fatalExit(0);
 }
 
-REAL* TentMap::generateVectors(int numEle, int pos, int argc, char** argv) {
+void TentMap::parseOptions(int numEle, int pos, int argc, char** argv) {
     REAL mu = TENT_MU;
     REAL x0 = TENT_X0;
-    Timer tim;
     for(;pos<argc;pos++) {
         if(!strcmp("-help", argv[pos])) {
             this->showHelp();
@@ -57,16 +61,57 @@ REAL* TentMap::generateVectors(int numEle, int pos, int argc, char** argv) {
         }
         else {
             fprintf(stderr, "Unknown option passed '%s'!\n", argv[pos]);
-            exit(1);
+            fatalExit(1);
         }
     }
     CHECK_RANGE(x0, "-x0", 0.0, 1.0);
     CHECK_RANGE(mu, "-mu", 0.0, 2.0);
     fprintf(stdout, "PARAMETERS: numEle=%d mu=%f x0=%f\n", numEle, mu, x0);
+    m_mu = mu;
+    m_x = x0;
+}
+
+
+REAL* TentMap::generateVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
     fprintf(stdout, "Generating numbers from TentMap... ");
-    tim.start();
-    REAL* arr = this->generate(mu, x0, numEle);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    TimerScope tim("TentMap", "Time taken: %f s\n");
+    REAL* arr = MemTrack::allocate<REAL>(numEle, MEM_VECTORS);
+    generateChunk(arr, numEle);
+    tim.stop();
     return arr;
 }
 
+
+REAL* TentMap::generateEnsemble(int numEle, int numTraj, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating %d trajectories from TentMap... ", numTraj);
+    TimerScope tim("TentMap", "Time taken: %f s\n");
+    int stride = ensembleStride(numTraj);
+    REAL* arr = MemTrack::allocate<REAL>((unsigned long int) numEle * stride, MEM_VECTORS);
+    std::vector<REAL> x0(stride);
+    for(int k=0;k<stride;k++) {
+        x0[k] = fmod(m_x + (k * ENSEMBLE_STEP), 1.0);
+    }
+    // every value of all the trajectories comes from the previous one
+    const REAL* prev = &(x0[0]);
+    REAL* row = arr;
+    for(int t=0;t<numEle;t++,prev=row,row+=stride) {
+        for(int k=0;k<stride;k+=ENSEMBLE_LANES) {
+            LaneVec x = *(const LaneVec*) (prev + k);
+            LaneVec y = 1 - x;
+            // same as 'generateChunk', without the branch: x >= 0.5 iff 1 - x <= x
+            *(LaneVec*) (row + k) = m_mu * ((x < y)? x : y);
+        }
+    }
+    tim.stop();
+    return arr;
+}
+
+
+REAL* TentMap::startVectors(int& numEle, int pos, int argc, char** argv) {
+    parseOptions(numEle, pos, argc, argv);
+    fprintf(stdout, "Generating numbers from TentMap... in the background\n");
+    return startChunks(numEle);
+}
+
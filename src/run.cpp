@@ -21,87 +21,211 @@ along with this program. If not, see <http://www.gnu.org/licenses/>.
 #include "cmdline.h"
 #include "CorrDim.h"
 #include "CorrDimLowMem.h"
+#include "CorrDimHybrid.h"
+#include "Server.h"
+#include "Batch.h"
+#include "SysInfo.h"
+#include "PairSketch.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "MemTrack.h"
 
 
 using namespace std;
 
 
 
-REAL runCorrDim(const CmdLine& cmd, Timer& tim, REAL* log_cr, REAL* log_r,
+/**
+ * @brief Adds to the counters of a phase, if metrics are being collected
+ * @param p the phase.
+ * @param pairs pairs evaluated.
+ * @param pruned pairs skipped.
+ */
+void countPairs(Phase p, unsigned long int pairs, unsigned long int pruned=0) {
+    Metrics* m = Metrics::current();
+    if(m != NULL) {
+        m->count(p, pairs, pruned);
+    }
+}
+
+
+REAL runCorrDim(const CmdLine& cmd, REAL* log_cr, REAL* log_r,
 		REAL* inter, int* hist, REAL* bins, unsigned long int& totalMem) {
     fprintf(stdout, "Initializing 'CorrDim'... ");
-    tim.start();
-    CorrDim cd = CorrDim(cmd.array, cmd.numEle, cmd.dimension);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    TimerScope init("distances", "Time taken: %f s\n");
+    Progress::begin("distances", TRI(cmd.numEle));
+    Metrics::enter(PHASE_DISTANCES);
+    CorrDim cd = CorrDim(cmd.array, cmd.numEle, cmd.dimension, NULL, cmd.map->getStream());
+    Metrics::leave();
+    init.stop();
 
     fprintf(stdout, "Evaluating corr-dim... ");
-    tim.start();
+    TimerScope eval("evaluate", "Time taken: %f s\n");
+    // every value of 'R' goes over the whole distance matrix
+    Progress::begin("corrsum", TRI(cmd.numEle) * cmd.numPts);
+    Metrics::enter(PHASE_CORRSUM);
     REAL corrdim = cd.evalCorrDim(cmd.numPts, cmd.discardl, cmd.discardr, log_cr, log_r, inter);
+    Metrics::leave();
+    Progress::begin("histogram", TRI(cmd.numEle));
+    Metrics::enter(PHASE_HISTOGRAM);
     cd.getDistMatrixHistogram(cmd.numBins, hist, bins);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    Metrics::leave();
+    eval.stop();
+    unsigned long int pairs = TRI(cmd.numEle);
+    countPairs(PHASE_DISTANCES, pairs);
+    countPairs(PHASE_CORRSUM, pairs * cmd.numPts);
+    countPairs(PHASE_HISTOGRAM, pairs);
 
-    totalMem = ((cmd.numEle * cmd.dimension * sizeof(REAL)) +       // signal
-                (cmd.numEle * (cmd.numEle-1) / 2 * sizeof(REAL)) +  // distance matrix
-                (cmd.numBins * sizeof(int)) +                       // histogram-bins
-                (cmd.numBins * sizeof(REAL)) +                      // histogram-bin-values
-                (3 * cmd.numPts * sizeof(REAL)));                   // log_r, log_cr, inter arrays
+    totalMem = baseMemory(cmd.numEle, cmd.dimension, cmd.numPts, cmd.numBins) +
+               distMatrixMemory(cmd.numEle);
 
     return corrdim;
 }
 
 
-REAL runCorrDimLowMem(const CmdLine& cmd, Timer& tim, REAL* log_cr, REAL* log_r,
+REAL runCorrDimLowMem(const CmdLine& cmd, REAL* log_cr, REAL* log_r,
 		      REAL* inter, int* hist, REAL* bins, unsigned long int& totalMem) {
+    Checkpoint* ckpt = NULL;
+    if((cmd.checkpoint != "") || (cmd.resume != "")) {
+        ckpt = new Checkpoint((cmd.checkpoint != "")? cmd.checkpoint : cmd.resume, cmd.ckptInterval);
+        if((cmd.resume != "") && !ckpt->load(cmd.resume)) {
+            fprintf(stderr, "Failed to resume from '%s': %s!\n", cmd.resume.c_str(),
+                    ckpt->error().c_str());
+            exit(1);
+        }
+        // the checkpoint is tied to all the vectors
+        if(cmd.map->getStream() != NULL) {
+            cmd.map->getStream()->require(cmd.numEle);
+        }
+        if(!ckpt->attach(cmd.array, cmd.numEle, cmd.dimension, cmd.numPts, cmd.numBins)) {
+            fprintf(stderr, "Can't resume from '%s', %s!\n", cmd.resume.c_str(),
+                    ckpt->error().c_str());
+            exit(1);
+        }
+        if(cmd.resume != "") {
+            fprintf(stdout, "Resuming from row %d of pass %d of '%s'\n", ckpt->row(),
+                    ckpt->phase(), cmd.resume.c_str());
+        }
+        Checkpoint::catchSignals();
+    }
     fprintf(stdout, "Initializing 'CorrDimLowMem'... ");
-    tim.start();
-    CorrDimLowMem cd = CorrDimLowMem(cmd.array, cmd.numEle, cmd.dimension);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    TimerScope init("distances", "Time taken: %f s\n");
+    // the progressive estimator can't afford a pass over all the pairs
+    Progress::begin("distances", TRI(cmd.numEle));
+    Metrics::enter(PHASE_DISTANCES);
+    CorrDimLowMem cd = CorrDimLowMem(cmd.array, cmd.numEle, cmd.dimension, cmd.map->getStream(),
+                                     ckpt, !cmd.progressive());
+    Metrics::leave();
+    init.stop();
+
+    fprintf(stdout, "Evaluating corr-dim... ");
+    TimerScope eval("evaluate", "Time taken: %f s\n");
+    REAL corrdim;
+    unsigned long int pairs = TRI(cmd.numEle);
+    if(cmd.progressive()) {
+        REAL fraction;
+        bool converged;
+        Progress::begin("corrsum", pairs);
+        Metrics::enter(PHASE_CORRSUM);
+        corrdim = cd.evalCorrDimProgressive(cmd.numPts, cmd.discardl, cmd.discardr, log_cr, log_r,
+                                            inter, cmd.tol, cmd.deadline, fraction, converged);
+        Metrics::leave();
+        memset(hist, 0, sizeof(int) * cmd.numBins);
+        memset(bins, 0, sizeof(REAL) * cmd.numBins);
+        eval.stop();
+        fprintf(stdout, "Processed %f%% of the pairs (%s)\n", fraction * 100,
+                converged? "converged" : ((fraction < 1)? "deadline expired" : "all of them"));
+        unsigned long int done = (unsigned long int) (fraction * pairs);
+        countPairs(PHASE_CORRSUM, done, pairs - done);
+    }
+    else {
+        Progress::begin("corrsum", pairs);
+        Metrics::enter(PHASE_CORRSUM);
+        corrdim = cd.evalCorrDim(cmd.numPts, cmd.discardl, cmd.discardr, log_cr, log_r, inter);
+        Metrics::leave();
+        Progress::begin("histogram", pairs);
+        Metrics::enter(PHASE_HISTOGRAM);
+        cd.getDistMatrixHistogram(cmd.numBins, hist, bins);
+        Metrics::leave();
+        eval.stop();
+        // one pass over the pairs for the range, one per corr-sum and histogram
+        countPairs(PHASE_DISTANCES, pairs);
+        countPairs(PHASE_CORRSUM, pairs);
+        countPairs(PHASE_HISTOGRAM, pairs);
+    }
+    // the run is over, nothing left to resume
+    if(ckpt != NULL) {
+        ckpt->remove();
+        delete ckpt;
+    }
+
+    totalMem = baseMemory(cmd.numEle, cmd.dimension, cmd.numPts, cmd.numBins);
+
+    return corrdim;
+}
+
+REAL runCorrDimHybrid(const CmdLine& cmd, REAL* log_cr, REAL* log_r,
+		      REAL* inter, int* hist, REAL* bins, unsigned long int& totalMem) {
+    ThreadPool pool(cmd.plan.threads);
+    fprintf(stdout, "Initializing 'CorrDimHybrid'... ");
+    TimerScope init("distances", "Time taken: %f s\n");
+    Progress::begin("distances", TRI(cmd.numEle));
+    Metrics::enter(PHASE_DISTANCES);
+    CorrDimHybrid cd(cmd.array, cmd.numEle, cmd.dimension, cmd.plan.tileBytes, &pool,
+                     cmd.map->getStream());
+    Metrics::leave();
+    init.stop();
+    fprintf(stdout, "Materialized %d of %d rows of the distance matrix\n",
+            cd.storedRows(), cmd.numEle);
 
     fprintf(stdout, "Evaluating corr-dim... ");
-    tim.start();
+    TimerScope eval("evaluate", "Time taken: %f s\n");
+    Progress::begin("corrsum", TRI(cmd.numEle));
+    Metrics::enter(PHASE_CORRSUM);
     REAL corrdim = cd.evalCorrDim(cmd.numPts, cmd.discardl, cmd.discardr, log_cr, log_r, inter);
+    Metrics::leave();
+    Progress::begin("histogram", TRI(cmd.numEle));
+    Metrics::enter(PHASE_HISTOGRAM);
     cd.getDistMatrixHistogram(cmd.numBins, hist, bins);
-    tim.stopAndPrintTime("Time taken: %f s\n");
+    Metrics::leave();
+    eval.stop();
+    unsigned long int pairs = TRI(cmd.numEle);
+    countPairs(PHASE_DISTANCES, pairs);
+    countPairs(PHASE_CORRSUM, pairs);
+    countPairs(PHASE_HISTOGRAM, pairs);
 
-    totalMem = ((cmd.numEle * cmd.dimension * sizeof(REAL)) +       // signal
-                (cmd.numBins * sizeof(int)) +                       // histogram-bins
-                (cmd.numBins * sizeof(REAL)) +                      // histogram-bin-values
-                (3 * cmd.numPts * sizeof(REAL)));                   // log_r, log_cr, inter arrays
+    totalMem = baseMemory(cmd.numEle, cmd.dimension, cmd.numPts, cmd.numBins) +
+               hybridOverhead(cmd.numEle, cmd.plan.threads) + cd.storedBytes();
 
     return corrdim;
 }
 
 void printMemory(unsigned long int totalMem) {
     if(!(totalMem >> 10)) {
-        fprintf(stdout, "Maximum memory usage (in B): ~%lu\n", totalMem);
+        fprintf(stdout, "Estimated memory usage (in B): ~%lu\n", totalMem);
     }
     else if(!(totalMem >> 20)) {
-        fprintf(stdout, "Maximum memory usage (in kB): ~%lu\n", totalMem>>10);
+        fprintf(stdout, "Estimated memory usage (in kB): ~%lu\n", totalMem>>10);
     }
     else {
-        fprintf(stdout, "Maximum memory usage (in MB): ~%lu\n", totalMem>>20);
+        fprintf(stdout, "Estimated memory usage (in MB): ~%lu\n", totalMem>>20);
     }
+    fprintf(stdout, "Peak resident memory (in kB): %lu\n", peakResidentMemory()>>10);
+    fprintf(stdout, "Peak tracked memory (in kB): %lu (", MemTrack::peak(NUM_MEM_POOLS)>>10);
+    for(int p=0;p<NUM_MEM_POOLS;p++) {
+        fprintf(stdout, "%s%s=%lu", (p > 0)? " " : "", MemTrack::name((MemPool) p),
+                MemTrack::peak((MemPool) p)>>10);
+    }
+    fprintf(stdout, ")\n");
 }
 
 
-void run(const CmdLine& cmd) {
-    Timer tim;
-    REAL *log_cr, *log_r, *inter, *bins;
-    int *hist;
-    REAL corrdim;
-    unsigned long int totalMem;
-
-    log_cr = new REAL[cmd.numPts];
-    log_r = new REAL[cmd.numPts];
-    inter = new REAL[cmd.numPts];
-    hist = new int[cmd.numBins];
-    bins = new REAL[cmd.numBins];
-    corrdim = (cmd.useLowMem)? runCorrDimLowMem(cmd, tim, log_cr, log_r, inter, hist, bins, totalMem) :
-                               runCorrDim(cmd, tim, log_cr, log_r, inter, hist, bins, totalMem);
-
+void dumpResults(const CmdLine& cmd, const REAL* log_cr, const REAL* log_r,
+                 const REAL* inter, const int* hist, const REAL* bins) {
+    MetricsScope scope(PHASE_DUMP);
     if(cmd.dump != "") {
         fprintf(stdout, "Dumping 'log_cr', 'log_r' and 'inter' to '%s'... ", cmd.dump.c_str());
-        tim.start();
+        TimerScope dump("dump", "Time taken: %f s\n");
         FILE* fp = fopen(cmd.dump.c_str(), "w");
         if(fp == NULL) {
             fprintf(stderr, "Failed to open the file '%s' for writing!\n", cmd.dump.c_str());
@@ -111,12 +235,12 @@ void run(const CmdLine& cmd) {
             fprintf(fp, "%f  %f  %f\n", log_r[i], log_cr[i], inter[i]);
         }
         fclose(fp);
-        tim.stopAndPrintTime("Time taken: %f s\n");
+        dump.stop();
     }
 
     if(cmd.distHist != "") {
         fprintf(stdout, "Dumping distance-matrix histogram to '%s'... ", cmd.distHist.c_str());
-        tim.start();
+        TimerScope dump("dump-dist-hist", "Time taken: %f s\n");
         FILE* fp = fopen(cmd.distHist.c_str(), "w");
         if(fp == NULL) {
             fprintf(stderr, "Failed to open the file '%s' for writing!\n", cmd.distHist.c_str());
@@ -126,23 +250,419 @@ void run(const CmdLine& cmd) {
             fprintf(fp, "%f  %d\n", bins[i], hist[i]);
         }
         fclose(fp);
-        delete hist;
-        delete bins;
-        tim.stopAndPrintTime("Time taken: %f s\n");
+        dump.stop();
+    }
+}
+
+
+void saveSketch(const CmdLine& cmd) {
+    MetricsScope scope(PHASE_DUMP);
+    ThreadPool pool(cmd.plan.threads);
+    PairSketch sketch;
+    fprintf(stdout, "Saving the pair-count sketch to '%s'... ", cmd.sketch.c_str());
+    TimerScope save("sketch", "Time taken: %f s\n");
+    Progress::begin("sketch", TRI(cmd.numEle));
+    sketch.reset(cmd.numEle, cmd.dimension > 1);
+    sketch.addPairs(cmd.array, cmd.numEle, cmd.dimension, 0, cmd.numEle, &pool);
+    if(!sketch.save(cmd.sketch)) {
+        fprintf(stderr, "Failed to save the sketch '%s': %s!\n", cmd.sketch.c_str(),
+                sketch.error().c_str());
+        exit(1);
     }
+    save.stop();
+    countPairs(PHASE_DUMP, TRI(cmd.numEle));
+}
 
+
+void run(const CmdLine& cmd) {
+    REAL *log_cr, *log_r, *inter, *bins;
+    int *hist;
+    REAL corrdim;
+    unsigned long int totalMem;
+
+    log_cr = new REAL[cmd.numPts];
+    log_r = new REAL[cmd.numPts];
+    inter = new REAL[cmd.numPts];
+    hist = new int[cmd.numBins];
+    bins = new REAL[cmd.numBins];
+    if((cmd.maxMem > 0) && (cmd.plan.predMem > ((unsigned long int) cmd.maxMem << 20))) {
+        fprintf(stderr, "Argument to '-maxmem' is too small for the '%s' engine!\n",
+                engineName(cmd.plan.engine));
+        exit(1);
+    }
+    if(cmd.plan.engine == ENGINE_LOWMEM) {
+        corrdim = runCorrDimLowMem(cmd, log_cr, log_r, inter, hist, bins, totalMem);
+    }
+    else if(cmd.plan.engine == ENGINE_HYBRID) {
+        corrdim = runCorrDimHybrid(cmd, log_cr, log_r, inter, hist, bins, totalMem);
+    }
+    else {
+        corrdim = runCorrDim(cmd, log_cr, log_r, inter, hist, bins, totalMem);
+    }
+
+    if(cmd.sketch != "") {
+        saveSketch(cmd);
+    }
+    dumpResults(cmd, log_cr, log_r, inter, hist, bins);
     printMemory(totalMem);
     fprintf(stdout, "... CORRELATION DIMENSION = %f\n", corrdim);
+    Metrics* m = Metrics::current();
+    if(m != NULL) {
+        m->info("engine", engineName(cmd.plan.engine));
+        m->info("threads", cmd.plan.threads);
+        m->info("memEstimate", totalMem);
+        m->info("corrdim", corrdim);
+    }
+
+    delete [] log_cr;
+    delete [] log_r;
+    delete [] inter;
+    delete [] hist;
+    delete [] bins;
+    cmd.map->releaseVectors(cmd.array);
+}
+
+
+/**
+ * @brief Evaluates the corr-dim (and the histogram) from a sketch and dumps them
+ * @param cmd the commandline.
+ * @param sketch the sketch.
+ * @return the corr-dim
+ */
+REAL sketchResults(const CmdLine& cmd, PairSketch& sketch) {
+    REAL* log_cr = new REAL[cmd.numPts];
+    REAL* log_r = new REAL[cmd.numPts];
+    REAL* inter = new REAL[cmd.numPts];
+    int* hist = new int[cmd.numBins];
+    REAL* bins = new REAL[cmd.numBins];
+    fprintf(stdout, "Evaluating corr-dim... ");
+    TimerScope eval("evaluate", "Time taken: %f s\n");
+    Metrics::enter(PHASE_CORRSUM);
+    REAL corrdim = sketch.evalCorrDim(cmd.numPts, cmd.discardl, cmd.discardr, log_cr, log_r, inter);
+    Metrics::leave();
+    Metrics::enter(PHASE_HISTOGRAM);
+    sketch.getDistMatrixHistogram(cmd.numBins, hist, bins);
+    Metrics::leave();
+    eval.stop();
+    dumpResults(cmd, log_cr, log_r, inter, hist, bins);
 
-    delete log_cr;
-    delete log_r;
-    delete inter;
+    delete [] log_cr;
+    delete [] log_r;
+    delete [] inter;
+    delete [] hist;
+    delete [] bins;
+    return corrdim;
+}
+
+
+void runFromSketch(const CmdLine& cmd) {
+    PairSketch sketch, part;
+    fprintf(stdout, "Loading %d sketch(es)... ", (int) cmd.fromSketch.size());
+    TimerScope load("load", "Time taken: %f s\n");
+    Metrics::enter(PHASE_GENERATE);
+    for(size_t f=0;f<cmd.fromSketch.size();f++) {
+        PairSketch& dest = (f == 0)? sketch : part;
+        if(!dest.load(cmd.fromSketch[f])) {
+            fprintf(stderr, "Failed to load the sketch '%s': %s!\n", cmd.fromSketch[f].c_str(),
+                    dest.error().c_str());
+            exit(1);
+        }
+        if((f > 0) && !sketch.merge(part)) {
+            fprintf(stderr, "Failed to merge the sketch '%s': %s!\n", cmd.fromSketch[f].c_str(),
+                    sketch.error().c_str());
+            exit(1);
+        }
+    }
+    Metrics::leave();
+    load.stop();
+    fprintf(stdout, "PARAMETERS: numPts=%d discardl=%d discardr=%d numVec=%d pairs=%lu\n",
+            cmd.numPts, cmd.discardl, cmd.discardr, sketch.numVectors(), sketch.numPairs());
+    if(!sketch.complete()) {
+        fprintf(stderr, "%s: The sketches hold only %lu of the %lu pairs of the data (missing rows: %s)!\n",
+                cmd.merge? "ERROR" : "WARNING", sketch.numPairs(), TRI(sketch.numVectors()),
+                sketch.missingRows().c_str());
+        if(cmd.merge) {
+            exit(1);
+        }
+    }
+    if(cmd.sketch != "") {
+        fprintf(stdout, "Saving the merged sketch to '%s'... ", cmd.sketch.c_str());
+        TimerScope save("save", "Time taken: %f s\n");
+        MetricsScope scope(PHASE_DUMP);
+        if(!sketch.save(cmd.sketch)) {
+            fprintf(stderr, "Failed to save the sketch '%s': %s!\n", cmd.sketch.c_str(),
+                    sketch.error().c_str());
+            exit(1);
+        }
+        save.stop();
+    }
+
+    REAL corrdim = sketchResults(cmd, sketch);
+    fprintf(stdout, "... CORRELATION DIMENSION = %f\n", corrdim);
+    Metrics* m = Metrics::current();
+    if(m != NULL) {
+        m->info("engine", "sketch");
+        m->info("numVec", sketch.numVectors());
+        m->info("pairs", sketch.numPairs());
+        m->info("corrdim", corrdim);
+    }
+}
+
+
+void runShard(const CmdLine& cmd) {
+    int threads = (cmd.numThreads > 0)? cmd.numThreads : numCores();
+    vector<int> bounds = splitRows(cmd.numEle, cmd.numShards);
+    int rowBegin = bounds[cmd.shard];
+    int rowEnd = bounds[cmd.shard+1];
+    fprintf(stdout, "PARAMETERS: shard=%d/%d rows=%d-%d pairs=%lu threads=%d map=%s\n",
+            cmd.shard, cmd.numShards, rowBegin, rowEnd, TRI(rowEnd) - TRI(rowBegin), threads,
+            cmd.mapName.c_str());
+    // this shard needs only the vectors up to its last row
+    if(cmd.map->getStream() != NULL) {
+        cmd.map->getStream()->require(rowEnd);
+    }
+    ThreadPool pool(threads);
+    PairSketch sketch;
+    fprintf(stdout, "Sketching the pairs of the shard... ");
+    TimerScope build("sketch", "Time taken: %f s\n");
+    Progress::begin("sketch", TRI(rowEnd) - TRI(rowBegin));
+    Metrics::enter(PHASE_DISTANCES);
+    sketch.reset(cmd.numEle, cmd.dimension > 1);
+    sketch.addPairs(cmd.array, cmd.numEle, cmd.dimension, rowBegin, rowEnd, &pool);
+    Metrics::leave();
+    build.stop();
+    countPairs(PHASE_DISTANCES, TRI(rowEnd) - TRI(rowBegin));
+    fprintf(stdout, "Saving the sketch to '%s'... ", cmd.sketch.c_str());
+    TimerScope save("save", "Time taken: %f s\n");
+    Metrics::enter(PHASE_DUMP);
+    if(!sketch.save(cmd.sketch)) {
+        fprintf(stderr, "Failed to save the sketch '%s': %s!\n", cmd.sketch.c_str(),
+                sketch.error().c_str());
+        exit(1);
+    }
+    Metrics::leave();
+    save.stop();
+    Metrics* m = Metrics::current();
+    if(m != NULL) {
+        m->info("engine", "shard");
+        m->info("shard", cmd.shard);
+        m->info("numShards", cmd.numShards);
+        m->info("threads", threads);
+    }
+    cmd.map->releaseVectors(cmd.array);
+}
+
+
+void writeMetrics(const CmdLine& cmd, Metrics& metrics) {
+    if(cmd.map != NULL) {
+        // the vectors may have been generated by a thread of their own
+        REAL wall, cpu;
+        cmd.map->producerTime(wall, cpu);
+        metrics.addTime(PHASE_GENERATE, wall, cpu);
+        metrics.count(PHASE_GENERATE, 0, 0, cmd.map->bytesRead());
+        metrics.info("map", cmd.mapName);
+        metrics.info("numVec", cmd.numEle);
+        metrics.info("dim", cmd.dimension);
+        // ensembles are generated all at once
+        metrics.info("pipelined", (cmd.pipeline && (cmd.ensemble == 0))? "yes" : "no");
+    }
+    metrics.info("numPts", cmd.numPts);
+    metrics.info("numBins", cmd.numBins);
+    if(!metrics.write(cmd.metrics)) {
+        fprintf(stderr, "Failed to open the file '%s' for writing!\n", cmd.metrics.c_str());
+        exit(1);
+    }
+}
+
+
+void finish(const CmdLine& cmd, TimerScope& total, Metrics& metrics) {
+    Progress::stopReporter();
+    total.stop();
+    if(cmd.timings) {
+        Timer::printRegions(stdout);
+    }
+    if(metrics.counting()) {
+        metrics.printCounters(stdout);
+    }
+    if(cmd.metrics != "") {
+        writeMetrics(cmd, metrics);
+    }
+}
+
+
+/**
+ * @brief Evaluates all the series of a batch, one per thread
+ * @param cmd the commandline.
+ * @param batch the series.
+ */
+void evaluateBatch(const CmdLine& cmd, Batch& batch) {
+    int threads = (cmd.numThreads > 0)? cmd.numThreads : numCores();
+    // every worker gets an equal share of the budget
+    unsigned long int budget = (cmd.maxMem > 0)? (unsigned long int) cmd.maxMem << 20 :
+        (unsigned long int) (availableMemory() * MEM_SAFETY);
+    budget /= threads;
+    CorrDimParams params;
+    corrDimDefaults(params);
+    params.numPts = cmd.numPts;
+    params.discardl = cmd.discardl;
+    params.discardr = cmd.discardr;
+    params.numBins = 0;
+    params.maxMem = budget;
+    params.engine = cmd.engine;
+    // one engine for all, good enough for the longest series
+    if(params.engine == ENGINE_AUTO) {
+        CostModel model(cmd.recalibrate);
+        params.engine = model.plan(ENGINE_AUTO, batch.maxVectors(), batch.maxDimension(),
+                                   cmd.numPts, 0, budget, 1).engine;
+    }
+    fprintf(stdout, "PARAMETERS: series=%d longest=%d threads=%d engine=%s%s maxmemPerThread=%lukB\n",
+            batch.size(), batch.maxVectors(), threads, engineName(params.engine),
+            (cmd.engine == ENGINE_AUTO)? "(auto)" : "", budget >> 10);
+    ThreadPool pool(threads);
+    REAL secs = batch.run(params, pool);
+    fprintf(stdout, "Evaluated %d series in %f s (%f series/s)\n", batch.size(), secs,
+            batch.size() / secs);
+}
+
+
+void runBatch(const CmdLine& cmd) {
+    Batch batch;
+    fprintf(stdout, "Loading the series from '%s'... ", cmd.batch.c_str());
+    TimerScope load("load", "Time taken: %f s\n");
+    batch.load(cmd.batch);
+    load.stop();
+    if(batch.size() == 0) {
+        fprintf(stderr, "No series found in '%s'!\n", cmd.batch.c_str());
+        exit(1);
+    }
+    evaluateBatch(cmd, batch);
+    batch.writeTable(cmd.batchOut);
+}
+
+
+void runEnsemble(const CmdLine& cmd) {
+    unsigned long int numVal = (unsigned long int) cmd.numEle * cmd.dimension;
+    fprintf(stdout, "PARAMETERS: ensemble=%d numEle=%d dim=%d map=%s %s\n", cmd.ensemble, cmd.numEle,
+            cmd.dimension, cmd.mapName.c_str(), cmd.pooled? "pooled" : "per-trajectory");
+    REAL corrdim;
+    if(cmd.pooled) {
+        ThreadPool pool((cmd.numThreads > 0)? cmd.numThreads : numCores());
+        // every worker sketches its own trajectories, which are merged at the end
+        PairSketch sketch;
+        vector<PairSketch> local(pool.size());
+        vector<vector<REAL> > vecs(pool.size(), vector<REAL>(numVal));
+        fprintf(stdout, "Sketching the pairs of every trajectory... ");
+        TimerScope build("sketch", "Time taken: %f s\n");
+        Progress::begin("sketch", TRI(cmd.numEle) * cmd.ensemble);
+        Metrics::enter(PHASE_DISTANCES);
+        sketch.reset(cmd.numEle, cmd.dimension > 1, cmd.ensemble);
+        for(size_t w=0;w<local.size();w++) {
+            local[w].reset(cmd.numEle, cmd.dimension > 1, cmd.ensemble);
+        }
+        pool.parallelFor(cmd.ensemble, [&](int task, int worker) {
+            REAL* arr = &(vecs[worker][0]);
+            ChaoticMap::laneVectors(cmd.array, cmd.ensemble, task, cmd.numEle, cmd.dimension, arr);
+            local[worker].addPairs(arr, cmd.numEle, cmd.dimension, 0, cmd.numEle, NULL);
+        });
+        for(size_t w=0;w<local.size();w++) {
+            sketch.merge(local[w]);
+        }
+        Metrics::leave();
+        build.stop();
+        countPairs(PHASE_DISTANCES, TRI(cmd.numEle) * cmd.ensemble);
+        corrdim = sketchResults(cmd, sketch);
+        fprintf(stdout, "... CORRELATION DIMENSION = %f\n", corrdim);
+    }
+    else {
+        // every trajectory is a series of its own
+        Batch batch;
+        vector<REAL> vecs(numVal);
+        for(int k=0;k<cmd.ensemble;k++) {
+            ChaoticMap::laneVectors(cmd.array, cmd.ensemble, k, cmd.numEle, cmd.dimension, &(vecs[0]));
+            batch.add("trajectory:" + to_string(k), &(vecs[0]), cmd.numEle, cmd.dimension);
+        }
+        evaluateBatch(cmd, batch);
+        batch.writeTable(cmd.batchOut);
+        REAL stddev;
+        int num = batch.summary(corrdim, stddev);
+        fprintf(stdout, "... CORRELATION DIMENSION = %f (+/- %f over %d trajectories)\n", corrdim,
+                stddev, num);
+    }
+    Metrics* m = Metrics::current();
+    if(m != NULL) {
+        m->info("engine", "sketch");
+        m->info("ensemble", cmd.ensemble);
+        m->info("corrdim", corrdim);
+    }
+    cmd.map->releaseVectors(cmd.array);
+}
+
+
+/**
+ * @brief Evaluates the corr-dim for every value of the swept option of the map
+ * @param cmd the commandline.
+ * @param pos start of the options of the map in 'argv'
+ * @param argc total number of ALL commandline arguments.
+ * @param argv list of ALL commandline arguments.
+ *
+ * Every value gets a fresh map, with the swept option appended to its
+ * options (so that it overrides any value given there). The trajectories are
+ * generated one after the other, which is cheap compared to the engines, and
+ * are then evaluated like a '-batch', one per worker.
+ */
+void runSweep(CmdLine& cmd, int pos, int argc, char** argv) {
+    string opt = "-" + cmd.sweepParam;
+    char value[64];
+    vector<char*> args(argv, argv + argc);
+    args.push_back(&(opt[0]));
+    args.push_back(value);
+    fprintf(stdout, "PARAMETERS: sweep=%s from=%f to=%f steps=%d numEle=%d map=%s\n",
+            cmd.sweepParam.c_str(), cmd.sweepStart, cmd.sweepStop, cmd.sweepSteps, cmd.numEle,
+            cmd.mapName.c_str());
+    Batch batch;
+    vector<REAL> values(cmd.sweepSteps);
+    TimerScope gen("generate", "Time taken to generate all the trajectories: %f s\n");
+    for(int s=0;s<cmd.sweepSteps;s++) {
+        values[s] = (cmd.sweepSteps > 1)?
+            cmd.sweepStart + ((cmd.sweepStop - cmd.sweepStart) * s) / (cmd.sweepSteps - 1) : cmd.sweepStart;
+        snprintf(value, sizeof(value), "%.17g", values[s]);
+        ChaoticMap* map = MapRegistry::create(cmd.mapName);
+        int numEle = cmd.numEle;
+        REAL* arr = map->generateVectors(numEle, pos, (int) args.size(), &(args[0]));
+        if(numEle < 2) {
+            fprintf(stderr, "At least 2 vectors are needed, only %d found for '%s=%s'!\n", numEle,
+                    cmd.sweepParam.c_str(), value);
+            exit(1);
+        }
+        batch.add(cmd.sweepParam + "=" + value, arr, numEle, map->getDimension());
+        map->releaseVectors(arr);
+        delete map;
+    }
+    gen.stop();
+    evaluateBatch(cmd, batch);
+    FILE* fp = (cmd.batchOut == "")? stdout : fopen(cmd.batchOut.c_str(), "w");
+    if(fp == NULL) {
+        fprintf(stderr, "Failed to open the file '%s' for writing!\n", cmd.batchOut.c_str());
+        exit(1);
+    }
+    fprintf(fp, "# %s  dimension  residual  status\n", cmd.sweepParam.c_str());
+    for(int s=0;s<cmd.sweepSteps;s++) {
+        if(batch.status(s) == CORRDIM_OK) {
+            fprintf(fp, "%.10g  %f  %f  ok\n", values[s], batch.dimension(s), batch.residual(s));
+        }
+        else {
+            fprintf(fp, "%.10g  nan  nan  %s\n", values[s], corrDimError(batch.status(s)));
+        }
+    }
+    if(fp != stdout) {
+        fclose(fp);
+    }
 }
 
 
 int main(int argc, char** argv) {
-    Timer tim;
-    tim.start();
+    TimerScope total("total", "Total time taken: %f s\n");
+    Metrics metrics;
     int i = 1;
     CmdLine cmd;
     // command line argument parsing
@@ -155,7 +675,131 @@ int main(int argc, char** argv) {
             cmd.dump = argv[i];
         }
         else if(!strcmp("-lowmem", argv[i])) {
-            cmd.useLowMem = true;
+            cmd.engine = ENGINE_LOWMEM;
+        }
+        else if(!strcmp("-engine", argv[i])) {
+            OPTION_CHECK("-engine", i, argc);
+            if(!parseEngine(argv[i], cmd.engine)) {
+                fprintf(stderr, "Argument to '-engine' must be one of auto, full, lowmem or hybrid!\n");
+                exit(1);
+            }
+        }
+        else if(!strcmp("-threads", argv[i])) {
+            OPTION_CHECK("-threads", i, argc);
+            GET_INTEGER(cmd.numThreads, "-threads", argv[i]);
+            CHECK_POSITIVE(cmd.numThreads, "-threads");
+        }
+        else if(!strcmp("-calibrate", argv[i])) {
+            cmd.recalibrate = true;
+        }
+        else if(!strcmp("-serve", argv[i]) || !strcmp("--serve", argv[i])) {
+            OPTION_CHECK("-serve", i, argc);
+            cmd.serve = argv[i];
+        }
+        else if(!strcmp("-batch", argv[i])) {
+            OPTION_CHECK("-batch", i, argc);
+            cmd.batch = argv[i];
+        }
+        else if(!strcmp("-batch-out", argv[i])) {
+            OPTION_CHECK("-batch-out", i, argc);
+            cmd.batchOut = argv[i];
+        }
+        else if(!strcmp("-nopipeline", argv[i])) {
+            cmd.pipeline = false;
+        }
+        else if(!strcmp("-sketch", argv[i])) {
+            OPTION_CHECK("-sketch", i, argc);
+            cmd.sketch = argv[i];
+        }
+        else if(!strcmp("-from-sketch", argv[i])) {
+            OPTION_CHECK("-from-sketch", i, argc);
+            cmd.fromSketch.push_back(argv[i]);
+        }
+        else if(!strcmp("-merge", argv[i])) {
+            OPTION_CHECK("-merge", i, argc);
+            cmd.fromSketch.push_back(argv[i]);
+            cmd.merge = true;
+        }
+        else if(!strcmp("-checkpoint", argv[i])) {
+            OPTION_CHECK("-checkpoint", i, argc);
+            cmd.checkpoint = argv[i];
+        }
+        else if(!strcmp("-checkpoint-every", argv[i])) {
+            OPTION_CHECK("-checkpoint-every", i, argc);
+            GET_INTEGER(cmd.ckptInterval, "-checkpoint-every", argv[i]);
+            CHECK_POSITIVE(cmd.ckptInterval, "-checkpoint-every");
+        }
+        else if(!strcmp("-resume", argv[i])) {
+            OPTION_CHECK("-resume", i, argc);
+            cmd.resume = argv[i];
+        }
+        else if(!strcmp("-tol", argv[i])) {
+            OPTION_CHECK("-tol", i, argc);
+            GET_NUMBER(cmd.tol, "-tol", argv[i]);
+            CHECK_POSITIVE(cmd.tol, "-tol");
+        }
+        else if(!strcmp("-deadline", argv[i])) {
+            OPTION_CHECK("-deadline", i, argc);
+            GET_NUMBER(cmd.deadline, "-deadline", argv[i]);
+            CHECK_POSITIVE(cmd.deadline, "-deadline");
+        }
+        else if(!strcmp("-timings", argv[i])) {
+            cmd.timings = true;
+        }
+        else if(!strcmp("-perf-counters", argv[i])) {
+            cmd.perfCounters = true;
+        }
+        else if(!strcmp("-trace", argv[i])) {
+            OPTION_CHECK("-trace", i, argc);
+            cmd.trace = argv[i];
+        }
+        else if(!strcmp("-progress", argv[i])) {
+            OPTION_CHECK("-progress", i, argc);
+            GET_INTEGER(cmd.progress, "-progress", argv[i]);
+            CHECK_POSITIVE(cmd.progress, "-progress");
+        }
+        else if(!strcmp("-status", argv[i])) {
+            OPTION_CHECK("-status", i, argc);
+            cmd.status = argv[i];
+        }
+        else if(!strcmp("-ensemble", argv[i])) {
+            OPTION_CHECK("-ensemble", i, argc);
+            GET_INTEGER(cmd.ensemble, "-ensemble", argv[i]);
+            CHECK_POSITIVE(cmd.ensemble, "-ensemble");
+        }
+        else if(!strcmp("-pooled", argv[i])) {
+            cmd.pooled = true;
+        }
+        else if(!strcmp("-sweep", argv[i])) {
+            OPTION_CHECK("-sweep", i, argc);
+            const char* eq = strchr(argv[i], '=');
+            char colon1 = 0, colon2 = 0;
+            if((eq == NULL) || (eq == argv[i]) ||
+               (sscanf(eq + 1, "%lf%c%lf%c%d", &cmd.sweepStart, &colon1, &cmd.sweepStop, &colon2,
+                       &cmd.sweepSteps) != 5) || (colon1 != ':') || (colon2 != ':') || (cmd.sweepSteps <= 0)) {
+                fprintf(stderr, "Argument to '-sweep' must be 'opt=start:stop:steps', with steps > 0!\n");
+                exit(1);
+            }
+            cmd.sweepParam = string(argv[i], eq - argv[i]);
+        }
+        else if(!strcmp("-metrics", argv[i])) {
+            OPTION_CHECK("-metrics", i, argc);
+            cmd.metrics = argv[i];
+        }
+        else if(!strcmp("-shard", argv[i])) {
+            OPTION_CHECK("-shard", i, argc);
+            char slash;
+            if((sscanf(argv[i], "%d%c%d", &cmd.shard, &slash, &cmd.numShards) != 3) ||
+               (slash != '/') || (cmd.numShards <= 0) || (cmd.shard < 0) ||
+               (cmd.shard >= cmd.numShards)) {
+                fprintf(stderr, "Argument to '-shard' must be 'i/n', with 0 <= i < n!\n");
+                exit(1);
+            }
+        }
+        else if(!strcmp("-maxmem", argv[i])) {
+            OPTION_CHECK("-maxmem", i, argc);
+            GET_INTEGER(cmd.maxMem, "-maxmem", argv[i]);
+            CHECK_POSITIVE(cmd.maxMem, "-maxmem");
         }
         else if(!strcmp("-numpts", argv[i])) {
             OPTION_CHECK("-numpts", i, argc);
@@ -164,6 +808,10 @@ int main(int argc, char** argv) {
         else if(!strcmp("-numele", argv[i])) {
             OPTION_CHECK("-numele", i, argc);
             GET_INTEGER(cmd.numEle, "-numele", argv[i]);
+            if(cmd.numEle < 0) {
+                fprintf(stderr, "Argument to '-numele' must not be negative!\n");
+                exit(1);
+            }
         }
         else if(!strcmp("-discardl", argv[i])) {
             OPTION_CHECK("-discardl", i, argc);
@@ -191,11 +839,125 @@ int main(int argc, char** argv) {
             break;
         }
     }
+    if(((cmd.metrics != "") || cmd.perfCounters) && ((cmd.serve != "") || (cmd.batch != ""))) {
+        fprintf(stderr, "'-metrics' and '-perf-counters' can't be used along with '-serve' or "
+                "'-batch'!\n");
+        exit(1);
+    }
+    if(((cmd.progress > 0) || (cmd.status != "")) && ((cmd.serve != "") || (cmd.batch != ""))) {
+        fprintf(stderr, "'-progress' and '-status' can't be used along with '-serve' or '-batch'!\n");
+        exit(1);
+    }
+    if((cmd.ensemble > 0) && ((cmd.serve != "") || (cmd.batch != "") || !cmd.fromSketch.empty())) {
+        fprintf(stderr, "'-ensemble' can't be used along with '-serve', '-batch' or '-from-sketch'!\n");
+        exit(1);
+    }
+    // the trajectories are then evaluated like '-batch'
+    if((cmd.ensemble > 0) && !cmd.pooled &&
+       ((cmd.metrics != "") || cmd.perfCounters || (cmd.progress > 0) || (cmd.status != ""))) {
+        fprintf(stderr, "'-metrics', '-perf-counters', '-progress' and '-status' need '-pooled' along "
+                "with '-ensemble'!\n");
+        exit(1);
+    }
+    if((cmd.sweepSteps > 0) && ((cmd.serve != "") || (cmd.batch != "") || !cmd.fromSketch.empty())) {
+        fprintf(stderr, "'-sweep' can't be used along with '-serve', '-batch' or '-from-sketch'!\n");
+        exit(1);
+    }
+    // the values are then evaluated like '-batch'
+    if((cmd.sweepSteps > 0) &&
+       ((cmd.metrics != "") || cmd.perfCounters || (cmd.progress > 0) || (cmd.status != ""))) {
+        fprintf(stderr, "'-metrics', '-perf-counters', '-progress' and '-status' can't be used along "
+                "with '-sweep'!\n");
+        exit(1);
+    }
+    if((cmd.trace != "") && (cmd.serve != "")) {
+        fprintf(stderr, "'-trace' can't be used along with '-serve'!\n");
+        exit(1);
+    }
+    // the phases are traced too
+    if((cmd.metrics != "") || cmd.perfCounters || (cmd.trace != "")) {
+        metrics.attach();
+    }
+    // the events are written at exit
+    if(cmd.trace != "") {
+        Trace::start(cmd.trace);
+    }
+    // before any thread is started, so that they are counted too
+    if(cmd.perfCounters && !metrics.openCounters()) {
+        fprintf(stderr, "WARNING: Hardware performance counters are unavailable (%s), "
+                "ignoring '-perf-counters'!\n", metrics.countersError().c_str());
+    }
+    if((cmd.progress > 0) || (cmd.status != "")) {
+        Progress::startReporter((cmd.progress > 0)? cmd.progress : PROGRESS_INTERVAL, cmd.status);
+    }
+    if(cmd.serve != "") {
+        Server server((cmd.numThreads > 0)? cmd.numThreads : numCores());
+        if(cmd.serve == "-") {
+            server.serveStdin();
+        }
+        else {
+            server.serveSocket(cmd.serve);
+        }
+        return 0;
+    }
+    if(cmd.batch != "") {
+        cmd.validateParams();
+        runBatch(cmd);
+        finish(cmd, total, metrics);
+        return 0;
+    }
+    if(!cmd.fromSketch.empty()) {
+        cmd.validateParams();
+        runFromSketch(cmd);
+        finish(cmd, total, metrics);
+        return 0;
+    }
+    if((cmd.numShards > 0) && (cmd.sketch == "")) {
+        fprintf(stderr, "'-shard' needs '-sketch' to know where to save its sketch!\n");
+        exit(1);
+    }
     cmd.validateInputs();
-    cmd.printParams();
-    cmd.array = cmd.map->generateVectors(cmd.numEle, i, argc, argv);
+    if(cmd.sweepSteps > 0) {
+        delete cmd.map;
+        cmd.map = NULL;
+        runSweep(cmd, i, argc, argv);
+        finish(cmd, total, metrics);
+        return 0;
+    }
+    // the engine works on the first vectors while the rest are being generated
+    TimerScope gen("generate");
+    Metrics::enter(PHASE_GENERATE);
+    if(cmd.ensemble > 0) {
+        cmd.array = cmd.map->generateEnsemble(cmd.numEle, cmd.ensemble, i, argc, argv);
+        if(cmd.array == NULL) {
+            fprintf(stderr, "The map '%s' has no ensemble mode!\n", cmd.mapName.c_str());
+            exit(1);
+        }
+    }
+    else {
+        cmd.array = cmd.pipeline? cmd.map->startVectors(cmd.numEle, i, argc, argv) :
+            cmd.map->generateVectors(cmd.numEle, i, argc, argv);
+    }
+    Metrics::leave();
+    gen.stop();
+    if(cmd.numEle < 2) {
+        fprintf(stderr, "At least 2 vectors are needed, only %d found!\n", cmd.numEle);
+        exit(1);
+    }
     cmd.dimension = cmd.map->getDimension();
+    if(cmd.ensemble > 0) {
+        runEnsemble(cmd);
+        finish(cmd, total, metrics);
+        return 0;
+    }
+    if(cmd.numShards > 0) {
+        runShard(cmd);
+        finish(cmd, total, metrics);
+        return 0;
+    }
+    cmd.planEngine();
+    cmd.printParams();
     run(cmd);
-    tim.stopAndPrintTime("Total time taken: %f s\n");
+    finish(cmd, total, metrics);
     return 0;
 }
@@ -0,0 +1,58 @@
+#!/usr/bin/env perl
+#
+# Script to check that sharding is exact: the '-merge' of the sketches of
+# 'n' shards must give the very same curve, fit and distance-matrix
+# histogram as a single '-sketch' run followed by '-from-sketch'
+#
+
+use strict;
+use warnings;
+use File::Temp qw(tempdir);
+
+# maps to be checked, and their number of vectors
+my @maps = ("HenonMap", "LogisticMap");
+my $numEle = 3000;
+# numbers of shards
+my @shards = (1, 2, 3, 7);
+
+sub run {
+    my ($cmd) = @_;
+    my $output = `$cmd 2>&1`;
+    die "Failed to run '$cmd':\n$output" if($? != 0);
+}
+
+sub same {
+    my ($a, $b) = @_;
+    system("cmp -s $a $b");
+    return ($? == 0);
+}
+
+
+
+if((scalar(@ARGV) != 1) || ($ARGV[0] ne "running_from_Makefile")) {
+    die "You cannot run this script from outside 'Makefile'!";
+}
+my $dir = tempdir(CLEANUP => 1);
+my $failed = 0;
+foreach my $map (@maps) {
+    my $data = "-map $map -numele $numEle";
+    # reference: one process sketches all the pairs
+    run("./corrdim -sketch $dir/full.sketch $data");
+    run("./corrdim -from-sketch $dir/full.sketch -dump $dir/full.dump -dump-dist-hist $dir/full.hist");
+    foreach my $n (@shards) {
+        my $merge = "";
+        for(my $i=0;$i<$n;$i++) {
+            run("./corrdim -shard $i/$n -sketch $dir/part$i.sketch $data");
+            $merge .= " -merge $dir/part$i.sketch";
+        }
+        run("./corrdim$merge -dump $dir/merged.dump -dump-dist-hist $dir/merged.hist");
+        my $ok = same("$dir/full.dump", "$dir/merged.dump") && same("$dir/full.hist", "$dir/merged.hist");
+        printf("%-12s %d shard(s): %s\n", $map, $n, $ok? "OK" : "DIFFERENT");
+        $failed++ if(!$ok);
+    }
+}
+if($failed > 0) {
+    print "$failed check(s) failed!\n";
+    exit(1);
+}
+print "All checks passed\n";